@@ -70,6 +70,7 @@
 #include "version.h"
 #include "dir.h"
 #include "utils.h"
+#include "gui_utils.h"
 
 #ifdef GTK4_BUILD
 #include "search.h"
@@ -87,7 +88,6 @@
 /*** Version Checking Defines ***/
 #define     VCHECK_SIZE     30
 
-#define     MAX_LIST_SIZE           1023            /* Max size for all lists.  All lists must be the same size */
 #define     MAX_OVERRIDE_PATH_SIZE  256
 #define     MAX_VERSION_STRING      20
 
@@ -122,55 +122,7 @@ static gboolean  create_gtk_config_file  (const char *filename);  /* GTK V2/V3 s
 // Global Variables
 //===============================================================
 
-// Applicaton settings (with defaults initialized)
-
-settings_t settings = {
-    /*.refOnly            =*/refOnlyDef,
-    /*.noBuild            =*/noBuildDef,
-    /*.updateAll          =*/updateAllDef,
-    /*.truncateSymbols    =*/truncateSymbolsDef,
-    /*.compressDisable    =*/compressDisableDef,
-    /*.recurseDir         =*/recurseDirDef,
-    /*.version            =*/versionDef,
-    /*.ignoreCase         =*/ignoreCaseDef,
-    /*.useEditor          =*/useEditorDef,
-    /*.retainInput        =*/retainInputDef,
-    /*.retainFailed       =*/retainFailedDef,
-    /*.searchLogging      =*/searchLoggingDef,
-    /*.reuseWin           =*/reuseWinDef,
-    /*.exitConfirm        =*/exitConfirmDef,
-    /*.menuIcons          =*/menuIconsDef,
-    /*.singleClick        =*/singleClickDef,
-    /*.showIncludes       =*/showIncludesDef,
-    /*.autoGenEnable      =*/autoGenEnableDef,
-    /*.refFile            =*/refFileDef,
-    /*.nameFile           =*/nameFileDef,
-    /*.includeDir         =*/includeDirDef,
-    /*.includeDirDelim    =*/includeDirDelimDef,
-    /*.srcDir             =*/srcDirDef,
-    /*.rcFile             =*/rcFileDef,
-    /*.fileEditor         =*/fileEditorDef,
-    /*.autoGenPath        =*/autoGenPathDef,
-    /*.autoGenSuffix      =*/autoGenSuffixDef,
-    /*.autoGenCmd         =*/autoGenCmdDef,
-    /*.autoGenRoot        =*/autoGenRootDef,
-    /*.autoGenId          =*/autoGenIdDef,
-    /*.autoGenThresh      =*/autoGenThreshDef,
-    /*.searchLogFile      =*/searchLogFileDef,
-    /*.suffixList         =*/suffixListDef,
-    /*.suffixDelim        =*/suffixDelimDef,
-    /*.typelessList       =*/typelessListDef,
-    /*.typelessDelim      =*/typelessDelimDef,
-    /*.ignoredList        =*/ignoredListDef,
-    /*.ignoredDelim       =*/ignoredDelimDef,
-    /*.histFile           =*/histFileDef,
-    /*.terminalApp        =*/terminalAppDef,
-    /*.fileManager        =*/fileManagerDef,
-    /*.geometry           =*/geometryDef,
-    /*.trackedVersion     =*/trackedVersionDef,
-    /*.smartQuery         =*/TRUE
-};
-
+// The application settings [and their built-in defaults] are defined in settings.c
 
 // Settings (initialized from the config file) that can be temporarily overriden
 // via the "options menu" need to be saved in order to keep the preferences
@@ -609,55 +561,6 @@ void  APP_CONFIG_set_string(const gchar *key, const gchar *value)
 }
 
 
-//**********************************************************************************************
-// APP_CONFIG_valid_list
-//
-// Function:  Validate a pattern matching list according to the following criteria:
-//    If the list length is <= MAX_LIST_SIZE characters long, and
-//    If a valid delimiter character is defined [first and last char of pattern defines the
-//      delimiter and they must be the same character].
-//
-// If the list passes the validation, set *delim_char equal to the derived delimiter value and
-// return TRUE.
-//
-// If the list fails validation, print a critical error message using list_name+error and return
-// FALSE.
-//**********************************************************************************************
-
-gboolean APP_CONFIG_valid_list(const char *list_name, char *list_ptr, char *delim_char)
-{
-
-    int pattern_len;
-    char d_head, d_tail;
-
-    pattern_len = strlen(list_ptr);
-
-    if (pattern_len > MAX_LIST_SIZE)
-    {
-        fprintf(stderr, "List syntax error: '%s' pattern exceeds %d characters.\n", list_name, MAX_LIST_SIZE);
-        return(FALSE);
-    }
-
-    d_head = *list_ptr;
-    d_tail = *(list_ptr + pattern_len - 1);
-
-    if (d_head != d_tail || pattern_len == 1 || pattern_len == 2)
-    {
-        fprintf(stderr, "List syntax error: Inconsistent delimiter char: '%c' != '%c'\nPattern name: '%s'\nPattern value: '%s'\n", d_head, d_tail, list_name, list_ptr);
-        return(FALSE);
-    }
-
-    /* if we make it this far, we are good to go... */
-
-    *delim_char = d_head;
-
-    // printf("'%s' pattern: %s\n'%s' delimiter char is '%c' \n---------\n", list_name, list_ptr, list_name, *delim_char);
-
-    return(TRUE);
-}
-
-
-
 //===================================
 // Private Functions
 //===================================
@@ -1030,7 +933,7 @@ static void parse_app_config(const char *filename)
             string_trunc_warn("settings.suffixList");
         g_free(tmp_ptr);
     }
-    if ( (settings.suffixList[0] != '\0') && ( !APP_CONFIG_valid_list("Suffix List", settings.suffixList, &settings.suffixDelim) ) )
+    if ( (settings.suffixList[0] != '\0') && ( !SETTINGS_valid_list("Suffix List", settings.suffixList, &settings.suffixDelim) ) )
         exit(EXIT_FAILURE);
 
 
@@ -1042,7 +945,7 @@ static void parse_app_config(const char *filename)
             string_trunc_warn("settings.typelessList");
         g_free(tmp_ptr);
     }
-    if ( (settings.typelessList[0] != '\0') && ( !APP_CONFIG_valid_list("Typeless List", settings.typelessList, &settings.typelessDelim) ) )
+    if ( (settings.typelessList[0] != '\0') && ( !SETTINGS_valid_list("Typeless List", settings.typelessList, &settings.typelessDelim) ) )
         exit(EXIT_FAILURE);
 
 
@@ -1054,7 +957,7 @@ static void parse_app_config(const char *filename)
             string_trunc_warn("settings.ignoredList");
         g_free(tmp_ptr);
     }
-    if ( (settings.ignoredList[0] != '\0') && ( !APP_CONFIG_valid_list("Ignored List", settings.ignoredList, &settings.ignoredDelim) ) )
+    if ( (settings.ignoredList[0] != '\0') && ( !SETTINGS_valid_list("Ignored List", settings.ignoredList, &settings.ignoredDelim) ) )
         exit(EXIT_FAILURE);
 
     DIR_list_join(settings.ignoredList, MASTER_IGNORED_LIST);
@@ -1269,13 +1172,13 @@ static void parse_app_config(const char *filename)
                 string_trunc_warn("settings.includeDir");
             g_free(tmp_ptr);
         }
-        if ( (settings.includeDir[0] != '\0') && ( !APP_CONFIG_valid_list("Include Directory List", settings.includeDir, &settings.includeDirDelim) ) )
+        if ( (settings.includeDir[0] != '\0') && ( !SETTINGS_valid_list("Include Directory List", settings.includeDir, &settings.includeDirDelim) ) )
             exit(EXIT_FAILURE);
     }
     else
     {
         // the string was specified on the command line via -I <string>, validate it...
-        if ( (strlen(settings.includeDir) < 3)  || (!APP_CONFIG_valid_list("Include Directory List", settings.includeDir, &settings.includeDirDelim) ) )
+        if ( (strlen(settings.includeDir) < 3)  || (!SETTINGS_valid_list("Include Directory List", settings.includeDir, &settings.includeDirDelim) ) )
         {
             exit(EXIT_FAILURE);
         }
@@ -1,120 +1,12 @@
 
-
-//===============================================================
-// Defines
-//===============================================================
-
-#define     MAX_STRING_ARG_SIZE     256             /* Maximum supported length of any single command-line string-type argument (including NULL termination */
-#define     MAX_GTK_ENTRY_SIZE      2048            /* Maximum size for "large" GTK entry strings (less than default 65536)*/
-#define     PATHLEN                 500             /* file pathname length */
+#include "settings.h"
 
 
-// Define a default value for each application setting
-#define ignoreCaseDef      FALSE
-#define refOnlyDef         FALSE
-#define noBuildDef         FALSE
-#define updateAllDef       FALSE
-#define truncateSymbolsDef FALSE
-#define compressDisableDef FALSE
-#define autoGenEnableDef   FALSE
-#define recurseDirDef      FALSE
-#define versionDef         FALSE
-#define useEditorDef       FALSE
-#define retainInputDef     FALSE
-#define retainFailedDef    FALSE
-#define searchLoggingDef   FALSE
-#define reuseWinDef        FALSE
-#define exitConfirmDef     TRUE
-#define menuIconsDef       TRUE
-#define singleClickDef     FALSE
-#define showIncludesDef    FALSE
-#define refFileDef         "cscope_db.out"
-#define nameFileDef        ""
-#define includeDirDef      ""
-#define includeDirDelimDef 0
-#define srcDirDef          ""
-#define rcFileDef          ""
-#define fileEditorDef      "/bin/vi"
-#define autoGenPathDef     "/tmp"
-#define autoGenSuffixDef   ".proto"
-#define autoGenCmdDef      "protoc-c_latest"
-#define autoGenRootDef     ""
-#define autoGenIdDef       ".pb-c"
-#define autoGenThreshDef   10
-#define searchLogFileDef   "cscope_srch.log"
-#define suffixListDef      ":c:h:cpp:hpp:arm:fml:mf:l:y:s:ld:lnk:"
-#define suffixDelimDef     0
-#define typelessListDef    ":Makefile:"
-#define typelessDelimDef   0
-#define ignoredListDef     ":validation:"
-#define ignoredDelimDef    0
-#define histFileDef        ""
-#define terminalAppDef     "gnome-terminal --working-directory=%s"
-#define fileManagerDef     "nautilus %s"
-#define trackedVersionDef  1000
-#define geometryDef        ""
-
 //===============================================================
 // typedefs
 //===============================================================
 
-/* Application "Settings" Structure Layout */
 typedef struct
-  {
-      // Command argument [boolean] settings
-      gboolean   refOnly;
-      gboolean   noBuild;
-      gboolean   updateAll;
-      gboolean   truncateSymbols;
-      gboolean   compressDisable;
-      gboolean   recurseDir;
-      gboolean   version;
-      // Non-command-argument [boolean]settings
-      gboolean   ignoreCase;
-      gboolean   useEditor;
-      gboolean   retainInput;
-      gboolean   retainFailed;
-      gboolean   searchLogging;
-      gboolean   reuseWin;
-      gboolean   exitConfirm;
-      gboolean   menuIcons;
-      gboolean   singleClick;
-      gboolean   showIncludes;
-      gboolean   autoGenEnable;
-      // Command agrument [string] settings
-      gchar     refFile[MAX_STRING_ARG_SIZE];
-      gchar     nameFile[MAX_STRING_ARG_SIZE];
-      gchar     includeDir[MAX_GTK_ENTRY_SIZE];
-      gchar     includeDirDelim;
-      gchar     srcDir[MAX_GTK_ENTRY_SIZE];
-      gchar     rcFile[MAX_STRING_ARG_SIZE];
-      gchar     fileEditor[MAX_STRING_ARG_SIZE];
-      // Non-command-argument [string] settings
-      gchar     autoGenPath[MAX_STRING_ARG_SIZE + 1];
-      gchar     autoGenSuffix[MAX_STRING_ARG_SIZE];
-      gchar     autoGenCmd[MAX_STRING_ARG_SIZE];
-      gchar     autoGenRoot[MAX_STRING_ARG_SIZE];
-      gchar     autoGenId[MAX_STRING_ARG_SIZE];
-      guint     autoGenThresh;
-      gchar     searchLogFile[MAX_STRING_ARG_SIZE];
-      gchar     suffixList[MAX_GTK_ENTRY_SIZE];
-      gchar     suffixDelim;
-      gchar     typelessList[MAX_GTK_ENTRY_SIZE];
-      gchar     typelessDelim;
-      gchar     ignoredList[MAX_GTK_ENTRY_SIZE];
-      gchar     ignoredDelim;
-      gchar     histFile[MAX_STRING_ARG_SIZE];
-      gchar     terminalApp[MAX_STRING_ARG_SIZE];
-      gchar     fileManager[MAX_STRING_ARG_SIZE];
-      gchar     geometry[MAX_STRING_ARG_SIZE];
-      // Non-command-argument [integer] settings
-      gint      trackedVersion;
-      // Non "sticky" settings [Not configurable from command line or config file]
-      gboolean  smartQuery;
-  } settings_t;
-
-
-  typedef struct
 {
     gboolean    ignoreCase;
     gboolean    useEditor;
@@ -127,8 +19,7 @@ typedef struct
 // Global Variables
 //===============================================================
 
-// Application-global settings structure
-extern settings_t settings;
+// "Sticky" settings [see app_config.c]
 extern sticky_t   sticky_settings;
 
 
@@ -140,4 +31,3 @@ void        APP_CONFIG_init        (GtkWidget *gscope_splash);
 void        APP_CONFIG_set_boolean (const gchar *key, gboolean value);
 void        APP_CONFIG_set_integer (const gchar *key, gint value);
 void        APP_CONFIG_set_string  (const gchar *key, const gchar *value);
-gboolean    APP_CONFIG_valid_list  (const char *list_name, char *list_ptr, char *delim_char);
@@ -9,7 +9,6 @@
 #include <stdlib.h>
 #include <ftw.h>
 #include <glib.h>
-#include <gtk/gtk.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -22,9 +21,9 @@
 #include "utils.h"
 #include "auto_gen.h"
 #include "search.h"
-#include "display.h"
-#include "app_config.h"
-#include "callbacks_pub.h"
+#include "settings.h"
+#include "engine.h"
+#include "probes.h"
 
 //===============================================================
 //       Defines
@@ -360,6 +359,7 @@ void AUTOGEN_run(char *data_dir)
     int     src_file_index;     //Index of autogen_src_files
     time_t  compile_time;       //Last time file was compiled
     gboolean no_compile_flag;   //Indicates if compiled .pb-c.c can not be found
+    gboolean compiled;          //The compile job succeeded
 
     char    *full_path_buf = NULL;
     char    *file_path_buf = NULL;
@@ -421,7 +421,11 @@ void AUTOGEN_run(char *data_dir)
         {
             pc_stats.num_proto_changed++;
 
-            if ( _protobuf_csrc(file_path_buf, data_dir) )
+            PROBE1(autogen_start, file_path_buf);
+            compiled = _protobuf_csrc(file_path_buf, data_dir);
+            PROBE2(autogen_done, file_path_buf, compiled);
+
+            if ( compiled )
                 pc_stats.proto_build_success++;
             else
                 pc_stats.proto_build_failed++;
@@ -951,7 +955,7 @@ static void _do_garbage_collection()
                          "If you are seeing this message on a regular basis, you may want to increase the CACHE "
                          "GARBAGE COLLECTION THRESHOLD preference value.  See:\n\n(Options-->Preferences-->Cross Reference)";
         if ( !settings.refOnly )
-            my_message_dialog(GTK_WINDOW(CALLBACKS_get_widget("gscope_main")), GTK_MESSAGE_INFO, message, TRUE);
+            ENGINE_message(ENGINE_INFO, message, TRUE);
         else
             fprintf(stderr,"%s\n", message);
     }
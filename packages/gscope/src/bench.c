@@ -0,0 +1,899 @@
+/*
+ *  gscope indexing and search benchmark  ["make bench"]
+ *
+ *  Generates a synthetic C/C++ source tree [the same tree for the same options and seed] and
+ *  times the cross-reference engine on it:
+ *    - build_full:         a full cross-reference build [--updateAll]
+ *    - build_incremental:  a build after --edit-percent of the source files have been edited
+ *    - search_<type>:      each query type [the "<type>:" names of --query], uncached
+ *    - export_<format>:    saving the results of a search as text, CSV and HTML
+ *    - scan_<walker>_<how>: walking the cross-reference by line, symbol mark and file boundary, with
+ *                          the scan.h primitives ["vector"] and with the byte-at-a-time loops they
+ *                          replaced ["bytewise"].  The two must visit the same number of records.
+ *
+ *  Every case is run --runs times.  The results [min, median, p90, p95, p99, max and mean, in
+ *  milliseconds] are written as JSON to --output.  Cross-reference build messages go to stderr.
+ *
+ *  Only the engine [libgscope_core.a] is linked:  no GTK, no display.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "settings.h"
+#include "search.h"
+#include "build.h"
+#include "dir.h"
+#include "latency.h"
+#include "utils.h"
+#include "scanner.h"        /* NEWFILE */
+#include "scan.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+
+#define FILES_PER_DIR       20      /* Source files per generated directory */
+#define LINES_PER_FUNCTION  16      /* Approximate size of each generated function */
+#define INCLUDE_CHAINS      8       /* Header chains [each source file includes the head of one] */
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+typedef struct
+{
+    gint        files;
+    gint        lines;
+    gint        line_length;
+    gint        macro_density;
+    gint        include_depth;
+    gint        cpp_percent;
+    gint        edit_percent;
+    gint        runs;
+    gint        seed;
+    gchar       *dir;
+    gchar       *output;
+    gboolean    keep;
+} bench_options_t;
+
+
+typedef struct
+{
+    gchar       *name;
+    gchar       *pattern;       /* NULL = not a search */
+    guint       matches;
+    gdouble     first_ms;       /* The untimed first run [builds the lazy indexes], < 0 = none */
+    GArray      *samples;       /* gdouble milliseconds, one per run */
+} bench_result_t;
+
+
+//===============================================================
+//       Private Global Variables
+//===============================================================
+
+static bench_options_t options =
+{
+    .files          = 200,
+    .lines          = 400,
+    .line_length    = 72,
+    .macro_density  = 10,
+    .include_depth  = 4,
+    .cpp_percent    = 25,
+    .edit_percent   = 10,
+    .runs           = 5,
+    .seed           = 1,
+    .dir            = NULL,
+    .output         = NULL,
+    .keep           = FALSE,
+};
+
+static GOptionEntry option_entries[] =
+{
+    { "files",          0, 0, G_OPTION_ARG_INT,      &options.files,         "Source files to generate [200]", "N" },
+    { "lines",          0, 0, G_OPTION_ARG_INT,      &options.lines,         "Lines per source file [400]", "N" },
+    { "line-length",    0, 0, G_OPTION_ARG_INT,      &options.line_length,   "Length of the statement lines [72]", "N" },
+    { "macro-density",  0, 0, G_OPTION_ARG_INT,      &options.macro_density, "Percent of the statements that use a macro [10]", "PERCENT" },
+    { "include-depth",  0, 0, G_OPTION_ARG_INT,      &options.include_depth, "Depth of the nested #include chains [4]", "N" },
+    { "cpp-percent",    0, 0, G_OPTION_ARG_INT,      &options.cpp_percent,   "Percent of the source files that are C++ [25]", "PERCENT" },
+    { "edit-percent",   0, 0, G_OPTION_ARG_INT,      &options.edit_percent,  "Percent of the source files edited before an incremental build [10]", "PERCENT" },
+    { "runs",           0, 0, G_OPTION_ARG_INT,      &options.runs,          "Timed runs of each case [5]", "N" },
+    { "seed",           0, 0, G_OPTION_ARG_INT,      &options.seed,          "Seed of the source generator [1]", "N" },
+    { "dir",            0, 0, G_OPTION_ARG_FILENAME, &options.dir,           "Generate the source tree in DIR and keep it [default: a temporary directory]", "DIR" },
+    { "output",         0, 0, G_OPTION_ARG_FILENAME, &options.output,        "Write the JSON results to FILE [default: stdout]", "FILE" },
+    { "keep",           0, 0, G_OPTION_ARG_NONE,     &options.keep,          "Keep the temporary source tree", NULL },
+    { NULL }
+};
+
+static const search_t search_cases[] =
+{
+    FIND_SYMBOL, FIND_DEF, FIND_CALLEDBY, FIND_CALLING, FIND_STRING, FIND_REGEXP, FIND_FILE,
+    FIND_INCLUDING, FIND_ALL_FUNCTIONS, FIND_REACHABLE, FIND_CALL_PATHS, FIND_INCLUDERS, FIND_OUTLINE,
+};
+
+static const gchar *filler_words[] =
+{
+    "the", "cross", "reference", "lookup", "table", "entry", "value", "buffer", "index",
+    "count", "state", "update", "result", "check", "limit", "queue", "node", "list",
+};
+
+static GPtrArray    *results;       /* bench_result_t, in the order they were run */
+static gsize        tree_bytes;     /* Size of the generated tree [before any edits] */
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static gboolean         is_cpp_file     (gint file);
+static gchar *          source_path     (gint file);
+static void             end_line        (GString *text, gsize line_start, GRand *rand);
+static void             write_file      (const gchar *path, GString *text);
+static void             generate_header (gint chain, gint level);
+static void             generate_source (gint file, gint edit);
+static void             generate_tree   (void);
+static gboolean         is_edited       (gint file);
+static void             edit_sources    (gint edit);
+static bench_result_t * new_result      (const gchar *name, const gchar *pattern);
+static gdouble          elapsed_ms      (gint64 start);
+static guint            run_search      (search_t operation, const gchar *pattern);
+static gchar *          search_pattern  (search_t operation);
+static void             bench_builds    (void);
+static void             bench_searches  (void);
+static void             bench_exports   (void);
+static guint            walk_cref       (const char *buf, gint walker, gboolean vector);
+static void             bench_scans     (void);
+static void             put_json_results(FILE *output);
+static void             remove_tree     (const gchar *path);
+
+
+
+/* Generated source files are C++ [.cpp] for --cpp-percent of the files, spread evenly */
+static gboolean is_cpp_file(gint file)
+{
+    return( (file * 37) % 100 < options.cpp_percent );
+}
+
+
+
+/* Return the path of a generated source file, relative to the tree root [g_free() it] */
+static gchar *source_path(gint file)
+{
+    return( g_strdup_printf("src/dir_%02d/file_%d.%s", file / FILES_PER_DIR, file, is_cpp_file(file) ? "cpp" : "c") );
+}
+
+
+
+/* Pad the line started at <line_start> with a comment to --line-length, and end it */
+static void end_line(GString *text, gsize line_start, GRand *rand)
+{
+    gsize   length = text->len - line_start;
+
+    if (length + 8 < (gsize) options.line_length)
+    {
+        g_string_append(text, "   /*");
+
+        while (text->len - line_start + 4 < (gsize) options.line_length)
+        {
+            g_string_append_c(text, ' ');
+            g_string_append(text, filler_words[g_rand_int_range(rand, 0, G_N_ELEMENTS(filler_words))]);
+        }
+
+        g_string_append(text, " */");
+    }
+
+    g_string_append_c(text, '\n');
+}
+
+
+
+static void write_file(const gchar *path, GString *text)
+{
+    GError  *error = NULL;
+
+    if ( !g_file_set_contents(path, text->str, text->len, &error) )
+    {
+        fprintf(stderr, "Error: Unable to write %s: %s\n", path, error->message);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+
+/*
+ * include/chain_<chain>_<level>.h:  each header of a chain includes the next, --include-depth deep.
+ * The #includes are relative to the tree root [where the cross-reference is built].
+ */
+static void generate_header(gint chain, gint level)
+{
+    GString *text = g_string_new(NULL);
+    gchar   *path;
+
+    g_string_append_printf(text, "/* chain_%d_%d.h: generated by gscope_bench */\n\n", chain, level);
+    g_string_append_printf(text, "#ifndef CHAIN_%d_%d_H\n#define CHAIN_%d_%d_H\n\n", chain, level, chain, level);
+
+    if (level + 1 < options.include_depth)
+        g_string_append_printf(text, "#include \"include/chain_%d_%d.h\"\n\n", chain, level + 1);
+
+    g_string_append_printf(text, "#define CHAIN_%d_%d_LIMIT   %d\n\n", chain, level, (chain + 1) * 100 + level);
+    g_string_append_printf(text, "typedef struct chain_%d_%d\n{\n    int     count;\n    long    total;\n} chain_%d_%d_t;\n\n",
+                           chain, level, chain, level);
+    g_string_append_printf(text, "extern chain_%d_%d_t chain_%d_%d_state;\n\n#endif\n", chain, level, chain, level);
+
+    path = g_strdup_printf("include/chain_%d_%d.h", chain, level);
+    write_file(path, text);
+    tree_bytes += text->len;
+
+    g_free(path);
+    g_string_free(text, TRUE);
+}
+
+
+
+/*
+ * Generate source file <file>.  Each function func_<file>_<n> calls func_<file + 1>_0 [so
+ * there are call paths across the tree] and a few random functions.  <edit> changes only the
+ * constants, so every edit of a file defines and uses the same symbols.
+ */
+static void generate_source(gint file, gint edit)
+{
+    GString *text = g_string_new(NULL);
+    GRand   *rand = g_rand_new_with_seed( (guint32) options.seed * 1000003u + (guint32) file );
+    gint    functions = MAX(1, options.lines / LINES_PER_FUNCTION);
+    gint    chains = MIN(INCLUDE_CHAINS, options.files);
+    gint    f, line, choice;
+    gsize   line_start;
+    gchar   *path;
+
+    g_string_append_printf(text, "/* file_%d: generated by gscope_bench */\n\n", file);
+    g_string_append_printf(text, "#include <stdio.h>\n#include \"include/chain_%d_0.h\"\n\n", file % chains);
+
+    for (f = 0; f < functions; f++)
+    {
+        if (options.macro_density > 0)
+            g_string_append_printf(text, "#define MACRO_%d_%d(x)   ((x) * %d + CHAIN_%d_0_LIMIT)\n", file, f, f + 2, file % chains);
+    }
+
+    g_string_append_printf(text, "\nchain_%d_0_t chain_%d_state_%d;\n\n", file % chains, file % chains, file);
+
+    for (f = 0; f < functions; f++)
+    {
+        g_string_append_printf(text, "int func_%d_%d(int value)\n{\n    int     result = %d;\n\n", file, f,
+                               g_rand_int_range(rand, 1, 1000) + edit);
+
+        for (line = 0; line < LINES_PER_FUNCTION - 7; line++)
+        {
+            line_start = text->len;
+            choice = g_rand_int_range(rand, 0, 100);
+
+            if (choice < options.macro_density)
+                g_string_append_printf(text, "    result += MACRO_%d_%d(value);", file, g_rand_int_range(rand, 0, functions));
+            else if (choice < options.macro_density + 25)
+                g_string_append_printf(text, "    result += func_%d_%d(result);",
+                                       g_rand_int_range(rand, 0, options.files), g_rand_int_range(rand, 0, functions));
+            else if (choice < options.macro_density + 40)
+                g_string_append_printf(text, "    puts(\"marker_%d %s\");",
+                                       g_rand_int_range(rand, 0, 100), filler_words[g_rand_int_range(rand, 0, G_N_ELEMENTS(filler_words))]);
+            else
+                g_string_append_printf(text, "    result = (result ^ %d) + value;", g_rand_int_range(rand, 0, 1 << 16) + edit);
+
+            end_line(text, line_start, rand);
+        }
+
+        line_start = text->len;
+        g_string_append_printf(text, "    result += func_%d_0(result);", (file + 1) % options.files);
+        end_line(text, line_start, rand);
+        g_string_append(text, "\n    return(result);\n}\n\n\n");
+    }
+
+    if ( is_cpp_file(file) )
+    {
+        g_string_append_printf(text, "class shape_%d\n{\npublic:\n", file);
+        g_string_append_printf(text, "    int area(int value) { return func_%d_0(value) + %d; }\n", file, g_rand_int_range(rand, 0, 100) + edit);
+        g_string_append(text, "    int scale(int value);\n};\n\n");
+        g_string_append_printf(text, "int shape_%d::scale(int value)\n{\n    return(area(value) * 2);\n}\n", file);
+    }
+
+    path = source_path(file);
+    write_file(path, text);
+    if (edit == 0) tree_bytes += text->len;
+
+    g_free(path);
+    g_rand_free(rand);
+    g_string_free(text, TRUE);
+}
+
+
+
+/* Generate the source tree in the current directory */
+static void generate_tree()
+{
+    gint    chain, level, file;
+    gchar   *dir;
+
+    if ( g_mkdir_with_parents("include", 0755) != 0 )
+    {
+        fprintf(stderr, "Error: Unable to create the source tree directories\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (chain = 0; chain < MIN(INCLUDE_CHAINS, options.files); chain++)
+    {
+        for (level = 0; level < options.include_depth; level++) generate_header(chain, level);
+    }
+
+    for (file = 0; file < options.files; file++)
+    {
+        if (file % FILES_PER_DIR == 0)
+        {
+            dir = g_strdup_printf("src/dir_%02d", file / FILES_PER_DIR);
+            if ( g_mkdir_with_parents(dir, 0755) != 0 )
+            {
+                fprintf(stderr, "Error: Unable to create %s\n", dir);
+                exit(EXIT_FAILURE);
+            }
+            g_free(dir);
+        }
+
+        generate_source(file, 0);
+    }
+}
+
+
+
+/* The edited files are --edit-percent of the source files [at least one], spread evenly over the tree */
+static gboolean is_edited(gint file)
+{
+    gint    edited = MAX(1, options.files * options.edit_percent / 100);
+
+    return( (file * edited) % options.files < edited );
+}
+
+
+
+/*
+ * Regenerate the edited files with new constants.  Their times are set past the time of the
+ * cross-reference [which has a resolution of one second], so the next build sees them as changed.
+ */
+static void edit_sources(gint edit)
+{
+    struct stat     statstruct;
+    struct utimbuf  times;
+    gchar           *path;
+    gint            file;
+
+    if ( stat(settings.refFile, &statstruct) != 0 )
+    {
+        fprintf(stderr, "Error: No cross-reference file [%s]\n", settings.refFile);
+        exit(EXIT_FAILURE);
+    }
+
+    times.actime  = statstruct.st_mtime + 1;
+    times.modtime = statstruct.st_mtime + 1;
+
+    for (file = 0; file < options.files; file++)
+    {
+        if ( !is_edited(file) ) continue;
+
+        generate_source(file, edit);
+
+        path = source_path(file);
+        utime(path, &times);
+        g_free(path);
+    }
+}
+
+
+
+static bench_result_t *new_result(const gchar *name, const gchar *pattern)
+{
+    bench_result_t *result = g_new0(bench_result_t, 1);
+
+    result->name     = g_strdup(name);
+    result->pattern  = g_strdup(pattern);
+    result->first_ms = -1.0;
+    result->samples  = g_array_new(FALSE, FALSE, sizeof(gdouble));
+
+    g_ptr_array_add(results, result);
+    return(result);
+}
+
+
+
+static gdouble elapsed_ms(gint64 start)
+{
+    return( (g_get_monotonic_time() - start) / 1000.0 );
+}
+
+
+
+/* Run a search and return its match count.  The query cache is flushed first, so the search is done. */
+static guint run_search(search_t operation, const gchar *pattern)
+{
+    search_results_t    *found;
+    gchar               *copy = g_strdup(pattern);    /* SEARCH_lookup() may truncate the pattern or strip its anchors in place */
+    guint               matches = 0;
+
+    SEARCH_cache_flush();
+
+    found = SEARCH_lookup(operation, copy);
+    if (found)
+    {
+        matches = found->match_count;
+        SEARCH_free_results(found);
+    }
+
+    g_free(copy);
+    return(matches);
+}
+
+
+
+/* The pattern of each search case [names from the middle of the generated tree] */
+static gchar *search_pattern(search_t operation)
+{
+    gint    file = options.files / 2;
+    gint    last = MAX(1, options.lines / LINES_PER_FUNCTION) - 1;
+
+    switch (operation)
+    {
+        case FIND_SYMBOL:
+        case FIND_DEF:
+        case FIND_CALLEDBY:
+            return( g_strdup_printf("func_%d_%d", file, last) );
+
+        case FIND_CALLING:
+            return( g_strdup_printf("func_%d_0", file) );
+
+        case FIND_STRING:
+            return( g_strdup("marker_42") );
+
+        case FIND_REGEXP:
+            return( g_strdup("marker_4[0-9] (index|node)") );
+
+        case FIND_FILE:
+            return( g_strdup_printf("dir_%02d/file_", file / FILES_PER_DIR) );
+
+        case FIND_INCLUDING:
+            return( g_strdup("chain_0_0.h") );
+
+        case FIND_REACHABLE:
+            return( g_strdup_printf("func_%d_0 3", file) );
+
+        case FIND_CALL_PATHS:
+            return( g_strdup_printf("func_0_0 func_%d_0 %d", MIN(4, options.files - 1), MIN(4, options.files - 1) + 1) );
+
+        case FIND_INCLUDERS:
+            return( g_strdup_printf("chain_0_%d.h", options.include_depth - 1) );
+
+        case FIND_OUTLINE:
+            return( source_path(file) );
+
+        default:
+            return( g_strdup("") );
+    }
+}
+
+
+
+/* Time full builds, then incremental builds after editing --edit-percent of the files */
+static void bench_builds()
+{
+    bench_result_t  *full;
+    bench_result_t  *incremental;
+    gdouble         ms;
+    gint64          start;
+    gint            run;
+
+    /* Untimed:  reads the new tree into the page cache */
+    settings.updateAll = TRUE;
+    BUILD_initDatabase(NULL);
+
+    full = new_result("build_full", NULL);
+    for (run = 0; run < options.runs; run++)
+    {
+        start = g_get_monotonic_time();
+        BUILD_initDatabase(NULL);
+        ms = elapsed_ms(start);
+        g_array_append_val(full->samples, ms);
+    }
+
+    settings.updateAll = FALSE;
+
+    incremental = new_result("build_incremental", NULL);
+    for (run = 0; run < options.runs; run++)
+    {
+        edit_sources(run + 1);
+
+        start = g_get_monotonic_time();
+        BUILD_initDatabase(NULL);
+        ms = elapsed_ms(start);
+        g_array_append_val(incremental->samples, ms);
+    }
+}
+
+
+
+/* Time each query type.  The first run [untimed] also builds the indexes the query uses. */
+static void bench_searches()
+{
+    bench_result_t  *result;
+    gchar           *name;
+    gchar           *pattern;
+    gdouble         ms;
+    gint64          start;
+    guint           i;
+    gint            run;
+
+    for (i = 0; i < G_N_ELEMENTS(search_cases); i++)
+    {
+        name    = g_strdup_printf("search_%s", SEARCH_type_name(search_cases[i]));
+        pattern = search_pattern(search_cases[i]);
+        result  = new_result(name, pattern);
+
+        start = g_get_monotonic_time();
+        result->matches  = run_search(search_cases[i], pattern);
+        result->first_ms = elapsed_ms(start);
+
+        for (run = 0; run < options.runs; run++)
+        {
+            start = g_get_monotonic_time();
+            run_search(search_cases[i], pattern);
+            ms = elapsed_ms(start);
+            g_array_append_val(result->samples, ms);
+        }
+
+        g_free(pattern);
+        g_free(name);
+    }
+}
+
+
+
+/* Time saving the results of the "functions" search [every function definition] in each format */
+static void bench_exports()
+{
+    static const struct
+    {
+        const gchar *name;
+        gboolean    (*save)(gchar *filename);
+    } formats[] =
+    {
+        { "export_text",    SEARCH_save_text },
+        { "export_csv",     SEARCH_save_csv },
+        { "export_html",    SEARCH_save_html },
+    };
+
+    bench_result_t  *result;
+    gchar           filename[] = "bench_export";
+    guint           matches;
+    gdouble         ms;
+    gint64          start;
+    guint           i;
+    gint            run;
+
+    matches = run_search(FIND_ALL_FUNCTIONS, "");
+
+    for (i = 0; i < G_N_ELEMENTS(formats); i++)
+    {
+        result = new_result(formats[i].name, NULL);
+        result->matches = matches;
+
+        for (run = 0; run < options.runs; run++)
+        {
+            start = g_get_monotonic_time();
+            if ( !formats[i].save(filename) )
+            {
+                fprintf(stderr, "Error: %s failed\n", formats[i].name);
+                exit(EXIT_FAILURE);
+            }
+            ms = elapsed_ms(start);
+            g_array_append_val(result->samples, ms);
+        }
+    }
+}
+
+
+
+/* Walk the whole cross-reference in <buf> and return the number of records visited */
+static guint walk_cref(const char *buf, gint walker, gboolean vector)
+{
+    const char  *read_ptr = buf;
+    const char  *end_ptr = buf + strlen(buf);
+    guint       count = 0;
+
+    switch (walker)
+    {
+        case 0:     /* Every line */
+            while (read_ptr < end_ptr)
+            {
+                if (vector)
+                    read_ptr = SCAN_newline(read_ptr);
+                else
+                    while (*read_ptr != '\n') ++read_ptr;
+                read_ptr++;
+                count++;
+            }
+        break;
+
+        case 1:     /* Every symbol mark, as in SEARCH_stats() */
+            do
+            {
+                if (vector)
+                    read_ptr = SCAN_past_tab(read_ptr);
+                else
+                    while (*read_ptr++ != '\t');
+                count++;
+            }
+            while ( !(*read_ptr == NEWFILE && read_ptr[1] == '\n') );
+        break;
+
+        case 2:     /* Every file boundary, as in DIR_create_offset_hash() */
+            do
+            {
+                if (vector)
+                {
+                    read_ptr = SCAN_past_mark(read_ptr, NEWFILE);
+                }
+                else
+                {
+                    do
+                    {
+                        while (*read_ptr++ != '\t');
+                    }
+                    while (*read_ptr++ != NEWFILE);
+                }
+                count++;
+            }
+            while (*read_ptr != '\n');
+        break;
+    }
+
+    return(count);
+}
+
+
+
+/* Time the database walkers over the last cross-reference built, with and without the scan.h primitives */
+static void bench_scans()
+{
+    static const gchar *walker_name[3] = { "lines", "marks", "files" };
+
+    bench_result_t  *result[2];
+    gchar           *buf;
+    gchar           *name;
+    gdouble         ms;
+    gint64          start;
+    gint            walker;
+    gint            vector;
+    gint            run;
+
+    if ( !g_file_get_contents(settings.refFile, &buf, NULL, NULL) )
+    {
+        fprintf(stderr, "Error: Unable to read %s\n", settings.refFile);
+        exit(EXIT_FAILURE);
+    }
+
+    for (walker = 0; walker < 3; walker++)
+    {
+        for (vector = 0; vector < 2; vector++)
+        {
+            name = g_strdup_printf("scan_%s_%s", walker_name[walker], vector ? "vector" : "bytewise");
+            result[vector] = new_result(name, NULL);
+            result[vector]->matches = walk_cref(buf, walker, vector);     /* Untimed:  warms the cache */
+            g_free(name);
+
+            for (run = 0; run < options.runs; run++)
+            {
+                start = g_get_monotonic_time();
+                walk_cref(buf, walker, vector);
+                ms = elapsed_ms(start);
+                g_array_append_val(result[vector]->samples, ms);
+            }
+        }
+
+        if (result[0]->matches != result[1]->matches)
+        {
+            fprintf(stderr, "Error: scan_%s walkers disagree:  %u bytewise, %u vector records\n",
+                    walker_name[walker], result[0]->matches, result[1]->matches);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    g_free(buf);
+}
+
+
+
+static void put_json_results(FILE *output)
+{
+    bench_result_t  *result;
+    latency_t       latency;
+    guint           i;
+
+    fprintf(output, "{\n  \"benchmark\": \"gscope\",\n");
+    fprintf(output, "  \"options\": {\"files\": %d, \"lines\": %d, \"line_length\": %d, \"macro_density\": %d, "
+                    "\"include_depth\": %d, \"cpp_percent\": %d, \"edit_percent\": %d, \"runs\": %d, \"seed\": %d},\n",
+            options.files, options.lines, options.line_length, options.macro_density,
+            options.include_depth, options.cpp_percent, options.edit_percent, options.runs, options.seed);
+    fprintf(output, "  \"tree\": {\"source_files\": %d, \"header_files\": %d, \"bytes\": %lu},\n",
+            options.files, MIN(INCLUDE_CHAINS, options.files) * options.include_depth, (unsigned long) tree_bytes);
+    fprintf(output, "  \"results\": [\n");
+
+    for (i = 0; i < results->len; i++)
+    {
+        result = g_ptr_array_index(results, i);
+        LATENCY_summarize(result->samples, &latency);
+
+        fputs("    {\"name\": ", output);
+        my_put_json_string(output, result->name, NULL);
+        if (result->pattern)
+        {
+            fputs(", \"pattern\": ", output);
+            my_put_json_string(output, result->pattern, NULL);
+        }
+        if (result->pattern || result->matches) fprintf(output, ", \"matches\": %u", result->matches);
+        if (result->first_ms >= 0) fprintf(output, ", \"first_ms\": %.3f", result->first_ms);
+
+        fprintf(output, ", \"runs\": %u, \"min_ms\": %.3f, \"median_ms\": %.3f, \"p90_ms\": %.3f, \"p95_ms\": %.3f, "
+                        "\"p99_ms\": %.3f, \"max_ms\": %.3f, \"mean_ms\": %.3f}%s\n",
+                latency.count, latency.min, latency.median, latency.p90, latency.p95, latency.p99, latency.max, latency.mean,
+                (i + 1 < results->len) ? "," : "");
+    }
+
+    fprintf(output, "  ]\n}\n");
+}
+
+
+
+/* Remove the generated tree [and anything the benchmark wrote into it] */
+static void remove_tree(const gchar *path)
+{
+    GDir        *dir;
+    const gchar *name;
+    gchar       *child;
+
+    if ( (dir = g_dir_open(path, 0, NULL)) != NULL )
+    {
+        while ( (name = g_dir_read_name(dir)) != NULL )
+        {
+            child = g_build_filename(path, name, NULL);
+
+            if ( g_file_test(child, G_FILE_TEST_IS_DIR) && !g_file_test(child, G_FILE_TEST_IS_SYMLINK) )
+                remove_tree(child);
+            else
+                g_unlink(child);
+
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    GOptionContext  *context;
+    GError          *error = NULL;
+    FILE            *output;
+    gchar           *start_dir;
+    gchar           *root;
+    int             saved_stdout;
+
+    context = g_option_context_new("- gscope indexing and search benchmark");
+    g_option_context_add_main_entries(context, option_entries, NULL);
+    if ( !g_option_context_parse(context, &argc, &argv, &error) )
+    {
+        fprintf(stderr, "%s\n", error->message);
+        exit(EXIT_FAILURE);
+    }
+    g_option_context_free(context);
+
+    if ( (options.files < 1) || (options.lines < LINES_PER_FUNCTION) || (options.line_length < 1) ||
+         (options.macro_density < 0) || (options.macro_density > 50) || (options.include_depth < 1) ||
+         (options.cpp_percent < 0) || (options.cpp_percent > 100) ||
+         (options.edit_percent < 0) || (options.edit_percent > 100) || (options.runs < 1) )
+    {
+        fprintf(stderr, "Error: Invalid option value:  --files >= 1, --lines >= %d, --macro-density 0..50, "
+                        "--include-depth >= 1, --cpp-percent and --edit-percent 0..100, --runs >= 1\n", LINES_PER_FUNCTION);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Open the output before leaving the start directory [a relative --output is relative to it] */
+    if ( options.output && (strcmp(options.output, "-") != 0) )
+    {
+        if ( (output = fopen(options.output, "w")) == NULL )
+        {
+            fprintf(stderr, "Error: Unable to open %s\n", options.output);
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        output = stdout;
+    }
+
+    /* Keep stdout for the results: the cross-reference build messages go to stderr */
+    fflush(stdout);
+    saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    start_dir = g_get_current_dir();
+
+    if (options.dir)
+    {
+        root = g_strdup(options.dir);
+        if ( g_mkdir_with_parents(root, 0755) != 0 )
+        {
+            fprintf(stderr, "Error: Unable to create %s\n", root);
+            exit(EXIT_FAILURE);
+        }
+        options.keep = TRUE;
+    }
+    else if ( (root = g_dir_make_tmp("gscope_bench_XXXXXX", &error)) == NULL )
+    {
+        fprintf(stderr, "Error: Unable to create a temporary directory: %s\n", error->message);
+        exit(EXIT_FAILURE);
+    }
+
+    if ( chdir(root) != 0 )
+    {
+        fprintf(stderr, "Error: Unable to change directory to %s\n", root);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(stderr, "Generating %d source files in %s\n", options.files, root);
+    generate_tree();
+
+    /* The engine settings of "gscope -R --refOnly" in the tree, without a configuration file */
+    settings.refOnly    = TRUE;
+    settings.recurseDir = TRUE;
+    SETTINGS_valid_list("Suffix List",   settings.suffixList,   &settings.suffixDelim);
+    SETTINGS_valid_list("Typeless List", settings.typelessList, &settings.typelessDelim);
+    SETTINGS_valid_list("Ignored List",  settings.ignoredList,  &settings.ignoredDelim);
+    DIR_list_join(settings.ignoredList, MASTER_IGNORED_LIST);
+
+    results = g_ptr_array_new();
+
+    bench_builds();
+    bench_searches();
+    bench_exports();
+    bench_scans();
+
+    SEARCH_cleanup();
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    put_json_results(output);
+    if (output != stdout) fclose(output);
+
+    if ( chdir(start_dir) != 0 )
+        fprintf(stderr, "Warning: Unable to change directory to %s\n", start_dir);
+
+    if (options.keep)
+        fprintf(stderr, "Source tree kept in %s\n", root);
+    else
+        remove_tree(root);
+
+    g_free(start_dir);
+    g_free(root);
+
+    return(EXIT_SUCCESS);
+}
@@ -12,6 +12,7 @@
 #include "search.h"
 #include "display.h"
 #include "fileview.h"
+#include "callbacks_pub.h"
 
 
 // Defines
@@ -115,6 +116,8 @@ static void on_right_collapser_button_release_event(GtkGestureClick *gesture, in
 static void on_left_collapser_button_release_event(GtkGestureClick *gesture, int n_press, double x, double y, gpointer *user_data);
 #endif
 static void on_reroot(GtkWidget *menuitem, result_t *function_box);
+static void on_show_reachable(GtkWidget *menuitem, result_t *function_box);
+static void on_show_call_paths(GtkWidget *menuitem, result_t *function_box);
 
 
 //---------------- Private Globals ----------------------------------
@@ -1306,6 +1309,14 @@ static void right_click_menu(GdkEventButton *event, result_t *function_box)
     gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
     g_signal_connect(menu_item, "activate", (GCallback)on_reroot, function_box);
 
+    menu_item = gtk_menu_item_new_with_label("reachable functions");
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+    g_signal_connect(menu_item, "activate", (GCallback)on_show_reachable, function_box);
+
+    menu_item = gtk_menu_item_new_with_label("call paths from root");
+    gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+    g_signal_connect(menu_item, "activate", (GCallback)on_show_call_paths, function_box);
+
     gtk_widget_show_all(menu);
 
     gtk_menu_popup(GTK_MENU(menu), NULL, NULL, NULL, NULL,
@@ -1314,23 +1325,54 @@ static void right_click_menu(GdkEventButton *event, result_t *function_box)
 }
 
 #else
-void on_reroot_activate(GSimpleAction *action, GVariant *parameter, gpointer app)
+static void on_reroot_activate(GSimpleAction *action, GVariant *parameter, gpointer function_box)
+{
+    on_reroot(NULL, function_box);
+}
+
+static void on_show_reachable_activate(GSimpleAction *action, GVariant *parameter, gpointer function_box)
+{
+    on_show_reachable(NULL, function_box);
+}
+
+static void on_show_call_paths_activate(GSimpleAction *action, GVariant *parameter, gpointer function_box)
 {
-    printf("hello from: %s\n", __func__);
-    // call on_reroot(NULL, result_t) - need to figure out how to pas result_t
+    on_show_call_paths(NULL, function_box);
 }
 
-static void right_click_menu(result_t *function_box)
+static void on_right_click_menu_closed(GtkPopover *popover, gpointer user_data)
 {
+    if ( gtk_widget_get_parent(GTK_WIDGET(popover)) ) gtk_widget_unparent(GTK_WIDGET(popover));
+}
+
+static void right_click_menu(GtkWidget *widget, result_t *function_box)
+{
+    // The menu's actions belong to the popover:  they act on this function_box only
+    const GActionEntry browser_entries[] = {
+        {"reroot",     on_reroot_activate,          NULL, NULL, NULL },
+        {"reachable",  on_show_reachable_activate,  NULL, NULL, NULL },
+        {"call_paths", on_show_call_paths_activate, NULL, NULL, NULL },
+    };
+    GSimpleActionGroup *actions;
+    GtkWidget *popover;
+
     // GMenu (model)
     GMenu *menu = g_menu_new();
-    GMenuItem *menu_item_reroot = g_menu_item_new("Re-Root", "app.reroot");
-    g_menu_append_item(menu, menu_item_reroot);
-    g_object_unref(menu_item_reroot);
+    g_menu_append(menu, "Re-Root", "browser.reroot");
+    g_menu_append(menu, "Reachable Functions", "browser.reachable");
+    g_menu_append(menu, "Call Paths from Root", "browser.call_paths");
 
     // popover menu
-    GtkWidget *popover = gtk_popover_menu_new_from_model_full(G_MENU_MODEL(menu), GTK_POPOVER_MENU_NESTED);
-    gtk_widget_set_parent(popover, function_box->tcb);
+    popover = gtk_popover_menu_new_from_model_full(G_MENU_MODEL(menu), GTK_POPOVER_MENU_NESTED);
+    g_object_unref(menu);
+
+    actions = g_simple_action_group_new();
+    g_action_map_add_action_entries(G_ACTION_MAP(actions), browser_entries, G_N_ELEMENTS(browser_entries), function_box);
+    gtk_widget_insert_action_group(popover, "browser", G_ACTION_GROUP(actions));
+    g_object_unref(actions);
+
+    gtk_widget_set_parent(popover, widget);
+    g_signal_connect(popover, "closed", G_CALLBACK(on_right_click_menu_closed), NULL);
     gtk_popover_popup(GTK_POPOVER(popover));
 }
 #endif
@@ -1369,7 +1411,7 @@ static void on_function_button_press(GtkGestureClick *gesture, int n_press, doub
     }
     else if ( (n_press == 1) && gtk_gesture_single_get_current_button(GTK_GESTURE_SINGLE(gesture)) == GDK_BUTTON_SECONDARY )  // Single-click, right button: Open Menu
     {
-        right_click_menu(box);
+        right_click_menu(gtk_event_controller_get_widget(GTK_EVENT_CONTROLLER(gesture)), box);
     }
 }
 #endif
@@ -1493,6 +1535,7 @@ static void on_reroot(GtkWidget *menuitem, result_t *function_box)
 {
     search_results_t *matches;
     // search for the function and see how many results come up
+    CALLBACKS_cancel_search();      // don't wait behind a search started from the main window
     matches = SEARCH_lookup(FIND_DEF, function_box->function_name);
 
     if (matches->match_count == 1)
@@ -1516,6 +1559,33 @@ static void on_reroot(GtkWidget *menuitem, result_t *function_box)
 
 
 //********************************************************************************************** 
+// on_show_reachable
+//********************************************************************************************** 
+static void on_show_reachable(GtkWidget *menuitem, result_t *function_box)
+{
+    // list every function the selected function can reach (in the main results view)
+    CALLBACKS_process_query(FIND_REACHABLE, function_box->function_name);
+}
+
+
+
+//********************************************************************************************** 
+// on_show_call_paths
+//********************************************************************************************** 
+static void on_show_call_paths(GtkWidget *menuitem, result_t *function_box)
+{
+    tcb_t *tcb = (tcb_t *)function_box->tcb;
+    gchar *pattern;
+
+    // list the call chains from the browser root to the selected function
+    pattern = g_strdup_printf("%s %s", tcb->root_entry.function_name, function_box->function_name);
+    CALLBACKS_process_query(FIND_CALL_PATHS, pattern);
+    g_free(pattern);
+}
+
+
+
+//**********************************************************************************************
 // add_functions_to_column
 //********************************************************************************************** 
 static void add_functions_to_column(tcb_t *tcb, result_t *function_list, guint num_results,
@@ -1529,10 +1599,26 @@ static void add_functions_to_column(tcb_t *tcb, result_t *function_list, guint n
     result_t *node;
     search_results_t *children;
     search_t operation;
+    gchar **names;
 
 
     if ( function_list )
     {
+        // check to see which functions actually need an expander:
+        // only those that call [or are called by] other functions.
+        // Look up every function in this column with a single pass over the cross-reference.
+        names = g_new(gchar *, num_results);
+        node = function_list;
+        for (row = 0; row < num_results; row++)
+        {
+            names[row] = node->function_name;
+            node = node->next;
+        }
+        operation = (direction == RIGHT ? FIND_CALLEDBY : FIND_CALLING);
+        CALLBACKS_cancel_search();  // don't wait behind a search started from the main window
+        children = SEARCH_lookup_batch(operation, names, num_results);
+        g_free(names);
+
         node = function_list;
 
         for (row = starting_row; row < starting_row + num_results; row++)
@@ -1615,21 +1701,18 @@ static void add_functions_to_column(tcb_t *tcb, result_t *function_list, guint n
             g_signal_connect(gesture, "pressed", G_CALLBACK(on_function_button_press), node);
             #endif
 
-            // check to see if we actually need to add an expander
-            // only need one if this function calls [or is called by] other functions
-            operation = (direction == RIGHT ? FIND_CALLEDBY : FIND_CALLING);
-            children = SEARCH_lookup(operation, node->function_name);
-            if (children->match_count > 0)
+            if (children[row - starting_row].match_count > 0)
             {
                 if ( direction == RIGHT )
                     make_expander_at_position(tcb, col + 1, row, direction);
                 else
                     make_expander_at_position(tcb, col - 1, row, direction);
             }
-            SEARCH_free_results(children);
 
             node = node->next;
         }
+
+        SEARCH_free_batch_results(children, num_results);
     }
 }
 
@@ -1677,6 +1760,7 @@ static void expand_table(guint origin_row, guint origin_col, tcb_t *tcb, dir_e d
     // search for the appropriate children for that function and
     // parse them into a usable list
     get_function(tcb, origin_col, origin_row, direction, &fname, &file);
+    CALLBACKS_cancel_search();      // don't wait behind a search started from the main window
     children = SEARCH_lookup(operation, fname);
     if (children->match_count == 0)
     {
@@ -130,7 +130,6 @@ line of the header to the trailer.
 #include "config.h"
 #endif
 
-#include <gtk/gtk.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -149,10 +148,12 @@ line of the header to the trailer.
 #include "build.h"
 #include "lookup.h"
 #include "scanner.h"
-#include "display.h"
-#include "app_config.h"
+#include "settings.h"
 #include "auto_gen.h"
-#include "callbacks_pub.h"
+#include "scan.h"
+#include "engine.h"
+#include "profile.h"
+#include "probes.h"
 
 
 
@@ -161,6 +162,7 @@ line of the header to the trailer.
 //===============================================================
 #define         FILEVERSION         14  /* symbol database file format version */
 #define         OPTIONS_LEN         40
+#define         MARKS_SUFFIX        ".stats"    /* Symbol mark counts are saved next to the cross-reference */
 
 
 //===============================================================
@@ -182,15 +184,17 @@ typedef struct
 //===============================================================
 static gboolean old_crossref_is_compatible(char *file_buf);
 static gchar    *initialize_using_old_cref(void);
-static gchar    *initialize_for_new_cref(GtkWidget *progress_bar);
-static gchar    *build_new_cref(GtkWidget *progress_bar);
-static gchar    *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *progress_bar);
+static gchar    *initialize_for_new_cref(gpointer progress);
+static gchar    *build_new_cref(gpointer progress);
+static gchar    *make_new_cref(old_buf_descriptor_t *old_descriptor, gpointer progress);
 static void     initcompress(void);
 static void     putheader(char *dir);
 static char     *get_old_file(char *dest_ptr, char *src_ptr);
 static void     copydata(char *src_ptr);
 static void     movefile(char *new, char *old);
 static void     get_decompressed_string(char *dest, char *src);
+static void     put_mark_counts(void);
+static gboolean get_mark_counts(void);
 static int      compare();   /* for qsort */
 
 
@@ -200,6 +204,9 @@ static int      compare();   /* for qsort */
 
 int     fileversion;        /* cross-reference file version */
 
+guint32     mark_counts[256];       /* Symbol marks in the cross-reference, by mark (counted as it is written) */
+gboolean    mark_counts_valid;      /* mark_counts[] describes the current cross-reference */
+
 
 //===============================================================
 //      Private Global Variables
@@ -222,6 +229,8 @@ struct timeval cref_time_start,     cref_time_stop;
 
 static char build_stats_msg[1024];
 
+static gboolean build_cancelled;  /* The last cross-reference build was stopped before every file was parsed */
+
 //====================================================================
 //
 // Open up the cross reference database.  This database will be
@@ -255,7 +264,7 @@ static char build_stats_msg[1024];
 //
 //====================================================================
 
-void BUILD_initDatabase(GtkWidget *progress_bar)
+void BUILD_initDatabase(gpointer progress)
 {
     suseconds_t elapsed_usec;
 
@@ -268,6 +277,7 @@ void BUILD_initDatabase(GtkWidget *progress_bar)
     gchar *cref_results;
 
     gettimeofday(&overall_time_start, NULL);
+    PROFILE_start();
 
     /* if the database path is relative and it can't be created */
     if (settings.refFile[0] != '/' && access(".", W_OK) != 0)
@@ -289,12 +299,15 @@ void BUILD_initDatabase(GtkWidget *progress_bar)
     else
     {
         /* Build a new cross-reference */
-        cref_results = initialize_for_new_cref(progress_bar);
+        cref_results = initialize_for_new_cref(progress);
     }
 
     // Now that we have a valid cross-reference database,
     // Initialize the "search" sub-system
+    PROFILE_begin(PROFILE_RELOAD);
     SEARCH_init();
+    DIR_count_suffixes();       /* For the statistics dialog */
+    PROFILE_end(PROFILE_RELOAD);
 
     /* Free the source_name hash table (no longer needed) */
     DIR_free_src_names_hash();
@@ -375,8 +388,8 @@ void BUILD_initDatabase(GtkWidget *progress_bar)
 
     if ( !settings.refOnly )
     {
-        DISPLAY_update_stats_tooltip(mega_message);
-        DISPLAY_set_cref_current(TRUE);
+        ENGINE_stats(mega_message);
+        ENGINE_set_cref_current( !build_cancelled );
     }
     else
         printf("\n%s\n", mega_message);
@@ -388,6 +401,8 @@ void BUILD_initDatabase(GtkWidget *progress_bar)
     g_free(overall_time);
     g_free(mega_message);
     g_free(cref_results);
+
+    PROFILE_finish();
 }
 
 
@@ -475,6 +490,7 @@ static gchar *initialize_using_old_cref()
 
     /* Extract the source file list from the existing cross-reference data */
     /***********************************************************************/
+    PROFILE_begin(PROFILE_WALK);
     DIR_init(OLD_CREF);
 
     file_count = 0;
@@ -489,6 +505,9 @@ static gchar *initialize_using_old_cref()
     }
 
     g_free(old_file_buf);
+    PROFILE_end(PROFILE_WALK);
+
+    mark_counts_valid = get_mark_counts();
 
     gettimeofday(&src_list_time_stop, NULL);
     gettimeofday(&cref_time_start, NULL);
@@ -501,34 +520,36 @@ static gchar *initialize_using_old_cref()
 }
 
 
-static gchar *initialize_for_new_cref(GtkWidget *progress_bar)
+static gchar *initialize_for_new_cref(gpointer progress)
 {
     gettimeofday(&src_list_time_start, NULL);
 
     if ( !settings.refOnly )  // Only update if we are in GUI mode.
     {
         /* Bring up the splash screen prior to searching for source files (the search can take a while) */
-        DISPLAY_progress(progress_bar, NULL, 0, 100);   /* Show (essentially) no progress */
+        ENGINE_progress(progress, NULL, 0, 100);   /* Show (essentially) no progress */
     }
 
     /* Create a fresh Source-File list.
        Initialize the Include-Directory list.
        Initialize key path variables and file name */
+    PROFILE_begin(PROFILE_WALK);
     DIR_init(NEW_CREF);
+    PROFILE_end(PROFILE_WALK);
 
     if (settings.autoGenEnable)
+    {
+        PROFILE_begin(PROFILE_AUTOGEN);
         AUTOGEN_run( DIR_get_path(DIR_DATA));
+        PROFILE_end(PROFILE_AUTOGEN);
+    }
 
 
     if (nsrcfiles == 0)
     {
         if ( !settings.refOnly )
         {
-            #ifndef GTK4_BUILD
-            my_message_dialog(GTK_WINDOW(CALLBACKS_get_widget("gscope_splash")), GTK_MESSAGE_ERROR, "<span weight=\"bold\"> No source files found</span>", TRUE);
-            #else
-            my_message_dialog(GTK_WINDOW(CALLBACKS_get_widget("gscope_main")), GTK_MESSAGE_ERROR, "<span weight=\"bold\"> No source files found</span>", FALSE);
-            #endif
+            ENGINE_message(ENGINE_ERROR, "<span weight=\"bold\"> No source files found</span>", TRUE);
             fprintf(stderr,"\nNo source files found.\n");
         }
         else
@@ -552,7 +573,7 @@ static gchar *initialize_for_new_cref(GtkWidget *progress_bar)
     // We are now ready parse the source files and build the cross-reference database
     gettimeofday(&cref_time_start, NULL);
 
-    gchar *results = build_new_cref(progress_bar);
+    gchar *results = build_new_cref(progress);
 
     gettimeofday(&cref_time_stop, NULL);
 
@@ -585,7 +606,7 @@ static void initcompress()
 
 /* build the cross-reference */
 
-static gchar *build_new_cref(GtkWidget *progress_bar)
+static gchar *build_new_cref(gpointer progress)
 {
     FILE    *old_file;
     char    *old_file_buf = NULL;   /* Buffer that holds the entire old crossref file contents */
@@ -667,9 +688,9 @@ static gchar *build_new_cref(GtkWidget *progress_bar)
     gchar *results;
 
     if ( force_rebuild )
-        results = make_new_cref(NULL, progress_bar);                /* Create a full cross reference */
+        results = make_new_cref(NULL, progress);                /* Create a full cross reference */
     else
-        results = make_new_cref(&old_buf_descriptor, progress_bar); /* Create an incremental cross-reference */
+        results = make_new_cref(&old_buf_descriptor, progress); /* Create an incremental cross-reference */
 
 
     if (old_file_buf) g_free(old_file_buf);
@@ -752,7 +773,7 @@ static gboolean old_crossref_is_compatible(char *file_buf)
 
 
 
-static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *progress_bar)
+static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, gpointer progress)
 {
     uint32_t    firstfile;          /* first source file in pass */
     uint32_t    lastfile;           /* last source file in pass */
@@ -768,6 +789,7 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
     time_t      now;
 
     char        *old_offset_ptr;
+    uint32_t    copy_offset;        /* new database offset of the copied data [for the copy_done probe] */
     char        *new_cref_file;
     gboolean    full_update;
     gchar       *cref_results;
@@ -775,6 +797,10 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
     gchar       *skipped_msg;
 
 
+    // If the build is cancelled, the files parsed so far are still written out as a complete
+    // cross-reference.  The files it is missing are treated as new files by the next build.
+    build_cancelled = FALSE;
+
     if (old_descriptor == NULL)
         full_update = TRUE;
     else
@@ -791,6 +817,9 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
 
     putheader( DIR_get_path(DIR_DATA) );
 
+    memset(mark_counts, 0, sizeof(mark_counts));
+    mark_counts_valid = FALSE;
+
     /* output the leading tab expected by crossref() */
     dbputc('\t');
 
@@ -807,6 +836,8 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
 
     starttime = time((time_t *) NULL);  // Initialize the progress bar timer
 
+    PROFILE_begin(PROFILE_PARSE);
+
 
     if (full_update)    /*** Start full update ***/
     {
@@ -817,13 +848,19 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
             /* get the next source file name from the NEW source file list*/
             for (fileindex = firstfile; fileindex < lastfile; fileindex++)
             {
+                if ( ENGINE_cancelled(progress) )
+                {
+                    build_cancelled = TRUE;
+                    break;
+                }
+
                 if ( !settings.refOnly )  // Only update if we are in GUI mode.
                 {
                     now = time((time_t *) NULL);
                     if ( (now  - starttime) >= 1 )
                     {
                         starttime = now;
-                        DISPLAY_progress(progress_bar, "Building Cross Reference:", fileindex, nsrcfiles);
+                        ENGINE_progress(progress, "Building Cross Reference:", fileindex, nsrcfiles);
                     }
                 }
 
@@ -832,16 +869,25 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
 
                 new_file = DIR_src_files[fileindex];
 
+                PROFILE_file_begin();
                 if ( crossref(new_file) )
                     built++;
                 else
                     skipped++;
+                PROFILE_file_end(new_file);
 
                 /* if srcDir is not NULL, pop back to the original CWD */
                 if ( strcmp(settings.srcDir, "") != 0) my_chdir( DIR_get_path(DIR_CURRENT_WORKING) );
 
             }  /* for (fileindex = firstfile; fileindex < lastfile; ++fileindex) */
 
+            if (build_cancelled)
+            {
+                my_asprintf(&cref_msg, "Cross-reference build cancelled after %d of %d files\n", built + skipped, nsrcfiles);
+                my_asprintf(&skipped_msg, "%s", "");
+                break;
+            }
+
             /* Process all include files detected during parsing */
             if (lastfile == nsrcfiles)
             {
@@ -883,13 +929,19 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
             /* get the next source file name from the NEW source file list*/
             for (fileindex = firstfile; fileindex < lastfile; ++fileindex)
             {
+                if ( ENGINE_cancelled(progress) )
+                {
+                    build_cancelled = TRUE;
+                    break;
+                }
+
                 if ( !settings.refOnly )  // Only update if we are in GUI mode.
                 {
                     now = time((time_t *) NULL);
                     if ( (now  - starttime) >= 1 )
                     {
                         starttime = now;
-                        DISPLAY_progress(progress_bar, "Building Cross Reference:", fileindex, nsrcfiles);
+                        ENGINE_progress(progress, "Building Cross Reference:", fileindex, nsrcfiles);
                     }
                 }
 
@@ -905,10 +957,12 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
                     /* If the file has been modified since it was last parsed. */
                     if (stat(new_file, &statstruct) == 0 && statstruct.st_mtime > old_descriptor->reftime)
                     {
+                        PROFILE_file_begin();
                         if ( crossref(new_file) )
                             ++built;
                         else
                             skipped++;
+                        PROFILE_file_end(new_file);
                     }
                     else
                     {
@@ -917,16 +971,23 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
                         // Yes, we re-use the old data if we can't stat the file in question.  It's just
                         // too obscure of a corner case to justify more complexity -- 2/8/13 TF
 
+                        PROFILE_begin(PROFILE_COPY);
+                        PROBE1(copy_start, new_file);
+                        copy_offset = dboffset;
                         copydata(old_offset_ptr + 1);  // skip the leading '\t' character
+                        PROBE2(copy_done, new_file, dboffset - copy_offset);
+                        PROFILE_end(PROFILE_COPY);
                         ++copied;
                     }
                 }
                 else            // File not found in old CREF, this must be a new file
                 {
+                    PROFILE_file_begin();
                     if ( crossref(new_file) )
                         ++built;
                     else
                         skipped++;
+                    PROFILE_file_end(new_file);
                 }
 
                 /* if srcDir is not NULL, pop back to the original CWD */
@@ -934,6 +995,14 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
 
             } /* for (fileindex = firstfile; fileindex < lastfile; ++fileindex) */
 
+            if (build_cancelled)
+            {
+                my_asprintf(&cref_msg, "Cross-reference build cancelled after %d of %d files (%d New, %d Re-used)\n",
+                            built + skipped + copied, nsrcfiles, built, copied);
+                my_asprintf(&skipped_msg, "%s", "");
+                break;
+            }
+
             /* Process all include files detected during parsing */
             if (lastfile == nsrcfiles)
             {
@@ -960,6 +1029,9 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
         } /* for(;;) */
     }  /*** End Incremental Update ***/
 
+    PROFILE_end(PROFILE_PARSE);
+    PROFILE_begin(PROFILE_WRITE);
+
     /* add a null file name to the trailing tab */
     dbputc(NEWFILE);
     dbputc('\n');
@@ -976,9 +1048,18 @@ static gchar *make_new_cref(old_buf_descriptor_t *old_descriptor, GtkWidget *pro
 
 
     (void) fclose(newrefs);
+    PROFILE_end(PROFILE_WRITE);
 
     /* replace the old database file with the new database file */
+    PROFILE_begin(PROFILE_RENAME);
     movefile(new_cref_file, settings.refFile);
+    PROFILE_end(PROFILE_RENAME);
+
+    /* Save the symbol counts, so a --no_build session doesn't have to count them again */
+    PROFILE_begin(PROFILE_WRITE);
+    mark_counts_valid = TRUE;
+    put_mark_counts();
+    PROFILE_end(PROFILE_WRITE);
 
     my_asprintf(&cref_results, "%s%s", cref_msg, skipped_msg);
 
@@ -1012,11 +1093,7 @@ static char *get_old_file(char *dest_ptr, char *src_ptr)
     }
 
     // Scan to the next file entry "\t@"
-    do
-    {
-        /* loop optimized to only one test */
-        while ( *src_ptr++ != '\t');
-    } while ( *src_ptr++ != NEWFILE );
+    src_ptr = SCAN_past_mark(src_ptr, NEWFILE);
 
     // Check for end of list marker
     if ( *src_ptr == '\0')
@@ -1083,6 +1160,8 @@ static void copydata(char *src_ptr)
 
         src_ptr++;      /* Now update the read pointer */
 
+        mark_counts[(guchar) *src_ptr]++;
+
         /* look for an #included file */
         if (*src_ptr == INCLUDE)
         {
@@ -1118,6 +1197,71 @@ static void movefile(char *new, char *old)
 
 
 
+/*
+ * Save mark_counts[] as "<mark> <count>" lines after a "marks <cross-reference size>" line.
+ * Failure is harmless:  the counts are just collected the slow way.
+ */
+static void put_mark_counts(void)
+{
+    FILE        *marks_file;
+    gchar       *marks_path;
+    struct stat statstruct;
+    guint       mark;
+
+    if ( stat(settings.refFile, &statstruct) != 0 ) return;
+
+    my_asprintf(&marks_path, "%s%s", settings.refFile, MARKS_SUFFIX);
+    if ( (marks_file = fopen(marks_path, "w")) != NULL )
+    {
+        fprintf(marks_file, "marks %lld\n", (long long) statstruct.st_size);
+        for (mark = 0; mark < 256; mark++)
+        {
+            if (mark_counts[mark] > 0)
+                fprintf(marks_file, "%c %u\n", mark, mark_counts[mark]);
+        }
+        if (fclose(marks_file) != 0)
+            (void) unlink(marks_path);
+    }
+    g_free(marks_path);
+}
+
+
+
+/* Load the mark counts saved with the cross-reference.  Returns FALSE if they are missing or stale. */
+static gboolean get_mark_counts(void)
+{
+    FILE        *marks_file;
+    gchar       *marks_path;
+    struct stat ref_stat;
+    struct stat marks_stat;
+    long long   size;
+    char        mark;
+    guint       count;
+    gboolean    valid = FALSE;
+
+    memset(mark_counts, 0, sizeof(mark_counts));
+
+    my_asprintf(&marks_path, "%s%s", settings.refFile, MARKS_SUFFIX);
+
+    /* The counts must have been saved after the cross-reference was written, for a file of the same size */
+    if ( (stat(settings.refFile, &ref_stat) == 0) && (stat(marks_path, &marks_stat) == 0) &&
+         (marks_stat.st_mtime >= ref_stat.st_mtime) && ((marks_file = fopen(marks_path, "r")) != NULL) )
+    {
+        if ( (fscanf(marks_file, "marks %lld\n", &size) == 1) && (size == (long long) ref_stat.st_size) )
+        {
+            while (fscanf(marks_file, "%c %u\n", &mark, &count) == 2)
+                mark_counts[(guchar) mark] = count;
+            valid = feof(marks_file);
+        }
+        fclose(marks_file);
+    }
+    g_free(marks_path);
+
+    return(valid);
+}
+
+
+
 /* put the rest of the cross-reference line into the string */
 static void get_decompressed_string(char *dest, char *src)
 {
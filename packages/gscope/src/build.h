@@ -7,9 +7,12 @@ extern char     dichar2[];      /* 8 most frequent second chars using the above
 extern char     dicode1[];      /* digraph first character code */
 extern char     dicode2[];      /* digraph second character code */
 
+extern guint32      mark_counts[256];     /* Symbol marks in the cross-reference, by mark */
+extern gboolean     mark_counts_valid;
+
 extern time_t       autogen_elapsed_sec;
 extern suseconds_t  autogen_elapsed_usec;
 
-void  BUILD_initDatabase(GtkWidget *progress_bar);
+void  BUILD_initDatabase(gpointer progress);
 void  BUILD_init_cli_file_list(int argc, char *argv[]);
 
@@ -16,6 +16,7 @@
 #include "string.h"
 #include "display.h"
 #include "utils.h"
+#include "gui_utils.h"
 #include "fileview.h"
 #include "dir.h"
 #include "build.h"
@@ -46,8 +47,19 @@ typedef struct _SrcFile_stats
 } SrcFile_stats;
 
 
+typedef struct
+{
+    search_t    query_type;
+    gchar       *pattern;
+} query_t;
+
+
 // ---- local function prototypes ----
 static SrcFile_stats* create_stats_list(SrcFile_stats **si_stats);
+static gchar *query_history_markup(void);
+static void query_progress(guint searched, guint total, guint matches, gpointer user_data);
+static void query_batch(search_batch_t *batch, gpointer user_data);
+static void query_done(search_results_t *search_results, gpointer user_data);
 
 
 //---------------- Private Globals ----------------------------------
@@ -97,6 +109,16 @@ static GtkWidget    *browser_window = NULL;
 static GtkApplication *gscope_app = NULL;  
 #endif
 
+// process_query() state, shared with its asynchronous search callbacks
+#define MAX_COMPARISON          256
+static gchar            *button_label[NUM_FIND_TYPES];
+static GtkWidget        *query_entry;
+static GtkWidget        *cancel_button;
+static GtkWidget        *progress_bar;
+static char             previous_pattern[MAX_COMPARISON];
+static search_t         previous_query = FIND_NULL;
+static search_token_t   *active_search = NULL;     // The search in progress [NULL = none]
+
 //---Public Globals (Try to keep this section empty)----
 
 
@@ -107,36 +129,30 @@ static GtkApplication *gscope_app = NULL;
 
 
 //---------------------------------------------------------------------------
-// process_query (query_type)
+// process_query (query_type, query_pattern)
 //
 // Perform one of the eight pre-defined queries [specified by <query_type>]
 // using the text from the query_entry field [on the main application window]
 // and display the results.
 //
+// "Virtual button" queries use a fixed pattern, or <query_pattern> if it is
+// not NULL [e.g. the file of a results-list context menu].
+//
 //---------------------------------------------------------------------------
-static void process_query(search_t query_type)
+static void process_query(search_t query_type, const gchar *query_pattern)
 {
-#define MAX_COMPARISON          256
     gchar *pattern;
     #ifdef GTK4_BUILD
     GtkEntryBuffer *buffer;
     #endif
 
-    static gchar *button_label[NUM_FIND_TYPES];
     static gchar *button_active_label[NUM_FIND_TYPES];
     static GtkWidget *buttons[NUM_FIND_TYPES];
-    static GtkWidget *query_entry;
-    static GtkWidget *cancel_button;
-    static GtkWidget *progress_bar;
     static search_t  previous_button;
 
-    static char previous_pattern[MAX_COMPARISON];
     static gboolean initialized = FALSE;
-    static search_t previous_query = FIND_NULL;
     static const gchar *format_string = "=%s=";
 
-    gchar msg[512];
-    gchar plural[3];
     const gchar *str_ptr;
 
     if (!initialized)
@@ -206,6 +222,10 @@ static void process_query(search_t query_type)
         // Virtual button(s)
         button_label[FIND_AUTOGEN_ERRORS] = "AutoGen Errors";
         button_label[FIND_ALL_FUNCTIONS] = "Find All Functions";
+        button_label[FIND_REACHABLE] = "Reachable Functions";
+        button_label[FIND_CALL_PATHS] = "Call Paths";
+        button_label[FIND_INCLUDERS] = "Files Including (All Levels)";
+        button_label[FIND_OUTLINE] = "File Outline";
 
         query_entry   = lookup_widget(GTK_WIDGET(gscope_main), "query_entry");
         cancel_button = lookup_widget(GTK_WIDGET(gscope_main), "cancel_button");
@@ -215,9 +235,20 @@ static void process_query(search_t query_type)
 
     if (query_type == FIND_NULL)
     {
-        // Clear previous query info
+        // Clear previous query info (and abandon the search in progress, if any)
         strcpy(previous_pattern, "");
         previous_query = FIND_NULL;
+        if (active_search)
+        {
+            SEARCH_token_cancel(active_search);
+            cancel_requested = TRUE;
+        }
+        return;
+    }
+
+    if (active_search)
+    {
+        DISPLAY_status("<span foreground=\"red\">A search is already in progress (Cancel it to start a new search)</span>");
         return;
     }
 
@@ -241,7 +272,11 @@ static void process_query(search_t query_type)
     }
     else
     {
-        if ( query_type == FIND_AUTOGEN_ERRORS )   // fixed "virtual" button pattern
+        if ( query_pattern )    // "virtual" button query of a given pattern
+        {
+            pattern = strdup(query_pattern);
+        }
+        else if ( query_type == FIND_AUTOGEN_ERRORS )   // fixed "virtual" button pattern
         {
             pattern = strdup(AUTOGEN_ERR_PATTERN);
         }
@@ -267,96 +302,147 @@ static void process_query(search_t query_type)
     }
     else
     {
-        search_results_t *search_results;
+        static const search_callbacks_t callbacks = { query_progress, query_batch, query_done };
+        query_t *query;
 
         // Enable the Cancel button
         gtk_widget_set_sensitive(cancel_button, TRUE);
 
         // Kick-off the search.
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress_bar), 0.0);
         gtk_widget_show(progress_bar);
 
-        // Perform the search
-        search_results = SEARCH_lookup(query_type, pattern);
+        // Perform the search on the search thread (matches are shown as they are found)
+        query = g_malloc(sizeof(query_t));
+        query->query_type = query_type;
+        query->pattern    = g_strdup(pattern);
 
-        if (search_results->match_count > 0)
-        {
-            char *esc_pattern;
+        DISPLAY_search_results_begin(query_type);
+        active_search = SEARCH_lookup_async(query_type, pattern, &callbacks, query);
+    }
 
-            // Disable the Cancel button
-            gtk_widget_set_sensitive(cancel_button, FALSE);
-            gtk_widget_hide(progress_bar);
-            
-            // remember our last successful query
-            previous_query = query_type;
-            // remember the last successful query pattern
-            snprintf(previous_pattern, MAX_COMPARISON, "%s", pattern);
+    free(pattern);
 
-            if (search_results->match_count > 1)
-                strcpy(plural, "es");
-            else
-                strcpy(plural, "");
+    // Place focus back onto the query_entry field
+    gtk_widget_grab_focus(query_entry);
+}
 
-            esc_pattern = g_markup_escape_text(pattern, -1);
-            sprintf(msg, "%s:  <span foreground=\"blue\">%s</span>   [%d match%s]", button_label[query_type],
-                    esc_pattern,
-                    search_results->match_count,
-                    plural);
-            g_free(esc_pattern);
 
-            if (cancel_requested)
-            {
-                cancel_requested = FALSE;
-                strcat(msg, "<span foreground=\"red\">  - Search Aborted - Partial Results Shown!</span>");
-            }
-            DISPLAY_status(msg);
+// Search progress notification for process_query()
+static void query_progress(guint searched, guint total, guint matches, gpointer user_data)
+{
+    gchar *msg;
 
-            DISPLAY_search_results(query_type, search_results);
-            if (query_type <= FIND_INCLUDING)     // If this is not a "virtual button" query
-                DISPLAY_history_update(pattern);  // Update the history log
-        }
-        else   // no match
+    my_asprintf(&msg, "Searched %d of %d files [%d matches]", searched, total, matches);
+    DISPLAY_status(msg);
+    g_free(msg);
+
+    /* An empty cross-reference [or a search that scans no files] reports total == 0 */
+    if (total > 0)
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress_bar), CLAMP((gdouble) searched / (gdouble) total, 0.0, 1.0));
+}
+
+
+// Partial results notification for process_query()
+static void query_batch(search_batch_t *batch, gpointer user_data)
+{
+    DISPLAY_search_results_append(batch);
+}
+
+
+// Search completion notification for process_query()
+static void query_done(search_results_t *search_results, gpointer user_data)
+{
+    query_t     *query = user_data;
+    search_t    query_type = query->query_type;
+    gchar       *pattern = query->pattern;
+
+    gchar msg[512];
+    gchar plural[3];
+
+    active_search = NULL;
+
+    // Disable the Cancel button
+    gtk_widget_set_sensitive(cancel_button, FALSE);
+    gtk_widget_hide(progress_bar);
+
+    if (search_results->match_count > 0)
+    {
+        char *esc_pattern;
+
+        // remember our last successful query
+        previous_query = query_type;
+        // remember the last successful query pattern
+        snprintf(previous_pattern, MAX_COMPARISON, "%s", pattern);
+
+        if (search_results->match_count > 1)
+            strcpy(plural, "es");
+        else
+            strcpy(plural, "");
+
+        esc_pattern = g_markup_escape_text(pattern, -1);
+        snprintf(msg, sizeof(msg), "%s:  <span foreground=\"blue\">%s</span>   [%d match%s]", button_label[query_type],
+                 esc_pattern,
+                 search_results->match_count,
+                 plural);
+        g_free(esc_pattern);
+
+        if (cancel_requested)
         {
-            // Disable the Cancel button
-            gtk_widget_set_sensitive(cancel_button, FALSE);
-            gtk_widget_hide(progress_bar);
             cancel_requested = FALSE;
+            strncat(msg, "<span foreground=\"red\">  - Search Aborted - Partial Results Shown!</span>", sizeof(msg) - strlen(msg) - 1);
         }
+        DISPLAY_status(msg);
 
+        DISPLAY_search_results(query_type, search_results);
+        if (query_type <= FIND_INCLUDING)     // If this is not a "virtual button" query
+            DISPLAY_history_update(pattern);  // Update the history log
+    }
+    else   // no match
+    {
+        char *esc_pattern;
 
-        if (!settings.retainInput)
-        {
+        cancel_requested = FALSE;
 
-            if ((search_results->match_count == 0) && (settings.retainFailed))
-            {
-                /* Do nothing, leave the input text alone */
-            }
-            else
-            {
-                /* otherwise clear the entry text if we have a match */
-                my_gtk_entry_set_text(GTK_ENTRY(query_entry), "");
-            }
-        }
+        // The previous results stay in the list:  say that they are not this query's
+        esc_pattern = g_markup_escape_text(pattern, -1);
+        snprintf(msg, sizeof(msg), "%s:  <span foreground=\"blue\">%s</span>   <span foreground=\"red\">[Not found]</span>",
+                 button_label[query_type], esc_pattern);
+        g_free(esc_pattern);
+        DISPLAY_status(msg);
 
-        SEARCH_free_results(search_results);   /* Free the search results data */
+        DISPLAY_search_results(query_type, search_results);     // Ends the streamed query [and applies a sort asked for meanwhile]
     }
 
-    free(pattern);
 
-    // Place focus back onto the query_entry field
-    gtk_widget_grab_focus(query_entry);
+    if (!settings.retainInput)
+    {
+
+        if ((search_results->match_count == 0) && (settings.retainFailed))
+        {
+            /* Do nothing, leave the input text alone */
+        }
+        else
+        {
+            /* otherwise clear the entry text if we have a match */
+            my_gtk_entry_set_text(GTK_ENTRY(query_entry), "");
+        }
+    }
+
+    g_free(query->pattern);
+    g_free(query);
 }
 
 
-// Create a list of source file suffixes and counts for each suffix
+// Create a list of source file suffixes and counts for each suffix [counted when the database was loaded, see DIR_count_suffixes()]
 static SrcFile_stats* create_stats_list(SrcFile_stats **si_stats)
 {
-    gchar *suffix_ptr;
-    gchar *wptr;
-    gchar delimiter;
-    gchar working[80];       // Working buffer for constructing each individual suffix string.
+    const dir_suffix_count_t *counts;
+    const dir_suffix_count_t *count;
+    guint num_counts;
+    guint i;
     int f;
-    guint noSuffixCnt = 0;
-    guint si_noSuffixCnt = 0;
+    int counter;
 
     SrcFile_stats *ListBegin = NULL;
     SrcFile_stats *entry;
@@ -364,161 +450,86 @@ static SrcFile_stats* create_stats_list(SrcFile_stats **si_stats)
     SrcFile_stats *si_ListBegin = NULL;
     SrcFile_stats *si_entry;
 
-    SrcFile_stats *previous;
-    SrcFile_stats * current,*temp;
-
-    int counter;
-
-    gboolean include_file_path_exists;
-
-    if (strcmp(settings.includeDir, "") == 0)
-        include_file_path_exists = FALSE;
-    else
-        include_file_path_exists = TRUE;
-
+    counts = DIR_suffix_counts(&num_counts);
 
-    suffix_ptr = &(settings.suffixList[0]);
+    // -------- The TOTAL count ends the user list --------
+    entry = g_malloc(sizeof(SrcFile_stats));
+    entry->next = ListBegin;
+    ListBegin = entry;
+    entry->fcount = nsrcfiles;
+    entry->suffix = strdup("Total");
 
-    if (*suffix_ptr != '\0')    // If we have a non-null suffix list
+    // Build the lists back to front, so the suffix counts are displayed in the same order as
+    // the suffix list pattern [followed by the <no-suffix> count].
+    for (i = num_counts; i > 0; i--)
     {
-        delimiter = *suffix_ptr++;
-        while (*suffix_ptr != '\0')
-        {
-            wptr = working;
-            *wptr++ = '.';
-            while (*suffix_ptr != delimiter)
-            {
-                *wptr++ = *suffix_ptr++;
-            }
-            suffix_ptr++;
-            *wptr = 0;  // Null-terminate the suffix.
-
-            /* Create the application specific suffix list */
-            entry = g_malloc(sizeof(SrcFile_stats));  // Create the suffix entry
-            entry->next = ListBegin;                  // Add it to the linked list
-            ListBegin = entry;
-            entry->fcount = 0;
-            entry->suffix = strdup(working);
-
-            /* Create the (optional) system include suffix list (/usr/include/...)  */
-            si_entry = g_malloc(sizeof(SrcFile_stats));  // Create the suffix entry
-            si_entry->next = si_ListBegin;               // Add it to the linked list
-            si_ListBegin = si_entry;
-            si_entry->fcount = 0;
-            si_entry->suffix = strdup(working);
-        }
+        count = &counts[i - 1];
+
+        entry = g_malloc(sizeof(SrcFile_stats));
+        entry->next = ListBegin;
+        ListBegin = entry;
+        entry->fcount = count->user_files;
+        entry->suffix = strdup(count->suffix ? count->suffix : "No Suffix");
+
+        /* The (optional) system include suffix list (/usr/include/...)  */
+        si_entry = g_malloc(sizeof(SrcFile_stats));
+        si_entry->next = si_ListBegin;
+        si_ListBegin = si_entry;
+        si_entry->fcount = count->include_files;
+        si_entry->suffix = strdup(entry->suffix);
+    }
 
+    // Debugging aid:  list the files found on the include-file search path
+    if ( settings.showIncludes && (strcmp(settings.includeDir, "") != 0) )
+    {
         counter = 0;
-
-        // Now that the list is created, collect the per-suffix statistics
         for (f = 0; f < nsrcfiles; f++)
         {
-            if ((include_file_path_exists) && (DIR_file_on_include_search_path(DIR_src_files[f])))
-            {
-                /* Count this file in the system include source stats */
-                if (settings.showIncludes)
-                    printf("%d) %s\n", ++counter, DIR_src_files[f]);
-
-                // if the file has a suffix
-                if ((wptr = strrchr(DIR_src_files[f], '.')) != NULL)
-                {
-                    si_entry = si_ListBegin;
-                    // increment the suffix counter corresponding to wptr
-                    while (si_entry != NULL)
-                    {
-                        if (strcmp(si_entry->suffix, wptr) == 0)
-                        {
-                            si_entry->fcount++;
-                            break;
-                        }
-                        si_entry = si_entry->next;
-                    }
-                }
-                else
-                {
-                    // increment the no-suffix counter
-                    si_noSuffixCnt++;
-                }
-            }
-            else /* This is a user source file, not a System Includes (/usr/include...) file */
-            /* Count this file in the user program source stats */
-            {
-                // if the file has a suffix
-                if ((wptr = strrchr(DIR_src_files[f], '.')) != NULL)
-                {
-                    entry = ListBegin;
-                    // increment the suffix counter corresponding to wptr
-                    while (entry != NULL)
-                    {
-                        if (strcmp(entry->suffix, wptr) == 0)
-                        {
-                            //if ( strcmp(wptr, DELSOL_ISINK_FID_INIT) == 0) printf("%s\n", DIR_src_files[f]);
-                            entry->fcount++;
-                            break;
-                        }
-                        entry = entry->next;
-                    }
-                }
-                else
-                {
-                    // increment the no-suffix counter
-                    noSuffixCnt++;
-                }
-            }
+            if ( DIR_file_on_include_search_path(DIR_src_files[f]) ) printf("%d) %s\n", ++counter, DIR_src_files[f]);
         }
     }
 
-    // -------- Add the <no-suffix> count to the user sourcelist --------
-    entry = g_malloc(sizeof(SrcFile_stats));
-    entry->next = ListBegin;
-    ListBegin = entry;
-    entry->fcount = noSuffixCnt;
-    entry->suffix = strdup("No Suffix");
+    *si_stats = si_ListBegin;    // Return the pointer to the si_List here
+    return (ListBegin);
+}
 
-    // Add the <no-suffix> count to the system includes sourcelist
-    si_entry = g_malloc(sizeof(SrcFile_stats));
-    si_entry->next = si_ListBegin;
-    si_ListBegin = si_entry;
-    si_entry->fcount = si_noSuffixCnt;
-    si_entry->suffix = strdup("No Suffix");
 
 
-    // -------- Add the TOTAL count to the user list --------
-    entry = g_malloc(sizeof(SrcFile_stats));
-    entry->next = ListBegin;
-    ListBegin = entry;
-    entry->fcount = nsrcfiles;
-    entry->suffix = strdup("Total");
+// A table of the work done by the most recent searches [newest first], as Pango markup
+static gchar *query_history_markup(void)
+{
+    search_work_t   history[SEARCH_WORK_HISTORY];
+    GString         *markup;
+    const gchar     *name;
+    gchar           *padded;
+    gchar           *pattern;
+    guint           count;
+    guint           i;
 
-    // Now reverse the entries in the linked list so that the
-    // Suffix counts are displayed in the same order as the suffix
-    // list pattern.
+    count = SEARCH_work_history(history, SEARCH_WORK_HISTORY);
+    if (count == 0) return( g_strdup("<i>No searches yet</i>") );
 
-    current = ListBegin;
-    previous = NULL;
-    while (current != NULL)
-    {
-        temp = current->next;
-        current->next = previous;
-        previous = current;
-        current = temp;
-    }
-    ListBegin = previous;
+    markup = g_string_new("<tt><small>");
+    g_string_append_printf(markup, "<b>%-10s %-20s %9s %9s %9s %9s %8s %5s %9s %9s</b>",
+                           "Type", "Pattern", "Wall ms", "CPU ms", "Cref KB", "Symbols", "Regex", "Files", "Source KB", "Result KB");
 
-    current = si_ListBegin;
-    previous = NULL;
-    while (current != NULL)
+    for (i = 0; i < count; i++)
     {
-        temp = current->next;
-        current->next = previous;
-        previous = current;
-        current = temp;
+        name = SEARCH_type_name(history[i].operation);
+        padded = g_strdup_printf("%-20.20s", history[i].pattern);     // Pad before escaping:  <, > and & are one column wide
+        pattern = g_markup_escape_text(padded, -1);
+        g_free(padded);
+
+        g_string_append_printf(markup, "\n%-10s %s %9.2f %9.2f %9lu %9" G_GUINT64_FORMAT " %8" G_GUINT64_FORMAT " %5u %9lu %9lu%s",
+                               name ? name : "other", pattern, history[i].wall_ms, history[i].cpu_ms,
+                               (unsigned long) (history[i].cref_bytes / 1024), history[i].symbols, history[i].regex_evals,
+                               history[i].files_opened, (unsigned long) (history[i].source_bytes / 1024),
+                               (unsigned long) (history[i].result_bytes / 1024), history[i].cached ? "  (cached)" : "");
+        g_free(pattern);
     }
-    si_ListBegin = previous;
 
-
-    *si_stats = si_ListBegin;    // Return the pointer to the si_List here
-    return (ListBegin);
+    g_string_append(markup, "</small></tt>");
+    return( g_string_free(markup, FALSE) );
 }
 
 
@@ -527,6 +538,29 @@ static SrcFile_stats* create_stats_list(SrcFile_stats **si_stats)
 //          Public Callback Functions
 //=============================================================================================
 
+// Run a "virtual button" query [FIND_REACHABLE, FIND_CALL_PATHS, ...] of <pattern> the way
+// the query buttons do:  asynchronously, with status, progress and smart-query handling.
+// For windows other than the main window [e.g. the call browser].
+
+void CALLBACKS_process_query(search_t query_type, const gchar *pattern)
+{
+    process_query(query_type, pattern);
+}
+
+
+
+// Stop the search in progress [if any] and wait for the search thread to let go of the
+// cross-reference.  Call before a synchronous SEARCH_lookup*() on the GTK thread, which
+// would otherwise block until the whole asynchronous search has finished.
+
+void CALLBACKS_cancel_search(void)
+{
+    if (active_search) cancel_requested = TRUE;     // UI will report that the search results are truncated
+    SEARCH_cancel();
+}
+
+
+
 // Provide a catalog of prominent widgets that enables components with no knowledge
 // of the widget hierarchy to fetch a reference for that widget.
 //
@@ -917,6 +951,9 @@ void on_rebuild_database1_activate (GSimpleAction *action, GVariant *parameter,
 
         // This widget will not actually appear until the first progress bar update.
 
+        /* Stop any search in progress, the search thread must not use the old cross-reference while it is rebuilt */
+        CALLBACKS_cancel_search();
+
         /* Rebuild the cross-reference */
         settings.noBuild = FALSE;   /* Override the noBuild setting (for this session only - leave preferences file as-is) */
         BUILD_initDatabase(lookup_widget(gscope_main, "rebuild_progressbar"));  /* Rebuild the cross-reference */
@@ -928,7 +965,7 @@ void on_rebuild_database1_activate (GSimpleAction *action, GVariant *parameter,
          * Reset the record of the last query so that the next query will not
          * be reported as current.
          */
-        process_query(FIND_NULL);
+        process_query(FIND_NULL, NULL);
 
         gtk_widget_hide(lookup_widget(gscope_main, "rebuild_progressbar"));
         gtk_widget_show(lookup_widget(gscope_main, "status_label"));
@@ -967,7 +1004,7 @@ void on_clear_query_activate(GSimpleAction *action, GVariant *parameter, gpointe
     DISPLAY_history_clear();
 
     /* Reset the record of the last query so that the next query will not be reported as current */
-    process_query(FIND_NULL);
+    process_query(FIND_NULL, NULL);
 }
 
 
@@ -1009,7 +1046,7 @@ void on_ignorecase_activate(GtkMenuItem *menuitem, gpointer user_data)
     if ( gtk_check_menu_item_get_active(GTK_CHECK_MENU_ITEM(menuitem)) != settings.ignoreCase )
     {
         /* Reset the record of the last query so that the next query will not be reported as current */
-        process_query(FIND_NULL);
+        process_query(FIND_NULL, NULL);
     }
 }
 #else
@@ -1023,7 +1060,7 @@ void on_ignorecase_activate(GSimpleAction *action, GVariant *parameter, gpointer
     {
         g_simple_action_set_state(action, g_variant_new_boolean(settings.ignoreCase));
         /* Reset the record of the last query so that the next query will not be reported as current */
-        process_query(FIND_NULL);
+        process_query(FIND_NULL, NULL);
     }
 }
 #endif
@@ -1442,6 +1479,7 @@ void on_session_statistics_activate(GSimpleAction *action, GVariant *parameter,
     gchar working[MAX_STATS_PATH + 1];
     gchar *offset_ptr;
     char  *cwd_ptr;
+    gchar *history_markup;
 
 
     if (!stats_visible)
@@ -1660,6 +1698,17 @@ void on_session_statistics_activate(GSimpleAction *action, GVariant *parameter,
         sprintf(tmp_str, "<span size=\"large\" color=\"blue\">%d</span>", symbol_stats.include_cnt);
         gtk_label_set_label(GTK_LABEL(lookup_widget(GTK_WIDGET(stats_dialog), "include_file_count_label")), tmp_str);
 
+        sprintf(tmp_str, "<span size=\"large\" color=\"blue\">%d</span>", symbol_stats.cache_hits);
+        gtk_label_set_label(GTK_LABEL(lookup_widget(GTK_WIDGET(stats_dialog), "query_cache_hits_label")), tmp_str);
+
+        sprintf(tmp_str, "(%d misses, %d cached queries, %lu KB)", symbol_stats.cache_misses, symbol_stats.cache_entries,
+                (unsigned long) (symbol_stats.cache_bytes / 1024));
+        gtk_label_set_label(GTK_LABEL(lookup_widget(GTK_WIDGET(stats_dialog), "query_cache_info_label")), tmp_str);
+
+        history_markup = query_history_markup();
+        gtk_label_set_markup(GTK_LABEL(lookup_widget(GTK_WIDGET(stats_dialog), "query_history_label")), history_markup);
+        g_free(history_markup);
+
         gtk_window_set_transient_for(GTK_WINDOW(stats_dialog), GTK_WINDOW(gscope_main));
 
         gtk_widget_show(stats_dialog);
@@ -1678,7 +1727,7 @@ void on_list_all_functions1_activate(GSimpleAction *action, GVariant *parameter,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_ALL_FUNCTIONS);
+        process_query(FIND_ALL_FUNCTIONS, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -1693,7 +1742,7 @@ void on_list_autogen_errors_activate(GSimpleAction *action, GVariant *parameter,
     if ( !search_button_lockout )
     {
         search_button_lockout = TRUE;
-        process_query(FIND_AUTOGEN_ERRORS);
+        process_query(FIND_AUTOGEN_ERRORS, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -1720,6 +1769,12 @@ void on_usage1_activate(GSimpleAction *action, GVariant *parameter, gpointer use
        "\n  -b, --refOnly"
        "\n                          Build the cross-reference only"
        "\n                          (don't start GUI)."
+       "\n  --buildProfile=FILE"
+       "\n                          Write the time of every build phase,"
+       "\n                          source file and directory to FILE [JSON]."
+       "\n  --buildTrace=FILE"
+       "\n                          Write a timeline of the cross-reference"
+       "\n                          build to FILE [Chrome trace-event format]."
        "\n  -c, --compressOff"
        "\n                          Use only ASCII characters in the"
        "\n                          cross-reference file (don't compress)."
@@ -1735,6 +1790,19 @@ void on_usage1_activate(GSimpleAction *action, GVariant *parameter, gpointer use
        "\n  -I, --includeDir=PATH"
        "\n                          Use the specified directory search path"
        "\n                          to find #include files. (:dir1:dir2:dirN:)"
+       "\n  -q, --query=QUERY"
+       "\n                          Run the query [type:pattern] against the"
+       "\n                          existing cross-reference and print the"
+       "\n                          results (don't start GUI)."
+       "\n  --queryFile=FILE"
+       "\n                          Run the queries listed in FILE, one per"
+       "\n                          line ('-' = stdin)."
+       "\n  --queryLog=FILE"
+       "\n                          Append every query [type:pattern, then"
+       "\n                          its work as a # comment] to FILE, a"
+       "\n                          trace that --queryFile can run again."
+       "\n  --json"
+       "\n                          Print query results as JSON lines."
        "\n  -r, --rcFile=FILE"
        "\n                          Start Gscope using the preferences info"
        "\n                          from FILE."
@@ -1742,6 +1810,10 @@ void on_usage1_activate(GSimpleAction *action, GVariant *parameter, gpointer use
        "\n                          Recursively search all subdirecties"
        "\n                          [Default = search below &lt;current-dir&gt;]"
        "\n                          for source files."
+       "\n  --server=SOCKET"
+       "\n                          Answer queries from other programs on"
+       "\n                          the Unix domain socket SOCKET (don't"
+       "\n                          start GUI)."
        "\n  -S, --srcDir=DIRECTORY"
        "\n                          Search the specified directory for source"
        "\n                          files.  When used with -R, use DIRECTORY"
@@ -1952,7 +2024,7 @@ void on_find_c_identifier_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_SYMBOL);
+        process_query(FIND_SYMBOL, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -1964,7 +2036,7 @@ void on_find_definition_of_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_DEF);
+        process_query(FIND_DEF, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -1976,7 +2048,7 @@ void on_find_functions_called_by_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_CALLEDBY);
+        process_query(FIND_CALLEDBY, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -1988,7 +2060,7 @@ void on_find_functions_calling_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_CALLING);
+        process_query(FIND_CALLING, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -2000,7 +2072,7 @@ void on_find_text_string_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_STRING);
+        process_query(FIND_STRING, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -2012,7 +2084,7 @@ void on_find_egrep_pattern_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_REGEXP);
+        process_query(FIND_REGEXP, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -2024,7 +2096,7 @@ void on_find_files_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_FILE);
+        process_query(FIND_FILE, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -2036,7 +2108,7 @@ void on_find_files_including_button_clicked(GtkButton       *button,
     if (!search_button_lockout)
     {
         search_button_lockout = TRUE;
-        process_query(FIND_INCLUDING);
+        process_query(FIND_INCLUDING, NULL);
         search_button_lockout = FALSE;
     }
 }
@@ -2047,8 +2119,11 @@ void on_find_files_including_button_clicked(GtkButton       *button,
 void on_cancel_button_clicked(GtkButton       *button,
                               gpointer         user_data)
 {
-    SEARCH_cancel();           // Signal the search routine to stop
-    cancel_requested = TRUE;   // Set the cancel indicator - UI will report that search results are truncated.
+    if (active_search)
+    {
+        SEARCH_token_cancel(active_search);     // Signal the search thread to stop
+        cancel_requested = TRUE;                // Set the cancel indicator - UI will report that search results are truncated.
+    }
 }
 
 
@@ -2134,6 +2209,42 @@ void on_open_quick_view(GtkWidget *menuitem, gchar *file_and_line)
 }
 
 
+void on_find_outline(GtkWidget *menuitem, gchar *file_and_line)
+{
+    gchar            *linenum;
+
+    linenum = strchr(file_and_line, '|');
+
+    if (linenum)
+    {
+        *linenum = '\0';  // Null-terminate the filename
+
+        // List the definitions in this file
+        process_query(FIND_OUTLINE, file_and_line);
+    }
+    else
+        fprintf(stderr, "Warning: Unexpected file_and_line parse error in %s()\n", __func__);
+}
+
+
+void on_find_includers(GtkWidget *menuitem, gchar *file_and_line)
+{
+    gchar            *linenum;
+
+    linenum = strchr(file_and_line, '|');
+
+    if (linenum)
+    {
+        *linenum = '\0';  // Null-terminate the filename
+
+        // List every file that includes this one, at any #include depth
+        process_query(FIND_INCLUDERS, file_and_line);
+    }
+    else
+        fprintf(stderr, "Warning: Unexpected file_and_line parse error in %s()\n", __func__);
+}
+
+
 
 #ifndef GTK4_BUILD  // Consider replacing this function with on_history_treeview_row_activated (GTK4 solution - #else below)
 gboolean on_history_treeview_button_press_event(GtkWidget *widget, GdkEventButton *event, gpointer user_data)
@@ -2224,6 +2335,17 @@ void show_context_menu(GtkWidget *treeview, GdkEventButton *event, gchar *filena
         menu_item = gtk_menu_item_new_with_label("Quick-View");
         gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
         g_signal_connect(menu_item, "activate", (GCallback)on_open_quick_view, file_and_line);
+
+        menu_item = gtk_separator_menu_item_new();
+        gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+
+        menu_item = gtk_menu_item_new_with_label("Outline This File");
+        gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+        g_signal_connect(menu_item, "activate", (GCallback)on_find_outline, file_and_line);
+
+        menu_item = gtk_menu_item_new_with_label("Files Including This File");
+        gtk_menu_shell_append(GTK_MENU_SHELL(menu), menu_item);
+        g_signal_connect(menu_item, "activate", (GCallback)on_find_includers, file_and_line);
     }
 
 
@@ -2634,7 +2756,7 @@ void on_suffix_entry_focus_out_event(GtkEventControllerFocus *controller, gpoint
 
         if (strcmp(settings.suffixList, suffix_list) != 0)  // Only update if a real change has been made
         {
-            if (APP_CONFIG_valid_list("File Suffix List", (char *)suffix_list, &settings.suffixDelim))
+            if (SETTINGS_valid_list("File Suffix List", (char *)suffix_list, &settings.suffixDelim))
             {
                 // Update the preferences file
                 APP_CONFIG_set_string("suffixList", suffix_list);
@@ -2671,7 +2793,7 @@ void on_typeless_entry_focus_out_event(GtkEventControllerFocus *controller, gpoi
 
         if (strcmp(settings.typelessList, typeless_list) != 0)  // Only update if a real change has been made
         {
-            if (APP_CONFIG_valid_list("Typeless File List", (char *)typeless_list, &settings.typelessDelim))
+            if (SETTINGS_valid_list("Typeless File List", (char *)typeless_list, &settings.typelessDelim))
             {
                 // Update the preferences file
                 APP_CONFIG_set_string("typelessList", typeless_list);
@@ -2708,7 +2830,7 @@ void on_ignored_entry_focus_out_event(GtkEventControllerFocus *controller, gpoin
 
         if (strcmp(settings.ignoredList, ignored_list) != 0)  // Only update if a real change has been made
         {
-            if (APP_CONFIG_valid_list("Ignored Directory List", (char *)ignored_list, &settings.ignoredDelim))
+            if (SETTINGS_valid_list("Ignored Directory List", (char *)ignored_list, &settings.ignoredDelim))
             {
                 // Update the preferences file
                 APP_CONFIG_set_string("ignoredList", ignored_list);
@@ -2779,7 +2901,7 @@ void on_include_entry_focus_out_event(GtkEventControllerFocus *controller, gpoin
 
         if (strcmp(settings.includeDir, include_list) != 0)  // Only update if a real change has been made
         {
-            if (APP_CONFIG_valid_list("Include File Search Path", (char *)include_list, &settings.includeDirDelim))
+            if (SETTINGS_valid_list("Include File Search Path", (char *)include_list, &settings.includeDirDelim))
             {
                 // Update the preferences file
                 APP_CONFIG_set_string("includeDir", include_list);
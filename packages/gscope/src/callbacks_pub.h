@@ -1,7 +1,11 @@
+#include "search.h"     /* search_t */
+
 
 void        CALLBACKS_init(GtkWidget *main);
 #if defined (GTK4_BUILD)
 void        CALLBACKS_register_app(GtkApplication *app);
 #endif
 GtkWidget   *CALLBACKS_get_widget(gchar *widget_name);
+void        CALLBACKS_process_query(search_t query_type, const gchar *pattern);
+void        CALLBACKS_cancel_search(void);
 
@@ -0,0 +1,529 @@
+/*
+ *  gscope call graph
+ *
+ *  The FCNDEF/FCNCALL marks of the cross-reference, collected (in one pass) into compressed
+ *  sparse row adjacency arrays:  for every function id, the calls made by its definitions
+ *  and the calls made to it, each in database order.  Direct caller/callee queries become
+ *  array lookups, and transitive queries (reachability, call paths) become graph walks.
+ *
+ *  The calls are attributed exactly as the database walkers attribute them:
+ *    - callees:  every call from a function definition to the end of the function (or file),
+ *                as find_called_by() reports them.
+ *    - callers:  the enclosing macro, else the enclosing function, as find_calling() reports them.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "build.h"
+#include "scanner.h"        /* for mark definitions */
+#include "cgraph.h"
+#include "scan.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define MAX_SYMBOL_SIZE     1024
+#define NO_ID               G_MAXUINT32
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+/* A call, and the function it belongs to in the adjacency arrays */
+typedef struct
+{
+    guint32         key;
+    cgraph_call_t   call;
+} raw_call_t;
+
+
+struct _cgraph
+{
+    GStringChunk    *strings;       /* Function and file names */
+    GPtrArray       *names;         /* id -> function name */
+    GHashTable      *ids;           /* function name -> id + 1 */
+    GPtrArray       *files;         /* file -> file name */
+
+    cgraph_call_t   *calls_out;     /* Calls made by each function... */
+    guint           *out_start;     /* ...function id's calls start at calls_out[out_start[id]] (num names + 1 entries) */
+    cgraph_call_t   *calls_in;      /* Calls made to each function */
+    guint           *in_start;
+};
+
+
+/* Call path search state (see CGRAPH_paths) */
+typedef struct
+{
+    const cgraph_t      *graph;
+    guint               to;
+    guint               *distance;      /* Minimum number of calls from each function to 'to' */
+    gboolean            *on_path;
+    guint               *stamp;         /* Used to follow only the first call from a function to each callee */
+    guint               next_stamp;
+    const cgraph_call_t **path;
+    guint               max_paths;
+    guint               num_paths;
+    GPtrArray           *result;
+} path_search_t;
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static void     read_name   (char **read_ptr, char *name);
+static guint32  intern      (cgraph_t *graph, const char *name);
+static void     build_csr   (GArray *raw, guint num_names, cgraph_call_t **calls, guint **start);
+static void     find_paths  (path_search_t *search, guint id, guint depth, guint remaining);
+
+
+
+/* Copy the (digraph-compressed) name at *read_ptr into <name>, advancing *read_ptr to the newline */
+static void read_name(char **read_ptr, char *name)
+{
+    char            *src_ptr = *read_ptr;
+    char            *dest_ptr = name;
+    unsigned char   c;
+
+    while ( ((c = *src_ptr) != '\n') && (dest_ptr - name < MAX_SYMBOL_SIZE - 2) )
+    {
+        if (c & 0x80)
+        {
+            c &= 0x7f;
+            *dest_ptr++ = dichar1[c / 8];
+            *dest_ptr++ = dichar2[c & 7];
+        }
+        else
+        {
+            *dest_ptr++ = c;
+        }
+        src_ptr++;
+    }
+    *dest_ptr = '\0';
+
+    *read_ptr = SCAN_newline(src_ptr);
+}
+
+
+
+/* Return the id of <name>, assigning the next id to a new name */
+static guint32 intern(cgraph_t *graph, const char *name)
+{
+    guint32 id;
+    gchar   *copy;
+
+    id = GPOINTER_TO_UINT( g_hash_table_lookup(graph->ids, name) );
+    if (id == 0)
+    {
+        copy = g_string_chunk_insert(graph->strings, name);
+        g_ptr_array_add(graph->names, copy);
+        id = graph->names->len;
+        g_hash_table_insert(graph->ids, copy, GUINT_TO_POINTER(id));
+    }
+
+    return(id - 1);
+}
+
+
+
+/* Group the <raw> calls by key (a counting sort, so each function's calls stay in database order) */
+static void build_csr(GArray *raw, guint num_names, cgraph_call_t **calls, guint **start)
+{
+    guint       *next;
+    raw_call_t  *entry;
+    guint       i;
+
+    *calls = g_new(cgraph_call_t, MAX(raw->len, 1));
+    *start = g_new0(guint, num_names + 1);
+    next   = g_new(guint, num_names);
+
+    for (i = 0; i < raw->len; i++)
+    {
+        (*start)[g_array_index(raw, raw_call_t, i).key + 1]++;
+    }
+    for (i = 0; i < num_names; i++)
+    {
+        (*start)[i + 1] += (*start)[i];
+        next[i] = (*start)[i];
+    }
+    for (i = 0; i < raw->len; i++)
+    {
+        entry = &g_array_index(raw, raw_call_t, i);
+        (*calls)[next[entry->key]++] = entry->call;
+    }
+
+    g_free(next);
+}
+
+
+
+/* Depth-first search for call paths from <id> to search->to, using at most <remaining> more calls */
+static void find_paths(path_search_t *search, guint id, guint depth, guint remaining)
+{
+    const cgraph_call_t *calls;
+    guint               num_calls;
+    guint               stamp;
+    guint               i;
+
+    if (id == search->to)
+    {
+        for (i = 0; i < depth; i++) g_ptr_array_add(search->result, (gpointer) search->path[i]);
+        g_ptr_array_add(search->result, NULL);      /* End of path */
+        search->num_paths++;
+        return;
+    }
+
+    search->on_path[id] = TRUE;
+    stamp = search->next_stamp++;
+
+    num_calls = CGRAPH_callees(search->graph, id, &calls);
+    for (i = 0; (i < num_calls) && (search->num_paths < search->max_paths); i++)
+    {
+        guint callee = calls[i].name;
+
+        if ( search->on_path[callee] ) continue;                    /* Only simple paths */
+        if ( search->distance[callee] > remaining - 1 ) continue;   /* Can't get there from here */
+        if ( search->stamp[callee] == stamp ) continue;             /* Already followed from here */
+        search->stamp[callee] = stamp;
+
+        search->path[depth] = &calls[i];
+        find_paths(search, callee, depth + 1, remaining - 1);
+    }
+
+    search->on_path[id] = FALSE;
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Build the call graph of the memory-resident cross-reference <cref_buf> */
+cgraph_t *CGRAPH_build(const gchar *cref_buf)
+{
+    cgraph_t    *graph;
+    GArray      *raw_out;
+    GArray      *raw_in;
+    GArray      *open_defs;     /* Functions whose definitions are still open (see find_called_by_sub) */
+    raw_call_t  raw;
+    char        *read_ptr;
+    char        name[MAX_SYMBOL_SIZE];
+    guint32     file;
+    guint32     function;
+    guint32     macro    = NO_ID;
+    guint32     callee;
+    guint32     global;
+    guint32     no_function;
+    guint       i;
+    gboolean    done = FALSE;
+
+    graph = g_new0(cgraph_t, 1);
+    graph->strings = g_string_chunk_new(64 * 1024);
+    graph->names   = g_ptr_array_new();
+    graph->ids     = g_hash_table_new(g_str_hash, g_str_equal);
+    graph->files   = g_ptr_array_new();
+
+    raw_out   = g_array_new(FALSE, FALSE, sizeof(raw_call_t));
+    raw_in    = g_array_new(FALSE, FALSE, sizeof(raw_call_t));
+    open_defs = g_array_new(FALSE, FALSE, sizeof(guint32));
+
+    global      = intern(graph, "<global>");    /* The caller outside of any function (search.c 'global') */
+    no_function = intern(graph, "");            /* The caller after a function end */
+
+    read_ptr = (char *) cref_buf;
+    read_ptr = SCAN_past_tab(read_ptr);     /* Skip the header */
+    read_ptr++;                             /* Skip the file marker */
+    read_name(&read_ptr, name);             /* Get the first file name */
+    g_ptr_array_add(graph->files, g_string_chunk_insert(graph->strings, name));
+    file = 0;
+    function = no_function;                 /* Like find_calling(): the first file starts with no function */
+
+    while (!done)
+    {
+        /* Find the next mark */
+        read_ptr = SCAN_past_tab(read_ptr);
+
+        switch (*read_ptr)
+        {
+            case NEWFILE:
+                read_ptr++;
+                read_name(&read_ptr, name);
+
+                /* Check for the end of the symbols */
+                if (*name == '\0')
+                {
+                    done = TRUE;
+                    continue;
+                }
+                g_ptr_array_add(graph->files, g_string_chunk_insert(graph->strings, name));
+                file = graph->files->len - 1;
+                function = global;
+                g_array_set_size(open_defs, 0);
+            break;
+
+            case DEFINE:
+                read_ptr++;
+                read_name(&read_ptr, name);
+                macro = intern(graph, name);
+            break;
+
+            case DEFINEEND:
+                macro = NO_ID;
+            break;
+
+            case FCNDEF:
+                read_ptr++;
+                read_name(&read_ptr, name);
+                function = intern(graph, name);
+
+                for (i = 0; (i < open_defs->len) && (g_array_index(open_defs, guint32, i) != function); i++);
+                if (i == open_defs->len) g_array_append_val(open_defs, function);
+            break;
+
+            case FCNEND:
+                function = no_function;
+                g_array_set_size(open_defs, 0);
+            break;
+
+            case FCNCALL:
+                read_ptr++;
+                read_name(&read_ptr, name);
+                callee = intern(graph, name);
+
+                raw.call.file = file;
+                raw.call.site = read_ptr - cref_buf;
+
+                raw.key       = callee;
+                raw.call.name = (macro != NO_ID) ? macro : function;
+                g_array_append_val(raw_in, raw);
+
+                raw.call.name = callee;
+                for (i = 0; i < open_defs->len; i++)
+                {
+                    raw.key = g_array_index(open_defs, guint32, i);
+                    g_array_append_val(raw_out, raw);
+                }
+            break;
+
+            default:
+                /* do nothing */
+            break;
+        }
+    }
+
+    build_csr(raw_out, graph->names->len, &graph->calls_out, &graph->out_start);
+    build_csr(raw_in,  graph->names->len, &graph->calls_in,  &graph->in_start);
+
+    g_array_free(raw_out, TRUE);
+    g_array_free(raw_in, TRUE);
+    g_array_free(open_defs, TRUE);
+
+    return(graph);
+}
+
+
+
+void CGRAPH_free(cgraph_t *graph)
+{
+    if (graph == NULL) return;
+
+    g_free(graph->calls_out);
+    g_free(graph->out_start);
+    g_free(graph->calls_in);
+    g_free(graph->in_start);
+    g_hash_table_destroy(graph->ids);
+    g_ptr_array_free(graph->names, TRUE);
+    g_ptr_array_free(graph->files, TRUE);
+    g_string_chunk_free(graph->strings);
+    g_free(graph);
+}
+
+
+
+/* Return the id of the function <name>, or -1 if it is neither called nor defined */
+gint CGRAPH_id(const cgraph_t *graph, const gchar *name)
+{
+    return( (gint) GPOINTER_TO_UINT( g_hash_table_lookup(graph->ids, name) ) - 1 );
+}
+
+
+
+const gchar *CGRAPH_name(const cgraph_t *graph, guint id)
+{
+    return( g_ptr_array_index(graph->names, id) );
+}
+
+
+
+const gchar *CGRAPH_file(const cgraph_t *graph, guint file)
+{
+    return( g_ptr_array_index(graph->files, file) );
+}
+
+
+
+/* Return the number of calls made by (the definitions of) function <id>, and the calls themselves */
+guint CGRAPH_callees(const cgraph_t *graph, guint id, const cgraph_call_t **calls)
+{
+    *calls = &graph->calls_out[graph->out_start[id]];
+    return( graph->out_start[id + 1] - graph->out_start[id] );
+}
+
+
+
+/* Return the number of calls made to function <id>, and the calls themselves */
+guint CGRAPH_callers(const cgraph_t *graph, guint id, const cgraph_call_t **calls)
+{
+    *calls = &graph->calls_in[graph->in_start[id]];
+    return( graph->in_start[id + 1] - graph->in_start[id] );
+}
+
+
+
+/*
+ * Return every function reachable from function <id> through at most <depth> calls, as the
+ * calls through which each one was first reached (an array of const cgraph_call_t *), nearest
+ * first.  The caller must free the array.
+ */
+GPtrArray *CGRAPH_reachable(const cgraph_t *graph, guint id, guint depth)
+{
+    GPtrArray           *result;
+    gboolean            *visited;
+    GArray              *level;         /* The functions first reached with the previous call */
+    GArray              *next_level;
+    const cgraph_call_t *calls;
+    guint               num_calls;
+    guint               i, j;
+
+    result  = g_ptr_array_new();
+    visited = g_new0(gboolean, graph->names->len);
+    level   = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    visited[id] = TRUE;
+    g_array_append_val(level, id);
+
+    /* Breadth-first:  the callees of <id>, then their callees... */
+    for (; (depth > 0) && (level->len > 0); depth--)
+    {
+        next_level = g_array_new(FALSE, FALSE, sizeof(guint));
+
+        for (i = 0; i < level->len; i++)
+        {
+            num_calls = CGRAPH_callees(graph, g_array_index(level, guint, i), &calls);
+            for (j = 0; j < num_calls; j++)
+            {
+                if ( !visited[calls[j].name] )
+                {
+                    visited[calls[j].name] = TRUE;
+                    g_ptr_array_add(result, (gpointer) &calls[j]);
+                    g_array_append_val(next_level, calls[j].name);
+                }
+            }
+        }
+
+        g_array_free(level, TRUE);
+        level = next_level;
+    }
+
+    g_array_free(level, TRUE);
+    g_free(visited);
+    return(result);
+}
+
+
+
+/*
+ * Return the call paths from function <from> to function <to>: at most <max_paths> paths of at
+ * most <max_depth> calls each.  The result is an array of const cgraph_call_t *: the calls
+ * of each path in order, followed by NULL.  Paths do not visit a function twice, and only the
+ * first call from one function to another is followed.  The caller must free the array.
+ */
+GPtrArray *CGRAPH_paths(const cgraph_t *graph, guint from, guint to, guint max_depth, guint max_paths)
+{
+    path_search_t   search;
+    guint           num_names = graph->names->len;
+    guint           *rev_start;     /* The callers of each function (reversing calls_out) */
+    guint32         *rev_callers;
+    guint           *next;
+    guint           *queue;
+    guint           head, tail;
+    guint           id, i, j;
+
+    search.graph      = graph;
+    search.to         = to;
+    search.distance   = g_new(guint, num_names);
+    search.on_path    = g_new0(gboolean, num_names);
+    search.stamp      = g_new0(guint, num_names);
+    search.next_stamp = 1;
+    search.path       = g_new(const cgraph_call_t *, max_depth + 1);
+    search.max_paths  = max_paths;
+    search.num_paths  = 0;
+    search.result     = g_ptr_array_new();
+
+    if ( (from != to) && (max_depth > 0) )
+    {
+        /* Reverse the callee lists... */
+        rev_start   = g_new0(guint, num_names + 1);
+        rev_callers = g_new(guint32, MAX(graph->out_start[num_names], 1));
+        next        = g_new(guint, num_names);
+
+        for (i = 0; i < graph->out_start[num_names]; i++) rev_start[graph->calls_out[i].name + 1]++;
+        for (i = 0; i < num_names; i++)
+        {
+            rev_start[i + 1] += rev_start[i];
+            next[i] = rev_start[i];
+        }
+        for (id = 0; id < num_names; id++)
+        {
+            for (j = graph->out_start[id]; j < graph->out_start[id + 1]; j++)
+            {
+                rev_callers[next[graph->calls_out[j].name]++] = id;
+            }
+        }
+
+        /* ...to find the distance from every function to <to> (breadth-first, backwards from <to>) */
+        queue = next;   /* reused */
+        for (i = 0; i < num_names; i++) search.distance[i] = G_MAXUINT;
+        search.distance[to] = 0;
+        queue[0] = to;
+        for (head = 0, tail = 1; head < tail; head++)
+        {
+            id = queue[head];
+            if (search.distance[id] >= max_depth) continue;
+
+            for (j = rev_start[id]; j < rev_start[id + 1]; j++)
+            {
+                if (search.distance[rev_callers[j]] == G_MAXUINT)
+                {
+                    search.distance[rev_callers[j]] = search.distance[id] + 1;
+                    queue[tail++] = rev_callers[j];
+                }
+            }
+        }
+
+        g_free(rev_start);
+        g_free(rev_callers);
+        g_free(next);
+
+        if (search.distance[from] <= max_depth)
+        {
+            find_paths(&search, from, 0, max_depth);
+        }
+    }
+
+    g_free(search.distance);
+    g_free(search.on_path);
+    g_free(search.stamp);
+    g_free(search.path);
+
+    return(search.result);
+}
@@ -0,0 +1,32 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+/* The call graph of a cross-reference.  Every function name (callers, callees, and the
+   pseudo-callers "<global>" and "") is identified by a small id (0, 1, 2...). */
+typedef struct _cgraph cgraph_t;
+
+
+/* A function call */
+typedef struct
+{
+    guint32     name;       /* The other end of the call: the callee for CGRAPH_callees(), the caller for CGRAPH_callers() */
+    guint32     file;       /* The file containing the call */
+    gsize       site;       /* Offset of the call [the end of the called name] in the cross-reference */
+} cgraph_call_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+cgraph_t       *CGRAPH_build     (const gchar *cref_buf);
+void            CGRAPH_free      (cgraph_t *graph);
+gint            CGRAPH_id        (const cgraph_t *graph, const gchar *name);
+const gchar    *CGRAPH_name      (const cgraph_t *graph, guint id);
+const gchar    *CGRAPH_file      (const cgraph_t *graph, guint file);
+guint           CGRAPH_callees   (const cgraph_t *graph, guint id, const cgraph_call_t **calls);
+guint           CGRAPH_callers   (const cgraph_t *graph, guint id, const cgraph_call_t **calls);
+GPtrArray      *CGRAPH_reachable (const cgraph_t *graph, guint id, guint depth);
+GPtrArray      *CGRAPH_paths     (const cgraph_t *graph, guint from, guint to, guint max_depth, guint max_paths);
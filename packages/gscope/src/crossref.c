@@ -7,7 +7,7 @@
 #include "config.h"
 #endif
 
-#include <gtk/gtk.h>
+#include <glib.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <string.h>
@@ -21,7 +21,8 @@
 #include "build.h"
 #include "lookup.h"
 #include "utils.h"
-#include "app_config.h"
+#include "settings.h"
+#include "probes.h"
 
 
 /* convert long to a string */
@@ -76,11 +77,14 @@ gboolean crossref(char *srcfile)
     int token;          /* current token */
     struct stat st;
 
+    PROBE1(crossref_start, srcfile);
+
     if (! ((stat(srcfile, &st) == 0)
            && S_ISREG(st.st_mode)))
     {
         my_cannotopen(srcfile);
         errorsfound = TRUE;
+        PROBE2(crossref_done, srcfile, FALSE);
         return(FALSE);
     }
 
@@ -90,6 +94,7 @@ gboolean crossref(char *srcfile)
     {
         my_cannotopen(srcfile);
         errorsfound = TRUE;
+        PROBE2(crossref_done, srcfile, FALSE);
         return(FALSE);
     }
     filename = srcfile; /* save the file name for warning messages */
@@ -176,6 +181,7 @@ gboolean crossref(char *srcfile)
 
                     /* output the leading tab expected by the next call */
                     dbputc('\t');
+                    PROBE2(crossref_done, srcfile, TRUE);
                     return(TRUE);
             }
         }
@@ -185,6 +191,7 @@ gboolean crossref(char *srcfile)
         fprintf(stderr,"WARNING: Skipping Source File: %s\n    It is not an ASCII text file.\n", srcfile);
         fclose(yyin);    /* close the source file */
     }
+    PROBE2(crossref_done, srcfile, FALSE);
     return(FALSE);
 }
 
@@ -395,6 +402,7 @@ static void putcrossref(void)
             {
                 dbputc('\t');
                 dbputc(type);
+                mark_counts[type]++;
             }
             else
             {
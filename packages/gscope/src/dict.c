@@ -0,0 +1,502 @@
+/*
+ *  gscope symbol dictionary
+ *
+ *  A sorted list of every distinct symbol in the cross-reference, with its reference count
+ *  and definition kind.  It is collected from the memory-resident cross-reference by a worker
+ *  thread [so loading the database, or typing a query, never waits for it], and answers prefix
+ *  and substring completion queries without scanning the database.  Until the collection is
+ *  finished there are no completions.
+ *
+ *  The names are stored, in sorted order, in a single NUL-separated pool:  prefix queries
+ *  are a binary search, substring queries are a single memmem() pass over the pool.  The names
+ *  that matched the last substring query are kept:  while a query is typed, each new text
+ *  contains the previous one, and only those names need to be checked again.
+ *
+ *  The DICT_ functions must all be called by the same thread [the UI thread].  The worker
+ *  only reads the cross-reference, and publishes the finished dictionary through 'ready'.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>      /* memmem() is a GNU extension: AC_USE_SYSTEM_EXTENSIONS provides _GNU_SOURCE */
+#include <stdlib.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "build.h"
+#include "scanner.h"        /* for mark definitions */
+#include "dict.h"
+#include "scan.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define MAX_SYMBOL_SIZE     1024
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+typedef struct
+{
+    guint32     offset;         /* Position of the name in the pool */
+    guint       refs;
+    gchar       kind;
+} dict_slot_t;
+
+
+/* A symbol collected while walking the cross-reference (name is owned by a GStringChunk) */
+typedef struct
+{
+    const gchar *name;
+    guint       refs;
+    gchar       kind;
+} build_slot_t;
+
+
+//===============================================================
+//       Private Global Variables
+//===============================================================
+
+static gchar        *pool      = NULL;      /* Sorted, NUL-separated symbol names */
+static gsize        pool_size  = 0;
+static dict_slot_t  *slots     = NULL;      /* One slot per name, in pool order */
+static guint        num_slots  = 0;
+static const gchar  *source    = NULL;      /* The cross-reference to collect the dictionary from (NULL = none) */
+static GThread      *collector = NULL;      /* The worker collecting the dictionary from 'source' (NULL = not started) */
+static gboolean     autostart  = FALSE;     /* Start collecting as soon as a cross-reference is loaded */
+static gint         ready      = FALSE;     /* Atomic: the collector has finished, the dictionary can be used */
+static gint         cancelled  = FALSE;     /* Atomic: the collector should give up [the cross-reference is going away] */
+static gchar        *last_text = NULL;      /* The text of the last substring query (NULL = none) */
+static GArray       *last_hits = NULL;      /* The slots [guint, in pool order] of every name containing 'last_text' */
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static gboolean expand_symbol   (char **read_ptr, char *symbol);
+static gint     compare_names   (const void *a, const void *b);
+static guint    slot_at_offset  (gsize offset);
+static void     rank_candidate  (dict_slot_t *slot, dict_entry_t *results, guint *count, guint max_results);
+static void     find_substring  (const gchar *text, dict_entry_t *results, guint *count, guint max_results);
+static gpointer collect         (gpointer data);
+static void     start_collector (void);
+static void     release         (void);
+
+
+
+/*
+ * Expand the (digraph-compressed) cross-reference text at *read_ptr into <symbol> and advance
+ * *read_ptr to the terminating newline.  Returns FALSE if the text is not a C symbol [the
+ * line number and non-symbol text of a source line].
+ */
+static gboolean expand_symbol(char **read_ptr, char *symbol)
+{
+    char            *src_ptr = *read_ptr;
+    char            *dest_ptr = symbol;
+    unsigned char   c;
+    gboolean        valid;
+
+    /* Quick check of the first character (a digraph's first character is checked after expansion) */
+    c = *src_ptr;
+    valid = (c & 0x80) || isalpha(c) || c == '_';
+
+    for (; valid && (c = *src_ptr) != '\n'; src_ptr++)
+    {
+        if (dest_ptr - symbol >= MAX_SYMBOL_SIZE - 2)
+        {
+            valid = FALSE;
+            break;
+        }
+
+        if (c & 0x80)
+        {
+            c &= 0x7f;
+            *dest_ptr++ = dichar1[c / 8];
+            *dest_ptr++ = dichar2[c & 7];
+        }
+        else
+        {
+            *dest_ptr++ = c;
+        }
+    }
+    *dest_ptr = '\0';
+
+    /* Some digraph characters are punctuation: check the expanded text */
+    for (dest_ptr = symbol; valid && *dest_ptr != '\0'; dest_ptr++)
+    {
+        valid = isalnum((unsigned char) *dest_ptr) || *dest_ptr == '_';
+    }
+    valid = valid && !isdigit((unsigned char) *symbol);
+
+    *read_ptr = SCAN_newline(src_ptr);
+    return(valid);
+}
+
+
+
+static gint compare_names(const void *a, const void *b)
+{
+    return( strcmp( ((const build_slot_t *) a)->name, ((const build_slot_t *) b)->name ) );
+}
+
+
+
+/* Return the index of the slot whose name contains pool position <offset> */
+static guint slot_at_offset(gsize offset)
+{
+    guint low  = 0;
+    guint high = num_slots;     /* slots[high].offset > offset */
+    guint mid;
+
+    while (high - low > 1)
+    {
+        mid = low + (high - low) / 2;
+        if (slots[mid].offset <= offset)
+            low = mid;
+        else
+            high = mid;
+    }
+
+    return(low);
+}
+
+
+
+/* Insert <slot> into the <results> list (ordered by reference count, most first) if it ranks high enough */
+static void rank_candidate(dict_slot_t *slot, dict_entry_t *results, guint *count, guint max_results)
+{
+    guint i;
+
+    if ( (*count == max_results) && (slot->refs <= results[max_results - 1].refs) )
+        return;     /* Doesn't make the cut (ties go to the name that sorts first) */
+
+    if (*count < max_results) (*count)++;
+
+    for (i = *count - 1; (i > 0) && (results[i - 1].refs < slot->refs); i--)
+    {
+        results[i] = results[i - 1];
+    }
+
+    results[i].name = pool + slot->offset;
+    results[i].refs = slot->refs;
+    results[i].kind = slot->kind;
+}
+
+
+
+/*
+ * Rank every name that contains <text>, but does not start with it.  If <text> contains the
+ * text of the previous query, only the names that matched it are checked.
+ */
+static void find_substring(const gchar *text, dict_entry_t *results, guint *count, guint max_results)
+{
+    gsize       text_len = strlen(text);
+    GArray      *hits;
+    gsize       offset;
+    gchar       *hit_ptr;
+    gchar       *name;
+    guint       i, slot;
+
+    hits = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    if ( last_text && strstr(text, last_text) )
+    {
+        /* Narrow the previous matches [a name containing <text> also contains 'last_text'] */
+        for (i = 0; i < last_hits->len; i++)
+        {
+            slot = g_array_index(last_hits, guint, i);
+            name = pool + slots[slot].offset;
+
+            if ( (hit_ptr = strstr(name, text)) == NULL ) continue;
+
+            g_array_append_val(hits, slot);
+            if (hit_ptr != name)        /* Prefix matches are reported by DICT_PREFIX */
+                rank_candidate(&slots[slot], results, count, max_results);
+        }
+    }
+    else
+    {
+        offset = 0;
+        while ( (hit_ptr = memmem(pool + offset, pool_size - offset, text, text_len)) != NULL )
+        {
+            slot = slot_at_offset(hit_ptr - pool);
+
+            g_array_append_val(hits, slot);
+            if (hit_ptr != pool + slots[slot].offset)       /* Prefix matches are reported by DICT_PREFIX */
+                rank_candidate(&slots[slot], results, count, max_results);
+
+            if (++slot == num_slots) break;
+            offset = slots[slot].offset;    /* Continue with the next name */
+        }
+    }
+
+    g_free(last_text);
+    if (last_hits) g_array_free(last_hits, TRUE);
+    last_text = g_strdup(text);
+    last_hits = hits;
+}
+
+
+
+/* Worker thread:  build the dictionary from the cross-reference <data> */
+static gpointer collect(gpointer data)
+{
+    GStringChunk    *names;
+    GHashTable      *index;         /* name -> position in 'found' + 1 */
+    GArray          *found;
+    build_slot_t    *entry;
+    const gchar     *name;
+    char            *read_ptr;
+    char            symbol[MAX_SYMBOL_SIZE];
+    gchar           kind;
+    gchar           *write_ptr;
+    guint           i;
+    gboolean        done = FALSE;
+
+    names = g_string_chunk_new(64 * 1024);
+    index = g_hash_table_new(g_direct_hash, g_direct_equal);
+    found = g_array_new(FALSE, FALSE, sizeof(build_slot_t));
+
+    read_ptr = (char *) data;
+    read_ptr = SCAN_past_tab(read_ptr);     /* Skip the header, scan past the next tab char */
+
+    while (!done)
+    {
+        /* find the next symbol */
+        read_ptr = SCAN_newline(read_ptr);
+        ++read_ptr;
+
+        kind = '\0';
+        if (*read_ptr == '\t')
+        {
+            switch ( *(++read_ptr) )
+            {
+                case NEWFILE:
+                    done = (read_ptr[1] == '\n') ||     /* An empty file name marks the end of the symbols */
+                           g_atomic_int_get(&cancelled);
+                    continue;
+
+                case FCNEND:
+                case DEFINEEND:
+                case INCLUDE:
+                    continue;       /* not a symbol */
+
+                case FCNCALL:
+                    break;          /* a reference, not a definition */
+
+                default:
+                    kind = *read_ptr;
+                break;
+            }
+            read_ptr++;
+        }
+
+        if ( !expand_symbol(&read_ptr, symbol) ) continue;
+
+        name = g_string_chunk_insert_const(names, symbol);
+        i = GPOINTER_TO_UINT( g_hash_table_lookup(index, name) );
+
+        if (i == 0)
+        {
+            g_array_set_size(found, found->len + 1);
+            entry = &g_array_index(found, build_slot_t, found->len - 1);
+            entry->name = name;
+            entry->refs = 0;
+            entry->kind = '\0';
+            g_hash_table_insert(index, (gpointer) name, GUINT_TO_POINTER(found->len));
+        }
+        else
+        {
+            entry = &g_array_index(found, build_slot_t, i - 1);
+        }
+
+        entry->refs++;
+        if (entry->kind == '\0') entry->kind = kind;    /* The first definition wins */
+    }
+
+    if ( g_atomic_int_get(&cancelled) )
+    {
+        g_array_free(found, TRUE);
+        g_hash_table_destroy(index);
+        g_string_chunk_free(names);
+        return(NULL);
+    }
+
+    /* Lay out the names in sorted order */
+    qsort(found->data, found->len, sizeof(build_slot_t), compare_names);
+
+    num_slots = found->len;
+    slots     = g_new(dict_slot_t, MAX(num_slots, 1));
+    pool_size = 0;
+    for (i = 0; i < num_slots; i++) pool_size += strlen(g_array_index(found, build_slot_t, i).name) + 1;
+    pool = g_malloc(MAX(pool_size, 1));
+
+    write_ptr = pool;
+    for (i = 0; i < num_slots; i++)
+    {
+        entry = &g_array_index(found, build_slot_t, i);
+        slots[i].offset = write_ptr - pool;
+        slots[i].refs   = entry->refs;
+        slots[i].kind   = entry->kind;
+        write_ptr = g_stpcpy(write_ptr, entry->name) + 1;
+    }
+
+    g_array_free(found, TRUE);
+    g_hash_table_destroy(index);
+    g_string_chunk_free(names);
+
+    g_atomic_int_set(&ready, TRUE);
+    return(NULL);
+}
+
+
+
+static void start_collector()
+{
+    if ( source && !collector )
+    {
+        g_atomic_int_set(&cancelled, FALSE);
+        collector = g_thread_new("gscope-dict", collect, (gpointer) source);
+    }
+}
+
+
+
+/* Stop any collection in progress, and discard the dictionary */
+static void release()
+{
+    if (collector)
+    {
+        g_atomic_int_set(&cancelled, TRUE);
+        g_thread_join(collector);
+        collector = NULL;
+    }
+    g_atomic_int_set(&ready, FALSE);
+
+    g_free(last_text);
+    if (last_hits) g_array_free(last_hits, TRUE);
+    last_text = NULL;
+    last_hits = NULL;
+
+    g_free(pool);
+    g_free(slots);
+    pool      = NULL;
+    slots     = NULL;
+    pool_size = 0;
+    num_slots = 0;
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/*
+ * Use the memory-resident cross-reference <cref_buf> for completion (discarding any previous
+ * dictionary).  The dictionary is collected in the background:  right away after DICT_autostart(),
+ * otherwise from the first DICT_complete() [headless sessions never pay for it].
+ */
+void DICT_init(const gchar *cref_buf)
+{
+    release();
+    source = cref_buf;
+    if (autostart) start_collector();
+}
+
+
+
+/* Collect the dictionary of every cross-reference as soon as it is loaded [interactive sessions] */
+void DICT_autostart()
+{
+    autostart = TRUE;
+    start_collector();
+}
+
+
+
+/* Discard the dictionary.  Must be called before the cross-reference it was collected from goes away. */
+void DICT_free()
+{
+    release();
+    source = NULL;
+}
+
+
+
+/*
+ * Find up to <max_results> symbols matching <text>, ranked by reference count (most first).
+ * Returns the number of <results> [none while the dictionary is still being collected].
+ */
+guint DICT_complete(const gchar *text, dict_match_t match, dict_entry_t *results, guint max_results)
+{
+    gsize       text_len = strlen(text);
+    guint       count = 0;
+    guint       low, high, mid;
+
+    start_collector();
+    if ( !g_atomic_int_get(&ready) ) return(0);
+
+    if ( (num_slots == 0) || (text_len == 0) || (max_results == 0) ) return(0);
+
+    if (match == DICT_PREFIX)
+    {
+        /* Binary search for the first name >= text.  Every match follows it. */
+        low  = 0;
+        high = num_slots;
+        while (low < high)
+        {
+            mid = low + (high - low) / 2;
+            if (strcmp(pool + slots[mid].offset, text) < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        for (; (low < num_slots) && (strncmp(pool + slots[low].offset, text, text_len) == 0); low++)
+        {
+            rank_candidate(&slots[low], results, &count, max_results);
+        }
+    }
+    else
+    {
+        find_substring(text, results, &count, max_results);
+    }
+
+    return(count);
+}
+
+
+
+/* Return a description of a definition kind (as returned in dict_entry_t) */
+const gchar *DICT_kind_name(gchar kind)
+{
+    switch (kind)
+    {
+        case FCNDEF:    return("function");
+        case DEFINE:    return("macro");
+        case STRUCTDEF: return("struct");
+        case CLASSDEF:  return("class");
+        case ENUMDEF:   return("enum");
+        case UNIONDEF:  return("union");
+        case TYPEDEF:   return("typedef");
+        case GLOBALDEF: return("global");
+        case MEMBERDEF: return("member");
+        default:        return("");
+    }
+}
+
+
+
+/* Return the number of distinct symbols in the dictionary (0 until it has been collected) */
+guint DICT_size()
+{
+    return( g_atomic_int_get(&ready) ? num_slots : 0 );
+}
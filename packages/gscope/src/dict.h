@@ -0,0 +1,31 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+typedef enum
+{
+    DICT_PREFIX,        /* Symbols that start with the text */
+    DICT_SUBSTRING      /* Symbols that contain the text (but do not start with it) */
+} dict_match_t;
+
+
+/* A completion candidate.  'name' remains valid until the next DICT_init() */
+typedef struct
+{
+    const gchar *name;
+    guint       refs;       /* Number of references to the symbol in the cross-reference */
+    gchar       kind;       /* Definition mark [e.g. '$' function, '#' macro, 's' struct] or '\0' if not defined */
+} dict_entry_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+void            DICT_init       (const gchar *cref_buf);
+void            DICT_autostart  (void);
+void            DICT_free       (void);
+guint           DICT_complete   (const gchar *text, dict_match_t match, dict_entry_t *results, guint max_results);
+const gchar    *DICT_kind_name  (gchar kind);
+guint           DICT_size       (void);
@@ -7,7 +7,7 @@
 #include "config.h"
 #endif
 
-#include <gtk/gtk.h>
+#include <glib.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
@@ -20,19 +20,17 @@
 #include <stdint.h>
 #include <errno.h>
 
-#include "app_config.h"
+#include "settings.h"
 #include "utils.h"
 #include "dir.h"
 #include "build.h"
 #include "scanner.h"
 #include "search.h"
-#include "display.h"
 #include "auto_gen.h"
-#ifdef GTK4_BUILD
-#include "callbacks_pub.h"
-#else
-#include "callbacks.h"
-#endif
+#include "scan.h"
+#include "engine.h"
+#include "profile.h"
+#include "probes.h"
 
 
 //===============================================================
@@ -206,6 +204,8 @@ static int      max_include_dirs;           /* maximum number of #include direct
 static char     *master_ignored_list = NULL;
 static char     master_ignored_delim;
 
+static GArray   *suffix_counts = NULL;      /* dir_suffix_count_t, in suffix list order, then the no-suffix count */
+
 static int      fileargc;          /* file argument count */
 static char     **fileargv;        /* file argument values */
 
@@ -273,6 +273,7 @@ void DIR_init(dir_init_e init_type)
     else
     {
         _alloc_src_file_list();         // Allocate (or clear) the source file list (and the src_file hash table)
+        _init_include_dir_list();       // The #include graph resolves names through the search-list [DIR_incfile_candidates]
     }
 }
 
@@ -368,7 +369,7 @@ char *DIR_get_path(get_method_e method)
                 my_asprintf(&src_dir, "%s", settings.srcDir);
 
             if ( !settings.refOnly )                // When in GUI mode
-                DISPLAY_update_path_label(src_dir); // Update the "path label" on the main window
+                ENGINE_src_dir(src_dir);            // Update the "path label" on the main window
 
 
             /*** Set the autogen_cache Directory ***/
@@ -492,11 +493,7 @@ void DIR_create_offset_hash(char *buf_ptr)
     while ( TRUE )
     {
         /* Find the next file and offset - By definition, there are no duplicate file names */
-        do
-        {
-            while ( *buf_ptr++ != '\t' );
-        }
-        while ( *buf_ptr++ != NEWFILE );
+        buf_ptr = SCAN_past_mark(buf_ptr, NEWFILE);
 
         if ( *buf_ptr == '\n')
         {
@@ -506,13 +503,7 @@ void DIR_create_offset_hash(char *buf_ptr)
 
         offset_ptr = buf_ptr - 2;   /* Get the offset for this cref section */
 
-        name_len = 0;
-        while ( *buf_ptr++ != '\n')
-        {
-            name_len++;
-        }
-
-        buf_ptr -= (name_len + 1);  /* reset the pointer to the beginning of the file name string */
+        name_len = SCAN_newline(buf_ptr) - buf_ptr;
 
         /* Malloc a string buffer */
         file_name = g_malloc(name_len + 1);
@@ -669,7 +660,7 @@ void DIR_list_join(char *usr_list, dir_list_e dir_list)
                                                  );
             }
 
-            if ( !APP_CONFIG_valid_list("Master Ignored List", master_ignored_list, &master_ignored_delim) )
+            if ( !SETTINGS_valid_list("Master Ignored List", master_ignored_list, &master_ignored_delim) )
                  exit(EXIT_FAILURE);
         break;
 
@@ -792,11 +783,7 @@ static void _make_src_file_list()
             {
                 char *message;
                 asprintf(&message, "Cannot open <span weight=\"bold\">Source Files Name List</span> file: <span weight=\"bold\" foreground=\"blue\">%s</span>", settings.nameFile);
-                #ifndef GTK4_BUILD
-                my_message_dialog(GTK_WINDOW(CALLBACKS_get_widget("gscope_splash")), GTK_MESSAGE_ERROR, message, TRUE);
-                #else
-                my_message_dialog(GTK_WINDOW(CALLBACKS_get_widget("gscope_main")), GTK_MESSAGE_ERROR, message, TRUE);
-                #endif
+                ENGINE_message(ENGINE_ERROR, message, TRUE);
                 free(message);
             }
         }
@@ -993,7 +980,7 @@ static void find_srcfiles_in_tree(gchar *src_dir)
         my_asprintf(&message,"\nG-Scope Error: Recursive File Tree Walk Error: %s", strerror(errno));
 
         if ( !settings.refOnly )  // If we are in GUI mode
-            my_message_dialog(GTK_WINDOW(CALLBACKS_get_widget("gscope_main")), GTK_MESSAGE_ERROR, message, TRUE);
+            ENGINE_message(ENGINE_ERROR, message, TRUE);
         else
             fprintf(stderr, "%s\n", message);
 
@@ -1110,6 +1097,74 @@ static gboolean path_check_ok(const char *file)
 
 
 
+/*
+ * Return the names an #include'd <file> may be listed under in the source file list, in the
+ * order DIR_incfile() tries them:  the (cleaned) name itself [absolute, or relative to the
+ * source directory], then the name under each directory of the include-file search-list.
+ * The caller must free the list with g_strfreev().
+ */
+
+gchar **DIR_incfile_candidates(char *file)
+{
+    GPtrArray   *candidates;
+    char        path[PATHLEN + 1];
+    char        *clean_name;
+    int         i;
+
+    candidates = g_ptr_array_new();
+
+    clean_name = strdup(file);
+    compress_path(clean_name);    // warning: compress_path might modify 'file'
+    g_ptr_array_add(candidates, g_strdup(clean_name));
+
+    if ( *clean_name != '/')      // Relative paths are also looked up in the include-file search-list
+    {
+        for (i = 0; i < num_include_dirs; ++i)
+        {
+            snprintf(path, PATHLEN, "%s/%s", include_dirs[i], clean_name);
+            g_ptr_array_add(candidates, g_strdup(compress_path(path)));
+        }
+    }
+    free(clean_name);
+
+    g_ptr_array_add(candidates, NULL);
+    return( (gchar **) g_ptr_array_free(candidates, FALSE) );
+}
+
+
+
+/*
+ * Return the name a quoted #include of <file> by the source file <includer> has when it is
+ * looked up in the includer's directory [as a compiler does], or NULL if that is no different
+ * from DIR_incfile_candidates()'s first name:  an absolute <file>, or an includer at the top of
+ * the source directory.  The caller must g_free() the name.
+ *
+ * Note: DIR_incfile() does not look in the includer's directory, so the build does not add a
+ * file to the source file list just because it is found this way.
+ */
+
+gchar *DIR_incfile_local(const char *file, const char *includer)
+{
+    char    path[PATHLEN + 1];
+    gchar   *dir;
+
+    if (*file == '/') return(NULL);
+
+    dir = g_path_get_dirname(includer);
+    if ( strcmp(dir, ".") == 0 )
+    {
+        g_free(dir);
+        return(NULL);
+    }
+
+    snprintf(path, PATHLEN, "%s/%s", dir, file);
+    g_free(dir);
+
+    return( g_strdup(compress_path(path)) );
+}
+
+
+
 /* add an include file to the source file list */
 
 void DIR_incfile(char *file)
@@ -1117,15 +1172,20 @@ void DIR_incfile(char *file)
     char    path[PATHLEN + 1];
     int     i;
     char    *src_dir;
+    gchar   **candidates = NULL;
     char    *clean_name;
+    char    *found = NULL;      /* The name that resolved [for the include_done probe] */
+
+    PROFILE_begin(PROFILE_INCLUDE);
 
     clean_name = strdup(file);
     compress_path(clean_name);    // warning: compress_path might modify 'file'
 
-
     if ( infilelist(clean_name) )
     {
+        PROBE2(include_done, file, clean_name);
         free(clean_name);
+        PROFILE_end(PROFILE_INCLUDE);
         return;   // If the file is already in the list, no further action is required.
     }
 
@@ -1134,7 +1194,7 @@ void DIR_incfile(char *file)
     // If 'file' specifies a relative path:
     //      1)  First, check for the relative file name based off of src_dir
     //      2)  otherwise, search for the relative file name based of of each entry
-    //          in the include-file search-list.
+    //          in the include-file search-list [the remaining candidates].
 
     if ( *clean_name == '/')      // Is this an absolute path?
     {
@@ -1142,6 +1202,7 @@ void DIR_incfile(char *file)
         {
             /* We already know that 'file' is not in the list, so just add it */
             DIR_addsrcfile(clean_name);
+            found = clean_name;
         }
     }
     else        // 'file' is a relative path
@@ -1152,29 +1213,31 @@ void DIR_incfile(char *file)
         if ( (is_regular_file(compress_path(path))) && (!infilelist(clean_name)) )
         {
             DIR_addsrcfile(clean_name);   // yes, use 'file', not 'path' -- keep the name "relative"
+            found = clean_name;
         }
         else
         {
             /* Nothing found in source_dir, check the "include" search path */
-            for (i = 0; i < num_include_dirs; ++i)
+            candidates = DIR_incfile_candidates(clean_name);
+            for (i = 1; candidates[i] != NULL; ++i)
             {
-                snprintf(path, PATHLEN, "%s/%s", include_dirs[i], clean_name);
-                if ( is_regular_file(compress_path(path)) )
+                if ( is_regular_file(candidates[i]) )
                 {
-                     if (!infilelist(path))
+                     if (!infilelist(candidates[i]))
                      {
-                         DIR_addsrcfile(path);     // Must use 'path', not 'file'
-                         break;
-                     }
-                     else
-                     {
-                         break;
+                         DIR_addsrcfile(candidates[i]);     // Must use the search-list path, not 'file'
                      }
+                     found = candidates[i];
+                     break;
                 }
             }
         }
     }
+    PROBE2(include_done, file, found);
+    g_strfreev(candidates);
     free(clean_name);
+
+    PROFILE_end(PROFILE_INCLUDE);
 }
 
 /* see if the file is already in the list */
@@ -1348,6 +1411,87 @@ gboolean DIR_file_on_include_search_path(gchar *srcfile)
 
 
 
+/*
+ * Count the source files of each suffix of the suffix list [and the files with no suffix], split
+ * between the user's source tree and the include-file search-path.  Called once per database load,
+ * so the statistics dialog does not have to walk the source file list.
+ *
+ * Note: A file on the include-file search-path is only counted as such if there is an include path
+ * setting [settings.includeDir].  Files with a suffix that is not on the list are not counted.
+ */
+void DIR_count_suffixes()
+{
+    GHashTable          *index;     /* suffix -> position in suffix_counts + 1 */
+    dir_suffix_count_t  count;
+    dir_suffix_count_t  *entry;
+    gboolean            include_path = (settings.includeDir[0] != '\0');
+    gchar               *suffix_ptr;
+    gchar               *end_ptr;
+    gchar               delimiter;
+    gchar               *dot;
+    uint32_t            f;
+    guint               i;
+
+    if (suffix_counts)
+    {
+        for (i = 0; i < suffix_counts->len; i++) g_free(g_array_index(suffix_counts, dir_suffix_count_t, i).suffix);
+        g_array_free(suffix_counts, TRUE);
+    }
+    suffix_counts = g_array_new(FALSE, FALSE, sizeof(dir_suffix_count_t));
+    index = g_hash_table_new(g_str_hash, g_str_equal);
+
+    count.user_files    = 0;
+    count.include_files = 0;
+
+    suffix_ptr = settings.suffixList;
+    if (*suffix_ptr != '\0')
+    {
+        delimiter = *suffix_ptr++;
+        while (*suffix_ptr != '\0')
+        {
+            if ( (end_ptr = strchr(suffix_ptr, delimiter)) == NULL ) end_ptr = suffix_ptr + strlen(suffix_ptr);
+
+            count.suffix = g_strdup_printf(".%.*s", (int) (end_ptr - suffix_ptr), suffix_ptr);
+            g_array_append_val(suffix_counts, count);
+            g_hash_table_insert(index, count.suffix, GUINT_TO_POINTER(suffix_counts->len));   /* A repeated suffix counts in its last entry */
+
+            suffix_ptr = (*end_ptr != '\0') ? end_ptr + 1 : end_ptr;
+        }
+    }
+
+    count.suffix = NULL;
+    g_array_append_val(suffix_counts, count);
+
+    for (f = 0; f < nsrcfiles; f++)
+    {
+        if ( (dot = strrchr(DIR_src_files[f], '.')) != NULL )
+            i = GPOINTER_TO_UINT( g_hash_table_lookup(index, dot) );
+        else
+            i = suffix_counts->len;     /* No suffix */
+
+        if (i == 0) continue;           /* Not on the suffix list */
+        entry = &g_array_index(suffix_counts, dir_suffix_count_t, i - 1);
+
+        if ( include_path && DIR_file_on_include_search_path(DIR_src_files[f]) )
+            entry->include_files++;
+        else
+            entry->user_files++;
+    }
+
+    g_hash_table_destroy(index);
+}
+
+
+
+/* Return the DIR_count_suffixes() counts of the current source file list [and their <count>] */
+const dir_suffix_count_t *DIR_suffix_counts(guint *count)
+{
+    *count = suffix_counts ? suffix_counts->len : 0;
+    return( suffix_counts ? (dir_suffix_count_t *) suffix_counts->data : NULL );
+}
+
+
+
 /*
  *  compress_path(pathname)
  *
@@ -23,6 +23,15 @@ typedef enum
 } dir_list_e;
 
 
+/* The number of source files with a suffix of the suffix list [see DIR_count_suffixes()] */
+typedef struct
+{
+    gchar   *suffix;            /* ".c", ".h", ... [NULL:  the files with no suffix] */
+    guint   user_files;         /* Files of the user's source tree */
+    guint   include_files;      /* Files found on the include-file search-path */
+} dir_suffix_count_t;
+
+
 extern char     **DIR_src_files;    /* source file list*/
 extern int      DIR_max_src_files;  /* maximum number of source files */
 extern uint32_t nsrcfiles;          /* number of source files */
@@ -31,7 +40,11 @@ extern uint32_t nsrcfiles;          /* number of source files */
 void     DIR_addincdir(char *path);
 void     DIR_init(dir_init_e init_type);
 void     DIR_incfile(char *file);
+gchar  **DIR_incfile_candidates(char *file);
+gchar   *DIR_incfile_local(const char *file, const char *includer);
 gboolean DIR_file_on_include_search_path(gchar *srcfile);
+void     DIR_count_suffixes(void);
+const dir_suffix_count_t *DIR_suffix_counts(guint *count);
 char *   DIR_get_path(get_method_e method);
 void     DIR_addsrcfile(char *name);
 void     DIR_create_offset_hash(char *buf_ptr);
@@ -21,27 +21,33 @@
 
 #include "search.h"
 #include "display.h"
+#include "results_model.h"
 #include "dir.h"
 #include "utils.h"
+#include "gui_utils.h"
 #include "app_config.h"
+#include "dict.h"
+#include "engine.h"
+#include "callbacks_pub.h"
 #ifdef GTK4_BUILD
 #endif
 
 // ==== defines ====
-#define MAX_FUNCTION_SIZE       100     /* Max size of function name */
-#define MAX_DISPLAY_SOURCE      511     /* Max number of character to display for source text */
-#define MAX_CRAZY_BIG_SIZE      15000   /* Max nubmer of source text chars before warnings are generated */
-#define MAX_EXCERPT_SIZE        100
+#define MAX_COMPLETIONS         20      /* Max number of query completion candidates */
+#define MIN_COMPLETION_KEY      2       /* Min number of query characters before completions are offered */
+#define COLUMN_SAMPLE_ROWS      1000    /* Max number of result rows measured to size the results columns */
+#define COLUMN_SPACING          8       /* Pixels added to each results column [cell spacing and focus line] */
+#define SORT_ARROW_SIZE         16      /* Pixels left for the sort arrow beside a results column title */
 
 // ==== typedefs ====
 
 enum
 {
-    FILENAME = 0,
-    FUNCTION,
-    LINE,
-    TEXT,
-    COLUMNS
+    FILENAME = RESULTS_FILE,
+    FUNCTION = RESULTS_FUNCTION,
+    LINE     = RESULTS_LINE,
+    TEXT     = RESULTS_TEXT,
+    COLUMNS  = RESULTS_COLUMNS
 };
 
 enum
@@ -50,6 +56,13 @@ enum
     H_COLUMNS
 };
 
+enum
+{
+    COMPLETION_NAME = 0,
+    COMPLETION_INFO,
+    C_COLUMNS
+};
+
 typedef struct
 {
     char command[PATHLEN + 1];
@@ -58,7 +71,7 @@ typedef struct
 // ==== globals ====
 
 GtkWidget *treeview;
-GtkListStore *store;
+ResultsModel *store;
 GtkTreeIter iter;
 
 GtkWidget *h_treeview;
@@ -66,6 +79,7 @@ GtkListStore *h_store;
 
 // Display columns
 GtkTreeViewColumn *display_col[4];
+GtkCellRenderer   *display_renderer[4];
 GtkTreeViewColumn *h_col;
 
 gboolean line_number_info_avail = FALSE;   // Indicates if the most recent query
@@ -74,6 +88,15 @@ gboolean line_number_info_avail = FALSE;   // Indicates if the most recent query
 //  ==== Private Global Variables ====
 static GtkWidget   *gscope_main = NULL;
 
+static gboolean    stream_active = FALSE;  // A streamed query is in progress (or just completed)
+static search_t    stream_button;          // Query type of the streamed query
+static guint       stream_head_rows;       // Number of streamed 'head' rows currently in the results model
+static guint       stream_rows;            // Total number of streamed rows currently in the results model
+static gint        stream_sort_column;     // Column header clicked while rows were streamed in [-1 = none]
+static GtkSortType stream_sort_order;      // ...and the order it asked for
+
+static GtkListStore *c_store;              // Query completion candidates
+
 /*** Local Function Prototypes ***/
 
 static void on_filename_col_clicked(GtkTreeViewColumn *column, gpointer user_data);
@@ -81,8 +104,19 @@ static void on_function_col_clicked(GtkTreeViewColumn *column, gpointer user_dat
 static void on_line_col_clicked(GtkTreeViewColumn *column, gpointer user_data);
 static void on_text_col_clicked(GtkTreeViewColumn *column, gpointer user_data);
 static void configure_columns(gchar new_mask);
-static void update_list_store(search_results_t *results);
+static void configure_results_view(search_t button);
+static void show_results_model(ResultsModel *model);
+static void sort_results(gint column);
+static void show_sort(gint column, GtkSortType order);
+static void size_columns(gboolean grow);
 static gboolean search_equal_func(GtkTreeModel *model, gint column, const gchar *key, GtkTreeIter *iter, gpointer search_data);
+static void on_query_entry_changed(GtkEditable *editable, gpointer user_data);
+static gboolean completion_match_func(GtkEntryCompletion *completion, const gchar *key, GtkTreeIter *iter, gpointer user_data);
+static void engine_progress(gpointer progress, const gchar *msg, guint count, guint max);
+static void engine_status(const gchar *msg);
+static void engine_stats(const gchar *msg);
+static void engine_src_dir(const gchar *path);
+static void engine_message(engine_severity_t severity, const gchar *markup, gboolean modal);
 
 
 void DISPLAY_init(GtkWidget *main)
@@ -91,6 +125,8 @@ void DISPLAY_init(GtkWidget *main)
     GtkCellRenderer *renderer;
     GtkWidget *image1;
     GtkWidget *sms_button;
+    GtkWidget *query_entry;
+    GtkEntryCompletion *completion;
 
     gscope_main = main;     // Save a convenience pointer to the main window
 
@@ -105,41 +141,45 @@ void DISPLAY_init(GtkWidget *main)
 
     // Create a new GtkCellRendererText, add it to the tree view column and append the column to the tree view
 
-    renderer = gtk_cell_renderer_text_new();
+    display_renderer[FILENAME] = renderer = gtk_cell_renderer_text_new();
     display_col[FILENAME] = gtk_tree_view_column_new_with_attributes("File", renderer, "text", FILENAME, NULL);
-    gtk_tree_view_column_set_sizing   (display_col[FILENAME], GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+    gtk_tree_view_column_set_sizing   (display_col[FILENAME], GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_resizable(display_col[FILENAME], TRUE);
     gtk_tree_view_append_column(GTK_TREE_VIEW(treeview), display_col[FILENAME]);
     gtk_tree_view_column_set_clickable(display_col[FILENAME], TRUE);
     g_signal_connect((GtkTreeViewColumn *)display_col[FILENAME], "clicked", G_CALLBACK (on_filename_col_clicked), NULL);
 
-    renderer = gtk_cell_renderer_text_new();
+    display_renderer[FUNCTION] = renderer = gtk_cell_renderer_text_new();
     display_col[FUNCTION] = gtk_tree_view_column_new_with_attributes("Function", renderer, "text", FUNCTION, NULL);
-    gtk_tree_view_column_set_sizing   (display_col[FUNCTION], GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+    gtk_tree_view_column_set_sizing   (display_col[FUNCTION], GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_resizable(display_col[FUNCTION], TRUE);
     gtk_tree_view_append_column(GTK_TREE_VIEW(treeview), display_col[FUNCTION]);
     gtk_tree_view_column_set_clickable(display_col[FUNCTION], TRUE);
     g_signal_connect((GtkTreeViewColumn *)display_col[FUNCTION], "clicked", G_CALLBACK (on_function_col_clicked), NULL);
 
-    renderer = gtk_cell_renderer_text_new();
+    display_renderer[LINE] = renderer = gtk_cell_renderer_text_new();
     display_col[LINE] = gtk_tree_view_column_new_with_attributes("Line", renderer, "text", LINE, NULL);
-    gtk_tree_view_column_set_sizing   (display_col[LINE],     GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+    gtk_tree_view_column_set_sizing   (display_col[LINE], GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_resizable(display_col[LINE], TRUE);
     gtk_tree_view_append_column(GTK_TREE_VIEW(treeview), display_col[LINE]);
     gtk_tree_view_column_set_clickable(display_col[LINE], TRUE);
     g_signal_connect((GtkTreeViewColumn *)display_col[LINE], "clicked", G_CALLBACK (on_line_col_clicked), NULL);
 
-    renderer = gtk_cell_renderer_text_new();
+    display_renderer[TEXT] = renderer = gtk_cell_renderer_text_new();
     display_col[TEXT] = gtk_tree_view_column_new_with_attributes("Source Text", renderer, "text", TEXT, NULL);
-    gtk_tree_view_column_set_sizing   (display_col[TEXT],     GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+    gtk_tree_view_column_set_sizing   (display_col[TEXT], GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_resizable(display_col[TEXT], TRUE);
     gtk_tree_view_append_column(GTK_TREE_VIEW(treeview), display_col[TEXT]);
     gtk_tree_view_column_set_clickable(display_col[TEXT], TRUE);
     g_signal_connect((GtkTreeViewColumn *)display_col[TEXT], "clicked", G_CALLBACK (on_text_col_clicked), NULL);
 
-    /* Create a new tree model with 4 columns [string, string, string, string] */
-    store = gtk_list_store_new(COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+    /* Start with an empty results model [4 string columns, see results_model.h] */
+    show_results_model(RESULTS_model_new(NULL));
+    size_columns(FALSE);
 
-    /* Add the tree model to the tree view and unreference it so that the model will be
-     * destroyed along with the tree view. */
-    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), GTK_TREE_MODEL(store));
-    g_object_unref(store);
+    /* Every row is one line of text:  the view measures the first row only, and only asks the model for
+       the rows it draws.  The columns are sized once per query from a sample of the rows [size_columns]. */
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(treeview), TRUE);
 
     /* Configure a custom function for interactive searches */
     gtk_tree_view_set_search_equal_func (GTK_TREE_VIEW(treeview), search_equal_func, NULL, NULL);
@@ -166,6 +206,37 @@ void DISPLAY_init(GtkWidget *main)
     g_object_unref(h_store);
 
 
+    //============================================================
+    //  Set up QUERY completion
+    //
+    //  The candidates come from the symbol dictionary (DICT_complete)
+    //  and are re-loaded each time the query text changes.
+    //============================================================
+    query_entry = lookup_widget(GTK_WIDGET (gscope_main), "query_entry");
+
+    /* Create a new model with 2 columns [symbol name, kind and reference count] */
+    c_store = gtk_list_store_new(C_COLUMNS, G_TYPE_STRING, G_TYPE_STRING);
+
+    completion = gtk_entry_completion_new();
+    gtk_entry_completion_set_model(completion, GTK_TREE_MODEL(c_store));
+    g_object_unref(c_store);
+    gtk_entry_completion_set_text_column(completion, COMPLETION_NAME);
+    gtk_entry_completion_set_match_func(completion, completion_match_func, NULL, NULL);
+    gtk_entry_completion_set_minimum_key_length(completion, MIN_COMPLETION_KEY);
+
+    renderer = gtk_cell_renderer_text_new();
+    g_object_set(renderer, "foreground", "gray", NULL);
+    gtk_cell_layout_pack_start(GTK_CELL_LAYOUT(completion), renderer, FALSE);
+    gtk_cell_layout_add_attribute(GTK_CELL_LAYOUT(completion), renderer, "text", COMPLETION_INFO);
+
+    /* Connected before the completion is attached, so the candidates are loaded before the completion filters them */
+    g_signal_connect(query_entry, "changed", G_CALLBACK (on_query_entry_changed), NULL);
+    gtk_entry_set_completion(GTK_ENTRY(query_entry), completion);
+    g_object_unref(completion);
+
+    DICT_autostart();   /* Collect the dictionary in the background as soon as each database is loaded */
+
+
     //============================================================
     //  Initialize the static status info
     //============================================================
@@ -205,6 +276,103 @@ void DISPLAY_init(GtkWidget *main)
     #if !defined(GTK3_BUILD) && !defined(GTK4_BUILD)
     DISPLAY_always_show_image(settings.menuIcons);
     #endif
+
+    // ======== Show the cross-reference engine's notifications ========
+    {
+        static const engine_callbacks_t engine_callbacks =
+        {
+            engine_progress,
+            engine_status,
+            DISPLAY_set_cref_current,
+            engine_stats,
+            engine_src_dir,
+            engine_message,
+            NULL                /* The GUI does not cancel cross-reference builds */
+        };
+
+        ENGINE_set_callbacks(&engine_callbacks);
+    }
+}
+
+
+
+// ==== Cross-reference engine notification handlers [see engine.h] ====
+
+static void engine_progress(gpointer progress, const gchar *msg, guint count, guint max)
+{
+    if (progress) DISPLAY_progress(GTK_WIDGET(progress), (char *) msg, count, max);
+}
+
+
+static void engine_status(const gchar *msg)
+{
+    DISPLAY_status((gchar *) msg);
+}
+
+
+static void engine_stats(const gchar *msg)
+{
+    DISPLAY_update_stats_tooltip((gchar *) msg);
+}
+
+
+static void engine_src_dir(const gchar *path)
+{
+    DISPLAY_update_path_label((gchar *) path);
+}
+
+
+static void engine_message(engine_severity_t severity, const gchar *markup, gboolean modal)
+{
+    static const GtkMessageType message_type[] = { GTK_MESSAGE_INFO, GTK_MESSAGE_WARNING, GTK_MESSAGE_ERROR };
+    GtkWidget   *parent = gscope_main;
+
+    #ifndef GTK4_BUILD
+    // Start-up messages [the main window is not shown yet] go over the splash screen
+    if ( !gtk_widget_get_visible(gscope_main) && CALLBACKS_get_widget("gscope_splash") )
+        parent = CALLBACKS_get_widget("gscope_splash");
+    #endif
+
+    my_message_dialog(GTK_WINDOW(parent), message_type[severity], markup, modal);
+}
+
+
+/* Load the completion candidates for the current query text: the best prefix matches, then the best substring matches */
+static void on_query_entry_changed(GtkEditable *editable, gpointer user_data)
+{
+    dict_entry_t    candidates[MAX_COMPLETIONS];
+    const gchar     *text;
+    gchar           *info;
+    guint           count;
+    guint           i;
+    GtkTreeIter     c_iter;
+
+    gtk_list_store_clear(c_store);
+
+    text = my_gtk_entry_get_text(GTK_ENTRY(editable));
+    if ( strlen(text) < MIN_COMPLETION_KEY ) return;
+
+    count = DICT_complete(text, DICT_PREFIX, candidates, MAX_COMPLETIONS);
+    count += DICT_complete(text, DICT_SUBSTRING, candidates + count, MAX_COMPLETIONS - count);
+
+    for (i = 0; i < count; i++)
+    {
+        if (candidates[i].kind)
+            info = g_strdup_printf("%s, %u refs", DICT_kind_name(candidates[i].kind), candidates[i].refs);
+        else
+            info = g_strdup_printf("%u refs", candidates[i].refs);
+
+        gtk_list_store_append(c_store, &c_iter);
+        gtk_list_store_set(c_store, &c_iter, COMPLETION_NAME, candidates[i].name, COMPLETION_INFO, info, -1);
+        g_free(info);
+    }
+}
+
+
+/* Every candidate in the completion model has already been matched by DICT_complete() */
+static gboolean completion_match_func(GtkEntryCompletion *completion, const gchar *key, GtkTreeIter *iter, gpointer user_data)
+{
+    return(TRUE);
 }
 
 
@@ -281,13 +449,28 @@ void DISPLAY_status(gchar *msg)
 /* Display the (query-specific formatted) results of the query */
 void DISPLAY_search_results(search_t button, search_results_t *results)
 {
-    #define FILE_FN_LN_TXT_COL_MASK  0x0f
-    #define FILE_LN_TXT_COL_MASK     0x0d
-    #define FILE_COL_MASK            0x01
+    gint sort_column;
+
+    /* A sort asked for while the rows were streamed in is applied now that they are all here */
+    sort_column = ( stream_active && (stream_button == button) ) ? stream_sort_column : -1;
+    stream_sort_column = -1;
 
-    if (results->match_count < 1) return;   /* This should never happen, but just in case... */
+    /* No match:  nothing was streamed in, and the previous results are still in the list */
+    if (results->match_count < 1)
+    {
+        stream_active = FALSE;
+        if (sort_column >= 0) RESULTS_model_sort(store, sort_column, (stream_sort_order == GTK_SORT_DESCENDING));
+        return;
+    }
 
-    gtk_list_store_clear(store);
+    /* If every result row has already been streamed into the list, there is nothing left to do [but the sort] */
+    if ( stream_active && (stream_button == button) && (stream_rows == results->match_count) )
+    {
+        stream_active = FALSE;
+        if (sort_column >= 0) RESULTS_model_sort(store, sort_column, (stream_sort_order == GTK_SORT_DESCENDING));
+        return;
+    }
+    stream_active = FALSE;
 
     #if 0 // failed attempt to have combination manual resize and auto resize columns
     gtk_tree_view_column_set_resizable(display_col[FILENAME], FALSE);
@@ -300,32 +483,15 @@ void DISPLAY_search_results(search_t button, search_results_t *results)
     gtk_tree_view_column_set_sizing   (display_col[TEXT],     GTK_TREE_VIEW_COLUMN_AUTOSIZE);
     #endif
 
-    switch (button)
-    {
-        case FIND_SYMBOL:
-        case FIND_CALLEDBY:
-        case FIND_CALLING:
-            configure_columns(FILE_FN_LN_TXT_COL_MASK);
-            update_list_store(results);
-            line_number_info_avail = TRUE;
-        break;
-
-        case FIND_DEF:
-        case FIND_STRING:
-        case FIND_REGEXP:
-        case FIND_INCLUDING:
-        case FIND_ALL_FUNCTIONS:
-        case FIND_AUTOGEN_ERRORS:
-            configure_columns(FILE_LN_TXT_COL_MASK);
-            update_list_store(results);
-            line_number_info_avail = TRUE;
-        break;
+    /* A new model replaces the previous query's results:  the view takes all of its rows at once */
+    configure_results_view(button);
+    show_results_model(RESULTS_model_new(results));
+    size_columns(FALSE);
 
-        case FIND_FILE:
-            configure_columns(FILE_COL_MASK);
-            update_list_store(results);
-            line_number_info_avail = FALSE;
-        break;
+    if (sort_column >= 0)
+    {
+        show_sort(sort_column, stream_sort_order);
+        RESULTS_model_sort(store, sort_column, (stream_sort_order == GTK_SORT_DESCENDING));
     }
 
     #if 0  // This sort of works, but the column stays "fixed-width" after user manually resizes (not good)
@@ -346,6 +512,41 @@ void DISPLAY_search_results(search_t button, search_results_t *results)
 
 
 
+/* Prepare for a query whose results will be streamed in with DISPLAY_search_results_append().
+   The previous results stay visible until the first streamed batch arrives. */
+void DISPLAY_search_results_begin(search_t button)
+{
+    stream_active    = TRUE;
+    stream_button    = button;
+    stream_head_rows = 0;
+    stream_rows      = 0;
+    stream_sort_column = -1;
+}
+
+
+
+/* Add a batch of streamed results to the results list */
+void DISPLAY_search_results_append(search_batch_t *batch)
+{
+    if ( !stream_active ) return;
+
+    if (stream_rows == 0)   // First batch: replace the previous query's results
+    {
+        configure_results_view(stream_button);
+        show_results_model(RESULTS_model_new(NULL));
+        if (stream_sort_column >= 0) show_sort(stream_sort_column, stream_sort_order);   // Asked for before this batch
+    }
+
+    RESULTS_model_insert(store, &batch->head, stream_head_rows);
+    RESULTS_model_insert(store, &batch->tail, -1);
+    size_columns(stream_rows > 0);      // Later batches only widen the columns:  they don't jump back and forth
+
+    stream_head_rows += batch->head.match_count;
+    stream_rows      += batch->head.match_count + batch->tail.match_count;
+}
+
+
+
 /* Add the input string to the input history list. */
 void DISPLAY_history_update(const gchar *newEntry)
 {
@@ -711,6 +912,7 @@ void DISPLAY_set_cref_current(gboolean up_to_date)
 static void on_filename_col_clicked(GtkTreeViewColumn *column, gpointer user_data)
 {
     gtk_tree_view_set_search_column( GTK_TREE_VIEW(treeview), FILENAME);
+    sort_results(FILENAME);
 }
 
 
@@ -718,6 +920,7 @@ static void on_filename_col_clicked(GtkTreeViewColumn *column, gpointer user_dat
 static void on_function_col_clicked(GtkTreeViewColumn *column, gpointer user_data)
 {
     gtk_tree_view_set_search_column( GTK_TREE_VIEW(treeview), FUNCTION);
+    sort_results(FUNCTION);
 }
 
 
@@ -725,6 +928,7 @@ static void on_function_col_clicked(GtkTreeViewColumn *column, gpointer user_dat
 static void on_line_col_clicked(GtkTreeViewColumn *column, gpointer user_data)
 {
     gtk_tree_view_set_search_column( GTK_TREE_VIEW(treeview), LINE);
+    sort_results(LINE);
 }
 
 
@@ -732,6 +936,7 @@ static void on_line_col_clicked(GtkTreeViewColumn *column, gpointer user_data)
 static void on_text_col_clicked(GtkTreeViewColumn *column, gpointer user_data)
 {
     gtk_tree_view_set_search_column( GTK_TREE_VIEW(treeview), TEXT);
+    sort_results(TEXT);
 }
 
 
@@ -778,186 +983,143 @@ static void configure_columns(gchar new_mask)
 
 
 
-static void update_list_store(search_results_t *results)
+/* Show the columns [and line number behavior] appropriate for the query type */
+static void configure_results_view(search_t button)
 {
-    gchar  file       [PATHLEN + 1],
-           function   [MAX_FUNCTION_SIZE + 1],
-           linenum    [MAX_LINENUM_SIZE + 1],
-           source_text[MAX_DISPLAY_SOURCE + 1];
+    #define FILE_FN_LN_TXT_COL_MASK  0x0f
+    #define FILE_LN_TXT_COL_MASK     0x0d
+    #define FILE_COL_MASK            0x01
 
-    gchar    field_terminator;
-    uint32_t count;
-    uint32_t over_count;
-    gchar    *work_ptr = results->start_ptr;
-    gchar    *start_ptr;
-    uint32_t lines = results->match_count;
-    int      width;
+    switch (button)
+    {
+        case FIND_SYMBOL:
+        case FIND_CALLEDBY:
+        case FIND_CALLING:
+        case FIND_REACHABLE:
+        case FIND_CALL_PATHS:
+        case FIND_OUTLINE:
+            configure_columns(FILE_FN_LN_TXT_COL_MASK);
+            line_number_info_avail = TRUE;
+        break;
 
+        case FIND_DEF:
+        case FIND_STRING:
+        case FIND_REGEXP:
+        case FIND_INCLUDING:
+        case FIND_INCLUDERS:
+        case FIND_ALL_FUNCTIONS:
+        case FIND_AUTOGEN_ERRORS:
+            configure_columns(FILE_LN_TXT_COL_MASK);
+            line_number_info_avail = TRUE;
+        break;
 
-    while (lines-- > 0)
-    {
-        // Each line of the search results has the following fields [although some fields may have dummy values]:
-        //   File Name
-        //   Function Name
-        //   Line Number
-        //   Source Line Text
-        //
-        // The line format uses '|' and space ' ' characters for field delimiters as follows:
-        //   <file name>|<function name> <line number> <source text>\n
-        //
-        //   Note: <source text can contain any number of space ' ' characters.
-
-
-        /*** extract File Name ***/
-        count = 0;
-        start_ptr = work_ptr;
-        field_terminator = '|';
-        while ( (*work_ptr != field_terminator) && (count < sizeof(file)) )
-        {
-            file[count++] = *work_ptr;
-            work_ptr++;
-        }
+        case FIND_FILE:
+            configure_columns(FILE_COL_MASK);
+            line_number_info_avail = FALSE;
+        break;
 
-        if ( *work_ptr != field_terminator)  // We have an overflow condition
-        {
-            over_count = count;
-            count--;                // Bring the index back to the last char in the array.
-            file[count - 1] = '.';  // Ellipsize the overflow string
-            file[count - 2] = '.';
-            file[count - 3] = '.';
-
-            while (*work_ptr++ != field_terminator) // Skip over the overflow data
-                over_count++;
-            work_ptr--;     // Move pointer back to field terminator
-
-            fprintf(stderr, "Warning: Field width overflow: [File Path Name] will be truncated.\n");
-            fprintf(stderr, "    Max File Path Name length allowed: %d, Actual Path Name length: %d\n", PATHLEN, over_count);
-            width = PATHLEN / 4;
-            if (width > MAX_EXCERPT_SIZE) width = MAX_EXCERPT_SIZE;
-            fprintf(stderr, "    Excerpt [Head]: %.*s\n", width, start_ptr);
-            fprintf(stderr, "    Excerpt [Tail]: %.*s\n\n", width, start_ptr + over_count - width);
-        }
-        file[count] = '\0';         // Null terminate the string
-        work_ptr++;                 // skip the field terminator
+        default:
+        break;
+    }
+}
 
 
-        /*** extract Function Name ***/
-        count = 0;
-        start_ptr = work_ptr;
-        field_terminator = ' ';
-        while ( (*work_ptr != field_terminator) && (count < sizeof(function)) )
-        {
-            function[count++] = *work_ptr;
-            work_ptr++;
-        }
 
-        if ( *work_ptr != field_terminator)  // We have an overflow condition
-        {
-            over_count = count;
-            count--;                    // Bring the index back to the last char in the array.
-            function[count - 1] = '.';  // Ellipsize the overflow string
-            function[count - 2] = '.';
-            function[count - 3] = '.';
-
-            while (*work_ptr++ != field_terminator) // Skip over the overflow data
-                over_count++;
-            work_ptr--;     // Move pointer back to field terminator
-
-            fprintf(stderr, "Warning: Field width overflow: [Function] will be truncated.\n");
-            fprintf(stderr, "    Max File Function length allowed: %d, Actual Function length: %d\n", MAX_FUNCTION_SIZE, over_count);
-            fprintf(stderr, "    File: %s\n", file);
-            width = MAX_FUNCTION_SIZE / 4;
-
-            /* coverity[dead_error_line] this check becomes valid if MAX_FUNCTION_SIZE is changed to a larger value. */
-            if (width > MAX_EXCERPT_SIZE) width = MAX_EXCERPT_SIZE;
-            fprintf(stderr, "    Excerpt [Head]: %.*s\n", width, start_ptr);
-            fprintf(stderr, "    Excerpt [Tail]: %.*s\n\n", width, start_ptr + over_count - width);
-        }
-        function[count] = '\0';     // Null terminate the string
-        work_ptr++;                 // skip the field terminator
+/* Show <model> in the results view.  The view holds the only reference:  the previous model
+   [and its copy of the previous results] is freed. */
+static void show_results_model(ResultsModel *model)
+{
+    int i;
 
+    store = model;
+    gtk_tree_view_set_model(GTK_TREE_VIEW(treeview), GTK_TREE_MODEL(store));
+    g_object_unref(store);
 
-        /*** extract Line Number ***/
-        count = 0;
-        start_ptr = work_ptr;
-        field_terminator = ' ';
-        while ( (*work_ptr != field_terminator) && (count < sizeof(linenum)) )
-        {
-            linenum[count++] = *work_ptr;
-            work_ptr++;
-        }
+    // New results are in search order
+    for (i = 0; i < COLUMNS; i++) gtk_tree_view_column_set_sort_indicator(display_col[i], FALSE);
+}
 
-        if ( *work_ptr != field_terminator)  // We have an overflow condition
-        {
-            over_count = count;
-            count--;                   // Bring the index back to the last char in the array.
-            linenum[count - 1] = 'E';  // Ellipsize the overflow string
-
-            while (*work_ptr++ != field_terminator) // Skip over the overflow data
-                over_count++;
-            work_ptr--;     // Move pointer back to field terminator
-
-            fprintf(stderr, "Warning: Field width overflow: [Line Number] will be truncated.\n");
-            fprintf(stderr, "    Max Line Number length allowed: %d, Actual Line Number length: %d\n", MAX_LINENUM_SIZE, over_count);
-            fprintf(stderr, "    Full Line Number: %.*s\n\n", over_count, start_ptr);
-            fprintf(stderr, "    File: %s\n", file);
-        }
-        linenum[count] = '\0';     // Null terminate the string
-        work_ptr++;                 // skip the field terminator
 
 
+/* Set the width of each results column to fit its title, and the longest field in a sample of the rows
+   [<grow>:  never narrower than it is now].  The columns are fixed width, so this is the only pass the
+   view makes over the results:  in fixed height mode it measures only the first row. */
+static void size_columns(gboolean grow)
+{
+    gint            longest[COLUMNS];
+    GtkTreeIter     row;
+    PangoLayout     *layout;
+    gchar           *text;
+    gint            text_width;
+    gint            title_width;
+    gint            width;
+    gint            xpad;
+    int             i;
+
+    RESULTS_model_longest(store, COLUMN_SAMPLE_ROWS, longest);
+    layout = gtk_widget_create_pango_layout(treeview, NULL);
+
+    for (i = 0; i < COLUMNS; i++)
+    {
+        pango_layout_set_text(layout, gtk_tree_view_column_get_title(display_col[i]), -1);
+        pango_layout_get_pixel_size(layout, &title_width, NULL);
 
-        /*** extract Source Line Text ***/
-        count = 0;
-        start_ptr = work_ptr;
-        field_terminator = '\n';
-        while ( (*work_ptr != field_terminator) && (count < sizeof(source_text)) )
+        text_width = 0;
+        if ( (longest[i] >= 0) && gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(store), &row, NULL, longest[i]) )
         {
-            if ((unsigned char) *work_ptr > 0x7f)
-                *work_ptr = '?';    // Eliminate non-ASCII chars from source text.
-
-            source_text[count++] = *work_ptr;
-            work_ptr++;
+            gtk_tree_model_get(GTK_TREE_MODEL(store), &row, i, &text, -1);
+            pango_layout_set_text(layout, text, -1);
+            pango_layout_get_pixel_size(layout, &text_width, NULL);
+            g_free(text);
         }
 
-        if ( *work_ptr != field_terminator)  // We have an overflow condition
-        {
-            over_count = count;
-            count--;                    // Bring the index back to the last char in the array.
-            source_text[count - 1] = '.';  // Ellipsize the overflow string
-            source_text[count - 2] = '.';
-            source_text[count - 3] = '.';
+        gtk_cell_renderer_get_padding(display_renderer[i], &xpad, NULL);
+        width = MAX(text_width + 2 * xpad, title_width + SORT_ARROW_SIZE) + COLUMN_SPACING;
 
-            while (*work_ptr++ != field_terminator) // Skip over the overflow data
-                over_count++;
-            work_ptr--;     // Move pointer back to field terminator
+        if ( grow ) width = MAX(width, gtk_tree_view_column_get_fixed_width(display_col[i]));
+        gtk_tree_view_column_set_fixed_width(display_col[i], width);
+    }
 
-            if ( strcmp(linenum, "1") == 0)
-            {
-                fprintf(stderr, "*** Warning: File %s is not using Linux newline format\n", file);
-            }
+    g_object_unref(layout);
+}
 
-            if (over_count > MAX_CRAZY_BIG_SIZE)  // We have so many "big" source lines, we need to filter it down to the "worst".
-            {
-                fprintf(stderr, "Warning: Field width overflow: [Source Text] will be truncated.\n");
-                fprintf(stderr, "    Max Source Text length allowed: %d, Actual Source Text length: %d\n", MAX_DISPLAY_SOURCE, over_count);
-                fprintf(stderr, "    File: %s\n    Line: %s\n", file, linenum);
-                width = MAX_DISPLAY_SOURCE / 4;
-                if (width > MAX_EXCERPT_SIZE) width = MAX_EXCERPT_SIZE;
-                fprintf(stderr, "    Excerpt [Head]: %.*s\n", width, start_ptr);
-                fprintf(stderr, "    Excerpt [Tail]: %.*s\n\n", width, start_ptr + over_count - width);
-            }
-        }
-        source_text[count] = '\0';     // Null terminate the string
-        work_ptr++;                 // skip the field terminator
 
 
+/* Sort the results by <column>:  ascending, or descending if they are already sorted ascending by <column> */
+static void sort_results(gint column)
+{
+    GtkSortType order = GTK_SORT_ASCENDING;
 
-        gtk_list_store_append(store, &iter);
-        gtk_list_store_set(store, &iter, FILENAME, file, FUNCTION, function,
-                           LINE, linenum, TEXT, source_text, -1);
+    if ( gtk_tree_view_column_get_sort_indicator(display_col[column]) &&
+         (gtk_tree_view_column_get_sort_order(display_col[column]) == GTK_SORT_ASCENDING) )
+    {
+        order = GTK_SORT_DESCENDING;
     }
-    return;
+
+    show_sort(column, order);
+
+    /* While rows are streamed in, the new 'head' rows are inserted at their search order positions:
+       sorting now would scatter them [and before the first batch, the rows shown are about to be
+       replaced].  The sort is applied when the search is done [DISPLAY_search_results]. */
+    if ( stream_active )
+    {
+        stream_sort_column = column;
+        stream_sort_order  = order;
+        return;
+    }
+
+    RESULTS_model_sort(store, column, (order == GTK_SORT_DESCENDING));
+}
+
+
+
+/* Show the sort indicator on <column> [only] */
+static void show_sort(gint column, GtkSortType order)
+{
+    int i;
+
+    for (i = 0; i < COLUMNS; i++) gtk_tree_view_column_set_sort_indicator(display_col[i], (i == column));
+    gtk_tree_view_column_set_sort_order(display_col[column], order);
 }
 
 
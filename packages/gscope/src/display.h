@@ -8,6 +8,10 @@ void DISPLAY_status(gchar *msg);
 /* Display the results of the query */
 void DISPLAY_search_results(search_t button, search_results_t *results);
 
+/* Stream query results into the results list as they are found */
+void DISPLAY_search_results_begin(search_t button);
+void DISPLAY_search_results_append(search_batch_t *batch);
+
 /* Add the input string to the input history list. */
 void DISPLAY_history_update(const gchar *newEntry);
 void DISPLAY_history_clear(void);
@@ -0,0 +1,151 @@
+/*
+ *  gscope engine interface
+ *
+ *  The cross-reference engine [build, search and the indexes, libgscope_core.a] does not call
+ *  the user interface.  It reports progress, status and messages, and polls for cancellation,
+ *  through the callbacks the front end registers with ENGINE_set_callbacks().
+ *
+ *  Without callbacks [--refOnly, --query, --server, tools linked against the engine] progress
+ *  and status are not reported, messages go to stderr and a build is never cancelled.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "engine.h"
+
+
+//===============================================================
+//       Private Global Variables
+//===============================================================
+
+static engine_callbacks_t   callbacks;
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static void     put_plain_text  (FILE *output, const gchar *markup);
+
+
+
+/* Output <markup> without its Pango markup tags, and with its character entities decoded */
+static void put_plain_text(FILE *output, const gchar *markup)
+{
+    static const struct
+    {
+        const gchar *entity;
+        gchar       c;
+    } entities[] = { {"&lt;", '<'}, {"&gt;", '>'}, {"&amp;", '&'}, {"&quot;", '"'}, {"&apos;", '\''} };
+
+    const gchar *ptr;
+    const gchar *tag_end;
+    guint       i;
+
+    for (ptr = markup; *ptr; ptr++)
+    {
+        if ( (*ptr == '<') && ((tag_end = strchr(ptr, '>')) != NULL) )
+        {
+            ptr = tag_end;
+            continue;
+        }
+
+        if (*ptr == '&')
+        {
+            for (i = 0; i < G_N_ELEMENTS(entities); i++)
+            {
+                if (strncmp(ptr, entities[i].entity, strlen(entities[i].entity)) == 0) break;
+            }
+
+            if (i < G_N_ELEMENTS(entities))
+            {
+                putc(entities[i].c, output);
+                ptr += strlen(entities[i].entity) - 1;
+                continue;
+            }
+        }
+
+        putc(*ptr, output);
+    }
+
+    putc('\n', output);
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Register the front end's handlers [NULL = none] */
+void ENGINE_set_callbacks(const engine_callbacks_t *new_callbacks)
+{
+    if (new_callbacks)
+        callbacks = *new_callbacks;
+    else
+        memset(&callbacks, 0, sizeof(callbacks));
+}
+
+
+
+/* Report the progress of a long operation:  <count> of <max> done [<msg> may be NULL] */
+void ENGINE_progress(gpointer progress, const gchar *msg, guint count, guint max)
+{
+    if (callbacks.progress) callbacks.progress(progress, msg, count, max);
+}
+
+
+
+/* Report the status of the current query [Pango markup] */
+void ENGINE_status(const gchar *msg)
+{
+    if (callbacks.status) callbacks.status(msg);
+}
+
+
+
+/* Report whether the cross-reference is up-to-date with the source files */
+void ENGINE_set_cref_current(gboolean up_to_date)
+{
+    if (callbacks.cref_current) callbacks.cref_current(up_to_date);
+}
+
+
+
+/* Report the statistics of the last cross-reference build */
+void ENGINE_stats(const gchar *msg)
+{
+    if (callbacks.stats) callbacks.stats(msg);
+}
+
+
+
+/* Report the source directory of the session */
+void ENGINE_src_dir(const gchar *path)
+{
+    if (callbacks.src_dir) callbacks.src_dir(path);
+}
+
+
+
+/* Show <markup> [Pango markup] to the user */
+void ENGINE_message(engine_severity_t severity, const gchar *markup, gboolean modal)
+{
+    if (callbacks.message)
+        callbacks.message(severity, markup, modal);
+    else
+        put_plain_text(stderr, markup);
+}
+
+
+
+/* Return TRUE if the user has asked to stop the operation reporting its progress to <progress> */
+gboolean ENGINE_cancelled(gpointer progress)
+{
+    return( callbacks.cancelled ? callbacks.cancelled(progress) : FALSE );
+}
@@ -0,0 +1,43 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+typedef enum
+{
+    ENGINE_INFO,
+    ENGINE_WARNING,
+    ENGINE_ERROR
+} engine_severity_t;
+
+
+/*
+ * The front end's handlers for the notifications of the cross-reference engine.  Any of them
+ * may be NULL.  <progress> is the opaque progress object passed to BUILD_initDatabase() [the
+ * GUI's progress bar].
+ */
+typedef struct
+{
+    void        (*progress)     (gpointer progress, const gchar *msg, guint count, guint max);
+    void        (*status)       (const gchar *msg);
+    void        (*cref_current) (gboolean up_to_date);
+    void        (*stats)        (const gchar *msg);
+    void        (*src_dir)      (const gchar *path);
+    void        (*message)      (engine_severity_t severity, const gchar *markup, gboolean modal);
+    gboolean    (*cancelled)    (gpointer progress);
+} engine_callbacks_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+void        ENGINE_set_callbacks    (const engine_callbacks_t *callbacks);
+
+void        ENGINE_progress         (gpointer progress, const gchar *msg, guint count, guint max);
+void        ENGINE_status           (const gchar *msg);
+void        ENGINE_set_cref_current (gboolean up_to_date);
+void        ENGINE_stats            (const gchar *msg);
+void        ENGINE_src_dir          (const gchar *path);
+void        ENGINE_message          (engine_severity_t severity, const gchar *markup, gboolean modal);
+gboolean    ENGINE_cancelled        (gpointer progress);
@@ -0,0 +1,376 @@
+/*
+ *  gscope #include graph
+ *
+ *  The INCLUDE marks of the cross-reference, collected (in one pass) into a compressed sparse
+ *  row array of the #includes of every source file.  Each #include'd name is resolved to a
+ *  source file the way the cross-reference build resolved it (see DIR_incfile_candidates()),
+ *  except that a quoted #include is first looked up in the including file's directory [as the
+ *  compiler does, see DIR_incfile_local()].  So "who includes foo.h" becomes an array lookup,
+ *  and "which files pull in foo.h" a walk up the graph.
+ *
+ *  The graph only mirrors that resolution:  it knows nothing of the -I options of the real build.
+ *
+ *  #includes of files that are not in the cross-reference [system headers, files outside of
+ *  the include-file search-list] are not part of the graph.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "build.h"
+#include "scanner.h"        /* for mark definitions */
+#include "dir.h"
+#include "incgraph.h"
+#include "scan.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define MAX_SYMBOL_SIZE     1024
+#define NO_ID               G_MAXUINT32
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+/* An #include, before its name is resolved to a file */
+typedef struct
+{
+    guint32             name;       /* Index of the #include'd name in 'names' */
+    gboolean            local;      /* A quoted #include [not <system>] */
+    guint32             header;     /* The file it resolves to [or NO_ID] */
+    incgraph_include_t  include;
+} raw_include_t;
+
+
+struct _incgraph
+{
+    GStringChunk        *strings;       /* File names */
+    GPtrArray           *files;         /* file -> file name */
+
+    incgraph_include_t  *includes;      /* The #includes of each file... */
+    guint               *start;         /* ...file's #includes start at includes[start[file]] (num files + 1 entries) */
+};
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static void     read_name   (char **read_ptr, char *name);
+
+
+
+/* Copy the (digraph-compressed) name at *read_ptr into <name>, advancing *read_ptr to the newline */
+static void read_name(char **read_ptr, char *name)
+{
+    char            *src_ptr = *read_ptr;
+    char            *dest_ptr = name;
+    unsigned char   c;
+
+    while ( ((c = *src_ptr) != '\n') && (dest_ptr - name < MAX_SYMBOL_SIZE - 2) )
+    {
+        if (c & 0x80)
+        {
+            c &= 0x7f;
+            *dest_ptr++ = dichar1[c / 8];
+            *dest_ptr++ = dichar2[c & 7];
+        }
+        else
+        {
+            *dest_ptr++ = c;
+        }
+        src_ptr++;
+    }
+    *dest_ptr = '\0';
+
+    *read_ptr = SCAN_newline(src_ptr);
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Build the #include graph of the memory-resident cross-reference <cref_buf> */
+incgraph_t *INCGRAPH_build(const gchar *cref_buf)
+{
+    incgraph_t      *graph;
+    GHashTable      *file_ids;      /* file name -> file + 1 */
+    GHashTable      *name_ids;      /* #include'd name -> index in 'names' + 1 */
+    GPtrArray       *names;         /* The distinct #include'd names */
+    guint32         *resolved;      /* index in 'names' -> file [or NO_ID] */
+    GArray          *raw;
+    raw_include_t   entry;
+    raw_include_t   *include;
+    gchar           *local;
+    gchar           **candidates;
+    gchar           *copy;
+    char            *read_ptr;
+    char            name[MAX_SYMBOL_SIZE];
+    guint32         file;
+    guint32         header;
+    guint           num_files;
+    guint           *next;
+    guint           i, j;
+    gboolean        done = FALSE;
+
+    graph = g_new0(incgraph_t, 1);
+    graph->strings = g_string_chunk_new(64 * 1024);
+    graph->files   = g_ptr_array_new();
+
+    file_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    name_ids = g_hash_table_new(g_str_hash, g_str_equal);
+    names    = g_ptr_array_new();
+    raw      = g_array_new(FALSE, FALSE, sizeof(raw_include_t));
+
+    read_ptr = (char *) cref_buf;
+    read_ptr = SCAN_past_tab(read_ptr);     /* Skip the header */
+    read_ptr++;                             /* Skip the file marker */
+    read_name(&read_ptr, name);             /* Get the first file name */
+
+    while (!done)
+    {
+        /* Record the file (a file listed twice keeps its first id) */
+        if ( g_hash_table_lookup(file_ids, name) == NULL )
+        {
+            copy = g_string_chunk_insert(graph->strings, name);
+            g_ptr_array_add(graph->files, copy);
+            g_hash_table_insert(file_ids, copy, GUINT_TO_POINTER(graph->files->len));
+        }
+        file = GPOINTER_TO_UINT( g_hash_table_lookup(file_ids, name) ) - 1;
+
+        /* Collect the file's #includes */
+        for (;;)
+        {
+            read_ptr = SCAN_past_tab(read_ptr);
+
+            if (*read_ptr == NEWFILE)
+            {
+                read_ptr++;
+                read_name(&read_ptr, name);
+                done = (*name == '\0');     /* An empty file name marks the end of the symbols */
+                break;
+            }
+
+            if (*read_ptr == INCLUDE)
+            {
+                read_ptr++;
+                entry.local = (*read_ptr++ == '"');     /* global or local #include marker '<' or '"' */
+                read_name(&read_ptr, name);
+
+                entry.name = GPOINTER_TO_UINT( g_hash_table_lookup(name_ids, name) );
+                if (entry.name == 0)
+                {
+                    copy = g_string_chunk_insert(graph->strings, name);
+                    g_ptr_array_add(names, copy);
+                    entry.name = names->len;
+                    g_hash_table_insert(name_ids, copy, GUINT_TO_POINTER(entry.name));
+                }
+                entry.name--;
+                entry.include.file = file;
+                entry.include.site = read_ptr - cref_buf;
+                g_array_append_val(raw, entry);
+            }
+        }
+    }
+
+    /* Resolve each distinct #include'd name to the first candidate in the cross-reference */
+    resolved = g_new(guint32, MAX(names->len, 1));
+    for (i = 0; i < names->len; i++)
+    {
+        candidates = DIR_incfile_candidates(g_ptr_array_index(names, i));
+        resolved[i] = NO_ID;
+        for (j = 0; candidates[j] != NULL; j++)
+        {
+            header = GPOINTER_TO_UINT( g_hash_table_lookup(file_ids, candidates[j]) );
+            if (header != 0)
+            {
+                resolved[i] = header - 1;
+                break;
+            }
+        }
+        g_strfreev(candidates);
+    }
+
+    /* Resolve each #include:  a quoted #include of a file in the includer's own directory is that file */
+    for (i = 0; i < raw->len; i++)
+    {
+        include = &g_array_index(raw, raw_include_t, i);
+        include->header = resolved[include->name];
+        if ( !include->local ) continue;
+
+        local = DIR_incfile_local(g_ptr_array_index(names, include->name),
+                                  g_ptr_array_index(graph->files, include->include.file));
+        if ( local && ((header = GPOINTER_TO_UINT( g_hash_table_lookup(file_ids, local) )) != 0) )
+        {
+            include->header = header - 1;
+        }
+        g_free(local);
+    }
+
+    /* Group the #includes by the included file (a counting sort, so they stay in database order) */
+    num_files = graph->files->len;
+    graph->includes = g_new(incgraph_include_t, MAX(raw->len, 1));
+    graph->start    = g_new0(guint, num_files + 1);
+    next            = g_new(guint, MAX(num_files, 1));
+
+    for (i = 0; i < raw->len; i++)
+    {
+        header = g_array_index(raw, raw_include_t, i).header;
+        if (header != NO_ID) graph->start[header + 1]++;
+    }
+    for (i = 0; i < num_files; i++)
+    {
+        graph->start[i + 1] += graph->start[i];
+        next[i] = graph->start[i];
+    }
+    for (i = 0; i < raw->len; i++)
+    {
+        header = g_array_index(raw, raw_include_t, i).header;
+        if (header != NO_ID) graph->includes[next[header]++] = g_array_index(raw, raw_include_t, i).include;
+    }
+
+    g_free(next);
+    g_free(resolved);
+    g_array_free(raw, TRUE);
+    g_ptr_array_free(names, TRUE);
+    g_hash_table_destroy(name_ids);
+    g_hash_table_destroy(file_ids);
+
+    return(graph);
+}
+
+
+
+void INCGRAPH_free(incgraph_t *graph)
+{
+    if (graph == NULL) return;
+
+    g_free(graph->includes);
+    g_free(graph->start);
+    g_ptr_array_free(graph->files, TRUE);
+    g_string_chunk_free(graph->strings);
+    g_free(graph);
+}
+
+
+
+/*
+ * Return the files named <name>:  the file with exactly that name, or failing that, every
+ * file whose name ends with "/<name>" [e.g. "foo.h" matches "include/foo.h" and "lib/foo.h"].
+ * The result is an array of guint file ids; the caller must free it.
+ */
+GArray *INCGRAPH_match(const incgraph_t *graph, const gchar *name)
+{
+    GArray      *matches;
+    const gchar *file;
+    gsize       name_len = strlen(name);
+    gsize       file_len;
+    guint       i;
+
+    matches = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (i = 0; i < graph->files->len; i++)
+    {
+        if ( strcmp(g_ptr_array_index(graph->files, i), name) == 0 )
+        {
+            g_array_append_val(matches, i);
+            return(matches);
+        }
+    }
+
+    for (i = 0; i < graph->files->len; i++)
+    {
+        file     = g_ptr_array_index(graph->files, i);
+        file_len = strlen(file);
+        if ( (file_len > name_len) && (file[file_len - name_len - 1] == '/') &&
+             (strcmp(file + file_len - name_len, name) == 0) )
+        {
+            g_array_append_val(matches, i);
+        }
+    }
+
+    return(matches);
+}
+
+
+
+const gchar *INCGRAPH_file(const incgraph_t *graph, guint file)
+{
+    return( g_ptr_array_index(graph->files, file) );
+}
+
+
+
+/* Return the number of #includes of <file>, and the #includes themselves */
+guint INCGRAPH_includers(const incgraph_t *graph, guint file, const incgraph_include_t **includes)
+{
+    *includes = &graph->includes[graph->start[file]];
+    return( graph->start[file + 1] - graph->start[file] );
+}
+
+
+
+/*
+ * Return every file that includes one of <files>, directly or through at most <depth> levels
+ * of #include [0 = any number of levels], as the #include through which each one was first
+ * reached (an array of const incgraph_include_t *), direct includers first.  The caller must
+ * free the array.
+ */
+GPtrArray *INCGRAPH_affected(const incgraph_t *graph, GArray *files, guint depth)
+{
+    GPtrArray                   *result;
+    gboolean                    *visited;
+    guint                       *queue;
+    const incgraph_include_t    *includes;
+    guint                       num_includes;
+    guint                       head, tail, end, level;
+    guint                       file, i;
+
+    result    = g_ptr_array_new();
+    visited   = g_new0(gboolean, MAX(graph->files->len, 1));
+    queue     = g_new(guint, MAX(graph->files->len, 1));
+
+    tail = 0;
+    for (i = 0; i < files->len; i++)
+    {
+        file = g_array_index(files, guint, i);
+        if ( !visited[file] )
+        {
+            visited[file] = TRUE;
+            queue[tail++] = file;
+        }
+    }
+
+    /* Breadth-first:  the includers of <files>, then their includers... */
+    for (head = 0, level = 0; (head < tail) && ( (depth == 0) || (level < depth) ); level++)
+    {
+        end = tail;     /* The files first reached at the previous level */
+        for (; head < end; head++)
+        {
+            num_includes = INCGRAPH_includers(graph, queue[head], &includes);
+            for (i = 0; i < num_includes; i++)
+            {
+                if ( !visited[includes[i].file] )
+                {
+                    visited[includes[i].file] = TRUE;
+                    queue[tail++] = includes[i].file;
+                    g_ptr_array_add(result, (gpointer) &includes[i]);
+                }
+            }
+        }
+    }
+
+    g_free(queue);
+    g_free(visited);
+    return(result);
+}
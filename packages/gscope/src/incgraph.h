@@ -0,0 +1,28 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+/* The #include graph of a cross-reference.  Every source file in the cross-reference is
+   identified by a small id (0, 1, 2... in database order). */
+typedef struct _incgraph incgraph_t;
+
+
+/* An #include of a file */
+typedef struct
+{
+    guint32     file;       /* The file containing the #include */
+    gsize       site;       /* Offset of the #include [the end of the included name] in the cross-reference */
+} incgraph_include_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+incgraph_t     *INCGRAPH_build      (const gchar *cref_buf);
+void            INCGRAPH_free       (incgraph_t *graph);
+GArray         *INCGRAPH_match      (const incgraph_t *graph, const gchar *name);
+const gchar    *INCGRAPH_file       (const incgraph_t *graph, guint file);
+guint           INCGRAPH_includers  (const incgraph_t *graph, guint file, const incgraph_include_t **includes);
+GPtrArray      *INCGRAPH_affected   (const incgraph_t *graph, GArray *files, guint depth);
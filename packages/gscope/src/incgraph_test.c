@@ -0,0 +1,189 @@
+/*
+ *  gscope #include graph test  ["make check"]
+ *
+ *  Builds a cross-reference of a small source tree whose header is only found through the
+ *  include-file search-list [-I], then loads that cross-reference again in a new process the
+ *  way --noBuild, --query, --server and gscope_replay do, and checks that "includers:" of the
+ *  header still finds every file that #includes it.
+ *
+ *  Only the engine [libgscope_core.a] is linked:  no GTK, no display.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "settings.h"
+#include "search.h"
+#include "build.h"
+#include "dir.h"
+
+
+//===============================================================
+//       Local Function Prototypes
+//===============================================================
+
+static void     write_file      (const gchar *root, const gchar *name, const gchar *text);
+static gboolean has_line        (search_results_t *results, const gchar *file);
+static void     remove_tree     (const gchar *path);
+
+
+
+//===============================================================
+//       Private Functions
+//===============================================================
+
+static void write_file(const gchar *root, const gchar *name, const gchar *text)
+{
+    gchar   *path = g_build_filename(root, name, NULL);
+    gchar   *dir  = g_path_get_dirname(path);
+
+    if ( (g_mkdir_with_parents(dir, 0755) != 0) || !g_file_set_contents(path, text, -1, NULL) )
+    {
+        fprintf(stderr, "Error: Unable to write %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    g_free(dir);
+    g_free(path);
+}
+
+
+
+/* Is there a result line for <file>? */
+static gboolean has_line(search_results_t *results, const gchar *file)
+{
+    gchar       *line;
+    gsize       length = strlen(file);
+
+    for (line = results->start_ptr; line < results->end_ptr; line = strchr(line, '\n') + 1)
+    {
+        if ( (strncmp(line, file, length) == 0) && (line[length] == '|') ) return(TRUE);
+    }
+
+    return(FALSE);
+}
+
+
+
+static void remove_tree(const gchar *path)
+{
+    GDir        *dir;
+    const gchar *name;
+    gchar       *child;
+
+    if ( (dir = g_dir_open(path, 0, NULL)) != NULL )
+    {
+        while ( (name = g_dir_read_name(dir)) != NULL )
+        {
+            child = g_build_filename(path, name, NULL);
+
+            if ( g_file_test(child, G_FILE_TEST_IS_DIR) && !g_file_test(child, G_FILE_TEST_IS_SYMLINK) )
+                remove_tree(child);
+            else
+                g_unlink(child);
+
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+
+
+//===============================================================
+//       Main
+//===============================================================
+
+int main(int argc, char *argv[])
+{
+    GError              *error = NULL;
+    search_results_t    *results;
+    gchar               *root;
+    gchar               *src_dir;
+    gchar               *header;
+    gchar               *pattern;
+    pid_t               builder;
+    int                 status;
+    int                 failures = 0;
+
+    if ( (root = g_dir_make_tmp("gscope_test_XXXXXX", &error)) == NULL )
+    {
+        fprintf(stderr, "Error: Unable to create a temporary directory: %s\n", error->message);
+        exit(EXIT_FAILURE);
+    }
+
+    /* The header is outside of the source directory:  only the search-list finds it */
+    write_file(root, "inc/foo.h",      "int foo(void);\n");
+    write_file(root, "src/main.c",     "#include \"foo.h\"\nint main(void) { return foo(); }\n");
+    write_file(root, "src/sub/user.c", "#include <foo.h>\nint user(void) { return foo(); }\n");
+    write_file(root, "src/other.c",    "#include <stdio.h>\nint other(void) { return 0; }\n");
+
+    src_dir = g_build_filename(root, "src", NULL);
+    header  = g_build_filename(root, "inc", "foo.h", NULL);
+    if ( chdir(src_dir) != 0 )
+    {
+        fprintf(stderr, "Error: Unable to change directory to %s\n", src_dir);
+        exit(EXIT_FAILURE);
+    }
+
+    /* The engine settings of "gscope -R --refOnly -I :<root>/inc:" in the tree, without a configuration file */
+    settings.refOnly    = TRUE;
+    settings.recurseDir = TRUE;
+    SETTINGS_valid_list("Suffix List",   settings.suffixList,   &settings.suffixDelim);
+    SETTINGS_valid_list("Typeless List", settings.typelessList, &settings.typelessDelim);
+    SETTINGS_valid_list("Ignored List",  settings.ignoredList,  &settings.ignoredDelim);
+    DIR_list_join(settings.ignoredList, MASTER_IGNORED_LIST);
+    snprintf(settings.includeDir, sizeof(settings.includeDir), ":%s/inc:", root);
+    SETTINGS_valid_list("Include Directory List", settings.includeDir, &settings.includeDirDelim);
+
+    /* Build the cross-reference in another process, so this one starts from the file alone */
+    fflush(NULL);
+    if ( (builder = fork()) == 0 )
+    {
+        BUILD_initDatabase(NULL);
+        SEARCH_cleanup();
+        _exit(EXIT_SUCCESS);
+    }
+    if ( (builder < 0) || (waitpid(builder, &status, 0) != builder) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0) )
+    {
+        fprintf(stderr, "Error: The cross-reference build failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    settings.noBuild = TRUE;
+    BUILD_initDatabase(NULL);
+
+    pattern = g_strdup(header);     /* SEARCH_lookup() may modify the pattern in place */
+    results = SEARCH_lookup(FIND_INCLUDERS, pattern);
+    if ( !results || (results->match_count != 2) || !has_line(results, "main.c") || !has_line(results, "sub/user.c") )
+    {
+        fprintf(stderr, "FAIL: includers:%s [existing cross-reference]: expected main.c and sub/user.c, got %u match(es):\n%.*s",
+                header, results ? results->match_count : 0,
+                results ? (int) (results->end_ptr - results->start_ptr) : 0, results ? results->start_ptr : "");
+        failures++;
+    }
+    if (results) SEARCH_free_results(results);
+
+    SEARCH_cleanup();
+
+    if ( chdir(root) == 0 ) remove_tree(root);
+
+    g_free(pattern);
+    g_free(header);
+    g_free(src_dir);
+    g_free(root);
+
+    return( failures ? EXIT_FAILURE : EXIT_SUCCESS );
+}
@@ -3368,6 +3368,11 @@ create_stats_dialog (void)
   GtkWidget *class_definition_count_label;
   GtkWidget *function_calls_count_label;
   GtkWidget *include_file_count_label;
+  GtkWidget *label93;
+  GtkWidget *query_cache_hits_label;
+  GtkWidget *query_cache_info_label;
+  GtkWidget *label94;
+  GtkWidget *query_history_label;
   GtkWidget *label90;
   GtkWidget *label91;
   GtkWidget *dialog_action_area4;
@@ -3523,7 +3528,7 @@ create_stats_dialog (void)
   gtk_misc_set_alignment (GTK_MISC (label92), 0, 0.5);
   gtk_misc_set_padding (GTK_MISC (label92), 2, 0);
 
-  table2 = gtk_table_new (6, 3, FALSE);
+  table2 = gtk_table_new (8, 3, FALSE);
   gtk_widget_set_name (table2, "table2");
   gtk_widget_show (table2);
   gtk_box_pack_start (GTK_BOX (vbox16), table2, TRUE, TRUE, 0);
@@ -3642,6 +3647,55 @@ create_stats_dialog (void)
   gtk_label_set_use_markup (GTK_LABEL (include_file_count_label), TRUE);
   gtk_misc_set_alignment (GTK_MISC (include_file_count_label), 1, 0.5);
 
+  label93 = gtk_label_new ("<span size=\"large\" weight=\"bold\">Query Cache Hits</span>");
+  gtk_widget_set_name (label93, "label93");
+  gtk_widget_show (label93);
+  gtk_table_attach (GTK_TABLE (table2), label93, 0, 1, 6, 7,
+                    (GtkAttachOptions) (GTK_FILL),
+                    (GtkAttachOptions) (0), 0, 0);
+  gtk_label_set_use_markup (GTK_LABEL (label93), TRUE);
+  gtk_misc_set_alignment (GTK_MISC (label93), 0, 0.5);
+  gtk_misc_set_padding (GTK_MISC (label93), 10, 0);
+
+  query_cache_hits_label = gtk_label_new ("<span size=\"large\" color=\"blue\">0</span>");
+  gtk_widget_set_name (query_cache_hits_label, "query_cache_hits_label");
+  gtk_widget_show (query_cache_hits_label);
+  gtk_table_attach (GTK_TABLE (table2), query_cache_hits_label, 1, 2, 6, 7,
+                    (GtkAttachOptions) (GTK_FILL),
+                    (GtkAttachOptions) (0), 0, 0);
+  gtk_label_set_use_markup (GTK_LABEL (query_cache_hits_label), TRUE);
+  gtk_misc_set_alignment (GTK_MISC (query_cache_hits_label), 1, 0.5);
+
+  query_cache_info_label = gtk_label_new ("");
+  gtk_widget_set_name (query_cache_info_label, "query_cache_info_label");
+  gtk_widget_show (query_cache_info_label);
+  gtk_table_attach (GTK_TABLE (table2), query_cache_info_label, 2, 3, 6, 7,
+                    (GtkAttachOptions) (GTK_FILL),
+                    (GtkAttachOptions) (0), 0, 0);
+  gtk_misc_set_alignment (GTK_MISC (query_cache_info_label), 0, 0.5);
+  gtk_misc_set_padding (GTK_MISC (query_cache_info_label), 10, 0);
+
+  label94 = gtk_label_new ("<span size=\"large\" weight=\"bold\">Recent Queries</span>");
+  gtk_widget_set_name (label94, "label94");
+  gtk_widget_show (label94);
+  gtk_table_attach (GTK_TABLE (table2), label94, 0, 1, 7, 8,
+                    (GtkAttachOptions) (GTK_FILL),
+                    (GtkAttachOptions) (GTK_FILL), 0, 0);
+  gtk_label_set_use_markup (GTK_LABEL (label94), TRUE);
+  gtk_misc_set_alignment (GTK_MISC (label94), 0, 0);
+  gtk_misc_set_padding (GTK_MISC (label94), 10, 0);
+
+  query_history_label = gtk_label_new ("");
+  gtk_widget_set_name (query_history_label, "query_history_label");
+  gtk_widget_show (query_history_label);
+  gtk_table_attach (GTK_TABLE (table2), query_history_label, 1, 3, 7, 8,
+                    (GtkAttachOptions) (GTK_FILL),
+                    (GtkAttachOptions) (0), 0, 0);
+  gtk_label_set_use_markup (GTK_LABEL (query_history_label), TRUE);
+  gtk_label_set_selectable (GTK_LABEL (query_history_label), TRUE);
+  gtk_misc_set_alignment (GTK_MISC (query_history_label), 0, 0);
+  gtk_misc_set_padding (GTK_MISC (query_history_label), 10, 0);
+
   label90 = gtk_label_new ("(Enums+Globals+Members+Structures+Typdefs+Unions+Classes+#defines+Functions)");
   gtk_widget_set_name (label90, "label90");
   gtk_widget_show (label90);
@@ -3721,6 +3775,11 @@ create_stats_dialog (void)
   GLADE_HOOKUP_OBJECT (stats_dialog, class_definition_count_label, "class_definition_count_label");
   GLADE_HOOKUP_OBJECT (stats_dialog, function_calls_count_label, "function_calls_count_label");
   GLADE_HOOKUP_OBJECT (stats_dialog, include_file_count_label, "include_file_count_label");
+  GLADE_HOOKUP_OBJECT (stats_dialog, label93, "label93");
+  GLADE_HOOKUP_OBJECT (stats_dialog, query_cache_hits_label, "query_cache_hits_label");
+  GLADE_HOOKUP_OBJECT (stats_dialog, query_cache_info_label, "query_cache_info_label");
+  GLADE_HOOKUP_OBJECT (stats_dialog, label94, "label94");
+  GLADE_HOOKUP_OBJECT (stats_dialog, query_history_label, "query_history_label");
   GLADE_HOOKUP_OBJECT (stats_dialog, label90, "label90");
   GLADE_HOOKUP_OBJECT (stats_dialog, label91, "label91");
   GLADE_HOOKUP_OBJECT_NO_REF (stats_dialog, dialog_action_area4, "dialog_action_area4");
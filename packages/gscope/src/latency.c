@@ -0,0 +1,81 @@
+/*
+ *  gscope latency summaries
+ *
+ *  The percentiles reported by the benchmark and replay tools [gscope_bench, gscope_replay].
+ *  Percentiles are nearest-rank:  p99 of 10 samples is the largest sample.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <string.h>
+
+#include "latency.h"
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static gint     compare_samples (gconstpointer a, gconstpointer b);
+static gdouble  percentile      (GArray *sorted, guint percent);
+
+
+
+static gint compare_samples(gconstpointer a, gconstpointer b)
+{
+    gdouble x = *(const gdouble *) a;
+    gdouble y = *(const gdouble *) b;
+
+    return( (x > y) - (x < y) );
+}
+
+
+
+/* The nearest-rank <percent> percentile of the <sorted> samples */
+static gdouble percentile(GArray *sorted, guint percent)
+{
+    guint   rank = (percent * sorted->len + 99) / 100;
+
+    return( g_array_index(sorted, gdouble, MAX(rank, 1) - 1) );
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Summarize <samples> [gdouble milliseconds, left as they are].  No samples gives all zeroes. */
+void LATENCY_summarize(GArray *samples, latency_t *summary)
+{
+    GArray  *sorted;
+    gdouble sum = 0;
+    guint   n = samples->len;
+    guint   i;
+
+    memset(summary, 0, sizeof(*summary));
+    if (n == 0) return;
+
+    sorted = g_array_sized_new(FALSE, FALSE, sizeof(gdouble), n);
+    g_array_append_vals(sorted, samples->data, n);
+    g_array_sort(sorted, compare_samples);
+
+    for (i = 0; i < n; i++) sum += g_array_index(sorted, gdouble, i);
+
+    summary->count  = n;
+    summary->min    = g_array_index(sorted, gdouble, 0);
+    summary->max    = g_array_index(sorted, gdouble, n - 1);
+    summary->mean   = sum / n;
+    summary->p90    = percentile(sorted, 90);
+    summary->p95    = percentile(sorted, 95);
+    summary->p99    = percentile(sorted, 99);
+
+    if (n % 2)
+        summary->median = g_array_index(sorted, gdouble, n / 2);
+    else
+        summary->median = (g_array_index(sorted, gdouble, n / 2 - 1) + g_array_index(sorted, gdouble, n / 2)) / 2;
+
+    g_array_free(sorted, TRUE);
+}
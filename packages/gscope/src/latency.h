@@ -0,0 +1,24 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+/* The distribution of a set of timings [milliseconds] */
+typedef struct
+{
+    guint       count;
+    gdouble     min;
+    gdouble     median;
+    gdouble     p90;
+    gdouble     p95;
+    gdouble     p99;
+    gdouble     max;
+    gdouble     mean;
+} latency_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+void    LATENCY_summarize   (GArray *samples, latency_t *summary);
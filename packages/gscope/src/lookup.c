@@ -8,11 +8,11 @@
 #endif
 
 #include <sys/types.h>
-#include <gtk/gtk.h>
+#include <glib.h>
 #include <string.h>
 #include "lookup.h"
 #include "utils.h"
-#include "app_config.h"
+#include "settings.h"
 
 
 /*** Private Functions ***/
@@ -16,6 +16,10 @@
 #include "display.h"
 #include "build.h"
 #include "utils.h"
+#include "gui_utils.h"
+#include "query.h"
+#include "server.h"
+#include "profile.h"
 
 
 //  ======= #defines ========
@@ -39,6 +43,14 @@ int main(int argc, char *argv[])
     static gchar *rcFile = NULL;
     static gchar *srcDir = NULL;
     static gchar *geometry = NULL;
+    static gchar **queries = NULL;
+    static gchar *queryFile = NULL;
+    static gchar *queryLog = NULL;
+    static gchar *buildProfile = NULL;
+    static gchar *buildTrace = NULL;
+    static gboolean json = FALSE;
+    static gchar *serverSocket = NULL;
+    GOptionContext  *context;
 
 #define G_OPTION_FLAG_NONE 0
 
@@ -47,6 +59,14 @@ int main(int argc, char *argv[])
             "refOnly", 'b', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &settings.refOnly,
             "Build the cross-reference only.  (No GUI)", NULL
         },
+        {
+            "buildProfile", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &buildProfile,
+            "Write the time of every build phase, source file and directory to FILE [JSON].", "FILE"
+        },
+        {
+            "buildTrace", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &buildTrace,
+            "Write a timeline of the cross-reference build to FILE [Chrome trace-event format].", "FILE"
+        },
         {
             "compressOff", 'c', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &settings.compressDisable,
             "Use only ASCII characters in the cross-reference file (don't compress).", NULL
@@ -71,6 +91,22 @@ int main(int argc, char *argv[])
             "includeDir", 'I', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &includeDir,
             "Use the specified directory search path to find #include files. (:dir1:dir2:dirN:)", "PATH"
         },
+        {
+            "query", 'q', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING_ARRAY, &queries,
+            "Run the query [type:pattern] against the existing cross-reference and print the results.  (No GUI)", "QUERY"
+        },
+        {
+            "queryFile", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &queryFile,
+            "Run the queries listed in FILE, one per line ('-' = stdin).  (No GUI)", "FILE"
+        },
+        {
+            "queryLog", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &queryLog,
+            "Append every query [type:pattern, then its work as a # comment] to FILE, a trace that --queryFile can run again.", "FILE"
+        },
+        {
+            "json", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &json,
+            "Print query results as JSON lines.", NULL
+        },
         {
             "rcFile", 'r', G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &rcFile,
             "Start Gscope using the preferences info from FILE.", "FILE"
@@ -79,6 +115,10 @@ int main(int argc, char *argv[])
             "recurseDir", 'R', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &settings.recurseDir,
             "Recursively search all subdirecties [Default = search below <current-dir>] for source files.", NULL
         },
+        {
+            "server", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &serverSocket,
+            "Answer queries from other programs on the Unix domain socket SOCKET.  (No GUI)", "SOCKET"
+        },
         {
             "srcDir", 'S', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &srcDir,
             "Search the specified directory for source files. When used with -R, set search-root = DIRECTORY.", "DIRECTORY"
@@ -107,7 +147,12 @@ int main(int argc, char *argv[])
     // Depricated since GTK 2.24 (now automatically called by gtk_init()
     //gtk_set_locale();
 
-    if (!gtk_init_with_args(&argc, &argv, "[source files]", options, NULL, &error))
+    /* Parse the options without opening the display:  Headless sessions [--refOnly, --query] don't need one */
+    context = g_option_context_new("[source files]");
+    g_option_context_add_main_entries(context, options, NULL);
+    g_option_context_add_group(context, gtk_get_option_group(FALSE));
+
+    if (!g_option_context_parse(context, &argc, &argv, &error))
     {
         fprintf(stderr, "\nError: %s\n", error->message);
 
@@ -118,6 +163,7 @@ int main(int argc, char *argv[])
 
         exit(EXIT_FAILURE);
     }
+    g_option_context_free(context);
 
     if (option_error) fprintf(stderr, "Warning:  Ignoring depricated option '-u'.\n");
 
@@ -150,6 +196,20 @@ int main(int argc, char *argv[])
     /* save the filename arguments */
     BUILD_init_cli_file_list(argc, argv);
 
+    if ( queryLog && !SEARCH_set_query_log(queryLog) ) exit(EXIT_FAILURE);
+
+    if ( (buildProfile || buildTrace) && !PROFILE_set_output(buildProfile, buildTrace) ) exit(EXIT_FAILURE);
+
+    if (queries || queryFile)
+    {
+        exit( QUERY_main(queries, queryFile, json) );
+    }
+
+    if (serverSocket)
+    {
+        exit( SERVER_main(serverSocket) );
+    }
+
     if (settings.refOnly)
     {
         APP_CONFIG_init(NULL);
@@ -157,6 +217,12 @@ int main(int argc, char *argv[])
     }
     else
     {
+        if (!gtk_init_check(&argc, &argv))
+        {
+            fprintf(stderr, "\nError: Unable to open the display.\n");
+            exit(EXIT_FAILURE);
+        }
+
         g_set_application_name("G-Scope");
 
         /* Support optional/fall-back "local" pixmap files under $HOME/gscope/pixmaps */
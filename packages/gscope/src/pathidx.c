@@ -0,0 +1,359 @@
+/*
+ *  gscope source file path index
+ *
+ *  Answers literal file name queries without a regular expression scan of the source file list:
+ *    - a table of the paths in sorted order (path prefix queries are a binary search)
+ *    - a table of the base names in sorted order (base name queries are a binary search)
+ *    - a trigram index:  for every three-character sequence [case folded], the files whose path
+ *      contains it.  Substring [and ignore-case] queries only examine the files on the shortest
+ *      list of one of the text's trigrams.
+ *
+ *  The index refers to the path strings, it does not copy them:  it must be rebuilt whenever the
+ *  source file list changes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "pathidx.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define TRIGRAM(s)      ( ((guint32) (guchar) g_ascii_tolower((s)[0]) << 16) |   \
+                          ((guint32) (guchar) g_ascii_tolower((s)[1]) << 8)  |   \
+                           (guint32) (guchar) g_ascii_tolower((s)[2]) )
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+/* An entry of the sorted path and base name tables */
+typedef struct
+{
+    const gchar *key;           /* The path, or its base name */
+    guint       file;
+} sorted_t;
+
+
+struct _pathidx
+{
+    char        **paths;
+    guint       num_paths;
+
+    sorted_t    *by_path;       /* Every path, sorted */
+    sorted_t    *by_name;       /* The base names of the paths that have a directory part, sorted */
+    guint       num_names;
+
+    GHashTable  *trigrams;      /* trigram -> trigram number + 1 */
+    guint       *postings;      /* The files containing each trigram (in file order)... */
+    guint       *start;         /* ...trigram number n's files start at postings[start[n]] */
+};
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static gint     compare_keys    (const void *a, const void *b);
+static gint     compare_files   (const void *a, const void *b);
+static void     sorted_range    (const sorted_t *table, guint count, const gchar *text, gboolean prefix,
+                                 GArray *result);
+static gboolean path_matches    (const gchar *path, const gchar *text, gsize text_len, pathidx_match_t match,
+                                 gboolean ignore_case);
+
+
+
+static gint compare_keys(const void *a, const void *b)
+{
+    return( strcmp( ((const sorted_t *) a)->key, ((const sorted_t *) b)->key ) );
+}
+
+
+
+static gint compare_files(const void *a, const void *b)
+{
+    guint file_a = *(const guint *) a;
+    guint file_b = *(const guint *) b;
+
+    return( (file_a > file_b) - (file_a < file_b) );
+}
+
+
+
+/* Append to <result> the files of the sorted <table> whose key equals [or starts with, if <prefix>] <text> */
+static void sorted_range(const sorted_t *table, guint count, const gchar *text, gboolean prefix, GArray *result)
+{
+    gsize   text_len = strlen(text);
+    guint   low  = 0;
+    guint   high = count;
+    guint   mid;
+
+    /* Binary search for the first key >= text.  Every match follows it. */
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (strcmp(table[mid].key, text) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    for (; (low < count) && (strncmp(table[low].key, text, text_len) == 0); low++)
+    {
+        if ( prefix || (table[low].key[text_len] == '\0') )
+            g_array_append_val(result, table[low].file);
+    }
+}
+
+
+
+static gboolean path_matches(const gchar *path, const gchar *text, gsize text_len, pathidx_match_t match,
+                             gboolean ignore_case)
+{
+    gsize       path_len;
+    const gchar *end;
+
+    switch (match)
+    {
+        case PATHIDX_PREFIX:
+            return( ignore_case ? g_ascii_strncasecmp(path, text, text_len) == 0
+                                : strncmp(path, text, text_len) == 0 );
+
+        case PATHIDX_EXACT:
+            return( ignore_case ? g_ascii_strcasecmp(path, text) == 0
+                                : strcmp(path, text) == 0 );
+
+        case PATHIDX_SUFFIX:
+            path_len = strlen(path);
+            if (path_len < text_len) return(FALSE);
+            return( ignore_case ? g_ascii_strcasecmp(path + path_len - text_len, text) == 0
+                                : strcmp(path + path_len - text_len, text) == 0 );
+
+        default:
+            if ( !ignore_case ) return( strstr(path, text) != NULL );
+
+            path_len = strlen(path);
+            if (path_len < text_len) return(FALSE);
+            for (end = path + path_len - text_len; path <= end; path++)
+            {
+                if (g_ascii_strncasecmp(path, text, text_len) == 0) return(TRUE);
+            }
+            return(FALSE);
+    }
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Index the <num_paths> source file names <paths> (which must not change while the index is in use) */
+pathidx_t *PATHIDX_build(char **paths, guint num_paths)
+{
+    pathidx_t   *index;
+    GArray      *counts;        /* Number of files containing each trigram */
+    GArray      *last_file;     /* The last file counted for each trigram (a file is listed once per trigram) */
+    const gchar *path;
+    const gchar *name;
+    guint32     trigram;
+    guint       num_trigrams;
+    guint       *next;
+    guint       file, n, i;
+
+    index = g_new0(pathidx_t, 1);
+    index->paths     = paths;
+    index->num_paths = num_paths;
+    index->by_path   = g_new(sorted_t, MAX(num_paths, 1));
+    index->by_name   = g_new(sorted_t, MAX(num_paths, 1));
+    index->trigrams  = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    counts    = g_array_new(FALSE, TRUE, sizeof(guint));
+    last_file = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (file = 0; file < num_paths; file++)
+    {
+        path = paths[file];
+
+        index->by_path[file].key  = path;
+        index->by_path[file].file = file;
+
+        if ( (name = strrchr(path, '/')) != NULL )
+        {
+            index->by_name[index->num_names].key  = name + 1;
+            index->by_name[index->num_names].file = file;
+            index->num_names++;
+        }
+
+        for (i = 0; path[i] && path[i + 1] && path[i + 2]; i++)
+        {
+            trigram = TRIGRAM(path + i);
+            n = GPOINTER_TO_UINT( g_hash_table_lookup(index->trigrams, GUINT_TO_POINTER(trigram)) );
+            if (n == 0)
+            {
+                g_array_set_size(counts, counts->len + 1);
+                g_array_append_val(last_file, file);
+                n = counts->len;
+                g_hash_table_insert(index->trigrams, GUINT_TO_POINTER(trigram), GUINT_TO_POINTER(n));
+            }
+            else if (g_array_index(last_file, guint, n - 1) == file)
+            {
+                continue;       /* Already counted for this file */
+            }
+            g_array_index(last_file, guint, n - 1) = file;
+            g_array_index(counts, guint, n - 1)++;
+        }
+    }
+
+    qsort(index->by_path, num_paths, sizeof(sorted_t), compare_keys);
+    qsort(index->by_name, index->num_names, sizeof(sorted_t), compare_keys);
+
+    /* Lay out the posting lists (a second pass, so each list is in file order) */
+    num_trigrams = counts->len;
+    index->start = g_new(guint, num_trigrams + 1);
+    next         = g_new(guint, MAX(num_trigrams, 1));
+
+    index->start[0] = 0;
+    for (n = 0; n < num_trigrams; n++)
+    {
+        index->start[n + 1] = index->start[n] + g_array_index(counts, guint, n);
+        next[n] = index->start[n];
+        g_array_index(last_file, guint, n) = G_MAXUINT;
+    }
+    index->postings = g_new(guint, MAX(index->start[num_trigrams], 1));
+
+    for (file = 0; file < num_paths; file++)
+    {
+        path = paths[file];
+        for (i = 0; path[i] && path[i + 1] && path[i + 2]; i++)
+        {
+            n = GPOINTER_TO_UINT( g_hash_table_lookup(index->trigrams, GUINT_TO_POINTER(TRIGRAM(path + i))) ) - 1;
+            if (g_array_index(last_file, guint, n) == file) continue;
+            g_array_index(last_file, guint, n) = file;
+            index->postings[next[n]++] = file;
+        }
+    }
+
+    g_free(next);
+    g_array_free(counts, TRUE);
+    g_array_free(last_file, TRUE);
+
+    return(index);
+}
+
+
+
+void PATHIDX_free(pathidx_t *index)
+{
+    if (index == NULL) return;
+
+    g_free(index->by_path);
+    g_free(index->by_name);
+    g_free(index->postings);
+    g_free(index->start);
+    g_hash_table_destroy(index->trigrams);
+    g_free(index);
+}
+
+
+
+/* Return the number of files in the index */
+guint PATHIDX_size(const pathidx_t *index)
+{
+    return(index->num_paths);
+}
+
+
+
+/*
+ * Return the files whose path may contain <text> (ignoring case):  the files listed for the
+ * least common trigram of <text>.  Returns NULL if <text> is too short to narrow the search
+ * [every file is a candidate].  The result is an array of guint files, in file order; the
+ * caller must free it.
+ */
+GArray *PATHIDX_candidates(const pathidx_t *index, const gchar *text)
+{
+    GArray      *result;
+    gsize       text_len = strlen(text);
+    guint       best = G_MAXUINT;
+    guint       n, i;
+
+    if (text_len < 3) return(NULL);
+
+    result = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (i = 0; i + 2 < text_len; i++)
+    {
+        n = GPOINTER_TO_UINT( g_hash_table_lookup(index->trigrams, GUINT_TO_POINTER(TRIGRAM(text + i))) );
+        if (n == 0) return(result);     /* No path contains this trigram */
+
+        if ( (best == G_MAXUINT) || (index->start[n] - index->start[n - 1] < index->start[best + 1] - index->start[best]) )
+            best = n - 1;
+    }
+
+    g_array_append_vals(result, &index->postings[index->start[best]], index->start[best + 1] - index->start[best]);
+    return(result);
+}
+
+
+
+/*
+ * Return the files whose path matches the literal <text>, in file order.  The result is an array
+ * of guint files; the caller must free it.
+ */
+GArray *PATHIDX_lookup(const pathidx_t *index, const gchar *text, pathidx_match_t match, gboolean ignore_case)
+{
+    GArray      *result;
+    GArray      *candidates;
+    gsize       text_len = strlen(text);
+    guint       file, i, j;
+
+    /* Case-sensitive anchored queries are answered from the sorted tables */
+    if ( !ignore_case && (match == PATHIDX_PREFIX || match == PATHIDX_EXACT) )
+    {
+        result = g_array_new(FALSE, FALSE, sizeof(guint));
+        sorted_range(index->by_path, index->num_paths, text, (match == PATHIDX_PREFIX), result);
+        qsort(result->data, result->len, sizeof(guint), compare_files);
+        return(result);
+    }
+
+    if ( !ignore_case && (match == PATHIDX_SUFFIX) && (text[0] == '/') && !strchr(text + 1, '/') )
+    {
+        /* A base name ["/name$"] */
+        result = g_array_new(FALSE, FALSE, sizeof(guint));
+        sorted_range(index->by_name, index->num_names, text + 1, FALSE, result);
+        qsort(result->data, result->len, sizeof(guint), compare_files);
+        return(result);
+    }
+
+    /* Everything else is checked against the trigram candidates (or every file) */
+    candidates = PATHIDX_candidates(index, text);
+
+    if (candidates)
+    {
+        for (i = j = 0; i < candidates->len; i++)
+        {
+            file = g_array_index(candidates, guint, i);
+            if ( path_matches(index->paths[file], text, text_len, match, ignore_case) )
+                g_array_index(candidates, guint, j++) = file;
+        }
+        g_array_set_size(candidates, j);
+        return(candidates);
+    }
+
+    result = g_array_new(FALSE, FALSE, sizeof(guint));
+    for (file = 0; file < index->num_paths; file++)
+    {
+        if ( path_matches(index->paths[file], text, text_len, match, ignore_case) )
+            g_array_append_val(result, file);
+    }
+
+    return(result);
+}
@@ -0,0 +1,27 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+/* An index of the source file list.  Files are identified by their position in the list. */
+typedef struct _pathidx pathidx_t;
+
+
+typedef enum
+{
+    PATHIDX_SUBSTRING,      /* Paths that contain the text */
+    PATHIDX_PREFIX,         /* Paths that start with the text ["^text"] */
+    PATHIDX_SUFFIX,         /* Paths that end with the text ["text$"] */
+    PATHIDX_EXACT           /* Paths equal to the text ["^text$"] */
+} pathidx_match_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+pathidx_t      *PATHIDX_build       (char **paths, guint num_paths);
+void            PATHIDX_free        (pathidx_t *index);
+guint           PATHIDX_size        (const pathidx_t *index);
+GArray         *PATHIDX_lookup      (const pathidx_t *index, const gchar *text, pathidx_match_t match, gboolean ignore_case);
+GArray         *PATHIDX_candidates  (const pathidx_t *index, const gchar *text);
@@ -0,0 +1,46 @@
+/*
+ *  Static tracepoints [USDT/SDT probes] in the build and search hot paths.
+ *
+ *  With systemtap's <sys/sdt.h> at build time [systemtap-sdt-dev / systemtap-sdt-devel] each probe
+ *  is a single nop instruction plus an ELF note:  nothing runs unless a tracer attaches.  Without
+ *  it the probes compile to nothing [the arguments are not even evaluated].
+ *
+ *  Provider "gscope":
+ *      crossref_start   (char *file)                           crossref() of one source file
+ *      crossref_done    (char *file, int ok)
+ *      copy_start       (char *file)                           copydata() re-use of unchanged data
+ *      copy_done        (char *file, uint32 bytes)
+ *      include_done     (char *name, char *path)               DIR_incfile() [path NULL: not found]
+ *      autogen_start    (char *file)                           AUTOGEN_run() meta-source compile job
+ *      autogen_done     (char *file, int ok)
+ *      search_start     (int operation, char *pattern)         Every SEARCH_lookup() query
+ *      search_done      (int operation, char *pattern, uint32 matches, int cached)
+ *      match_file_start (char *file)                           match_file() source file scan
+ *      match_file_done  (char *file, long bytes, uint32 matches)
+ *
+ *  Examples:
+ *      bpftrace -l 'usdt:./gscope:gscope:*'
+ *      bpftrace -e 'usdt:./gscope:gscope:crossref_start { @t[tid] = nsecs; }
+ *                   usdt:./gscope:gscope:crossref_done  { @us = hist((nsecs - @t[tid]) / 1000); }'
+ *      perf buildid-cache --add ./gscope && perf probe -x ./gscope 'sdt_gscope:*'
+ *      perf record -e 'sdt_gscope:*' -- ./gscope ...
+ */
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define PROBE1(name, a1)                DTRACE_PROBE1(gscope, name, a1)
+#define PROBE2(name, a1, a2)            DTRACE_PROBE2(gscope, name, a1, a2)
+#define PROBE3(name, a1, a2, a3)        DTRACE_PROBE3(gscope, name, a1, a2, a3)
+#define PROBE4(name, a1, a2, a3, a4)    DTRACE_PROBE4(gscope, name, a1, a2, a3, a4)
+
+#else
+
+/* sizeof() keeps probe-only variables "used" without evaluating anything */
+#define PROBE1(name, a1)                do { (void) sizeof(a1); } while (0)
+#define PROBE2(name, a1, a2)            do { (void) sizeof(a1); (void) sizeof(a2); } while (0)
+#define PROBE3(name, a1, a2, a3)        do { (void) sizeof(a1); (void) sizeof(a2); (void) sizeof(a3); } while (0)
+#define PROBE4(name, a1, a2, a3, a4)    do { (void) sizeof(a1); (void) sizeof(a2); (void) sizeof(a3); (void) sizeof(a4); } while (0)
+
+#endif
@@ -0,0 +1,438 @@
+/*
+ *  gscope cross-reference build profile
+ *
+ *  Records where a cross-reference build spends its time:  the total time of every build phase
+ *  [see profile.h], and the parse time and size of every source file.  At the end of the build the
+ *  records are written as
+ *    - a JSON profile [--buildProfile]:  phase totals, then every parsed file and every directory,
+ *      slowest first
+ *    - a Chrome trace-event file [--buildTrace]:  the phases and the files on a timeline, for
+ *      chrome://tracing or https://ui.perfetto.dev
+ *  and, in a --refOnly session, the phase totals and the slowest files and directories are printed.
+ *
+ *  Profiling is off unless an output file is set:  every PROFILE_ call then returns immediately.
+ *  Include resolution and re-used [copied] files are only totalled, they happen too often to trace.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "settings.h"
+#include "profile.h"
+#include "utils.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define PROFILE_TOP_N       10      /* Slowest files and directories printed by a --refOnly build */
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+/* One traced build phase */
+typedef struct
+{
+    profile_phase_t phase;
+    gint64          start;      /* Microseconds since the start of the build */
+    gint64          duration;
+} phase_event_t;
+
+
+/* One parsed source file [or the totals of one directory] */
+typedef struct
+{
+    gchar           *name;
+    gint64          start;      /* Microseconds since the start of the build */
+    gint64          duration;
+    guint64         bytes;
+    guint           files;
+} file_event_t;
+
+
+//===============================================================
+//       Private Global Variables
+//===============================================================
+
+static const gchar *phase_names[NUM_PROFILE_PHASES] =
+{
+    "walk", "autogen", "parse", "include", "copy", "write", "rename", "reload"
+};
+
+static gboolean profiling = FALSE;
+static gchar    *profile_file = NULL;
+static gchar    *trace_file = NULL;
+
+static gint64   build_start;
+static gint64   phase_start[NUM_PROFILE_PHASES];
+static gint64   phase_total[NUM_PROFILE_PHASES];
+static guint    phase_count[NUM_PROFILE_PHASES];
+static gint64   file_start;
+
+static GArray   *phase_events = NULL;   /* phase_event_t, in build order */
+static GArray   *file_events = NULL;    /* file_event_t, in build order */
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static gboolean     open_check          (const gchar *filename);
+static gint         compare_duration    (gconstpointer a, gconstpointer b);
+static GArray       *sort_files         (void);
+static GArray       *sum_directories    (void);
+static void         put_profile         (FILE *output, GArray *files, GArray *dirs, gint64 total);
+static void         put_trace           (FILE *output);
+static void         put_summary         (GArray *files, GArray *dirs, gint64 total);
+
+
+
+/* Verify <filename> can be written [now, rather than after a long build] */
+static gboolean open_check(const gchar *filename)
+{
+    FILE    *output;
+
+    if ( (output = fopen(filename, "w")) == NULL )
+    {
+        fprintf(stderr, "Error: Unable to open build profile output file: %s\n", filename);
+        return(FALSE);
+    }
+    fclose(output);
+    return(TRUE);
+}
+
+
+
+/* Slowest first */
+static gint compare_duration(gconstpointer a, gconstpointer b)
+{
+    const file_event_t *x = a;
+    const file_event_t *y = b;
+
+    if (x->duration != y->duration) return( (x->duration < y->duration) - (x->duration > y->duration) );
+    return( strcmp(x->name, y->name) );
+}
+
+
+
+/* The parsed files, slowest first.  The names are shared with file_events. */
+static GArray *sort_files(void)
+{
+    GArray  *files;
+
+    files = g_array_sized_new(FALSE, FALSE, sizeof(file_event_t), file_events->len);
+    g_array_append_vals(files, file_events->data, file_events->len);
+    g_array_sort(files, compare_duration);
+
+    return(files);
+}
+
+
+
+/* The parse time and size of every directory [of the files directly in it], slowest first */
+static GArray *sum_directories(void)
+{
+    GHashTable      *dir_hash;
+    GArray          *dirs;
+    file_event_t    *file;
+    file_event_t    dir;
+    gchar           *name;
+    gpointer        index;
+    guint           i;
+
+    dirs = g_array_new(FALSE, TRUE, sizeof(file_event_t));
+    dir_hash = g_hash_table_new(g_str_hash, g_str_equal);   /* Directory name -> dirs[] index + 1 */
+
+    for (i = 0; i < file_events->len; i++)
+    {
+        file = &g_array_index(file_events, file_event_t, i);
+        name = g_path_get_dirname(file->name);
+
+        if ( (index = g_hash_table_lookup(dir_hash, name)) == NULL )
+        {
+            memset(&dir, 0, sizeof(dir));
+            dir.name = name;
+            g_array_append_val(dirs, dir);
+            index = GUINT_TO_POINTER(dirs->len);
+            g_hash_table_insert(dir_hash, name, index);
+        }
+        else
+            g_free(name);
+
+        g_array_index(dirs, file_event_t, GPOINTER_TO_UINT(index) - 1).duration += file->duration;
+        g_array_index(dirs, file_event_t, GPOINTER_TO_UINT(index) - 1).bytes    += file->bytes;
+        g_array_index(dirs, file_event_t, GPOINTER_TO_UINT(index) - 1).files++;
+    }
+
+    g_hash_table_destroy(dir_hash);
+    g_array_sort(dirs, compare_duration);
+
+    return(dirs);
+}
+
+
+
+static void put_profile(FILE *output, GArray *files, GArray *dirs, gint64 total)
+{
+    file_event_t    *file;
+    guint64         bytes = 0;
+    guint           i;
+
+    for (i = 0; i < files->len; i++) bytes += g_array_index(files, file_event_t, i).bytes;
+
+    fprintf(output, "{\n\"cref\": ");
+    my_put_json_string(output, settings.refFile, NULL);
+    fprintf(output, ",\n\"total_ms\": %.3f,\n\"files_parsed\": %u,\n\"bytes_parsed\": %" G_GUINT64_FORMAT ",\n\"phases\": [",
+            total / 1000.0, files->len, bytes);
+
+    for (i = 0; i < NUM_PROFILE_PHASES; i++)
+    {
+        fprintf(output, "%s\n  {\"phase\": \"%s\", \"ms\": %.3f, \"count\": %u}",
+                i ? "," : "", phase_names[i], phase_total[i] / 1000.0, phase_count[i]);
+    }
+
+    fprintf(output, "\n],\n\"files\": [");
+    for (i = 0; i < files->len; i++)
+    {
+        file = &g_array_index(files, file_event_t, i);
+        fprintf(output, "%s\n  {\"file\": ", i ? "," : "");
+        my_put_json_string(output, file->name, NULL);
+        fprintf(output, ", \"ms\": %.3f, \"bytes\": %" G_GUINT64_FORMAT "}", file->duration / 1000.0, file->bytes);
+    }
+
+    fprintf(output, "\n],\n\"dirs\": [");
+    for (i = 0; i < dirs->len; i++)
+    {
+        file = &g_array_index(dirs, file_event_t, i);
+        fprintf(output, "%s\n  {\"dir\": ", i ? "," : "");
+        my_put_json_string(output, file->name, NULL);
+        fprintf(output, ", \"ms\": %.3f, \"bytes\": %" G_GUINT64_FORMAT ", \"files\": %u}",
+                file->duration / 1000.0, file->bytes, file->files);
+    }
+
+    fprintf(output, "\n]\n}\n");
+}
+
+
+
+/* Chrome trace-event format:  "complete" events [ph X], timestamps and durations in microseconds */
+static void put_trace(FILE *output)
+{
+    phase_event_t   *phase;
+    file_event_t    *file;
+    guint           i;
+
+    fprintf(output, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    for (i = 0; i < phase_events->len; i++)
+    {
+        phase = &g_array_index(phase_events, phase_event_t, i);
+        fprintf(output, "%s\n{\"name\": \"%s\", \"cat\": \"phase\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                        "\"ts\": %" G_GINT64_FORMAT ", \"dur\": %" G_GINT64_FORMAT,
+                i ? "," : "", phase_names[phase->phase], phase->start, phase->duration);
+
+        if (phase->phase == PROFILE_PARSE)
+        {
+            fprintf(output, ", \"args\": {\"include_ms\": %.3f, \"copy_ms\": %.3f}",
+                    phase_total[PROFILE_INCLUDE] / 1000.0, phase_total[PROFILE_COPY] / 1000.0);
+        }
+        fputc('}', output);
+    }
+
+    for (i = 0; i < file_events->len; i++)
+    {
+        file = &g_array_index(file_events, file_event_t, i);
+        fprintf(output, "%s\n{\"name\": ", (i || phase_events->len) ? "," : "");
+        my_put_json_string(output, file->name, NULL);
+        fprintf(output, ", \"cat\": \"file\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %" G_GINT64_FORMAT
+                        ", \"dur\": %" G_GINT64_FORMAT ", \"args\": {\"bytes\": %" G_GUINT64_FORMAT "}}",
+                file->start, file->duration, file->bytes);
+    }
+
+    fprintf(output, "\n]}\n");
+}
+
+
+
+static void put_summary(GArray *files, GArray *dirs, gint64 total)
+{
+    file_event_t    *file;
+    guint           i;
+
+    printf("\nBuild profile [total %.3f ms]:\n", total / 1000.0);
+    for (i = 0; i < NUM_PROFILE_PHASES; i++)
+    {
+        if (phase_count[i] == 0) continue;
+        printf("    %-10s %12.3f ms  %8u\n", phase_names[i], phase_total[i] / 1000.0, phase_count[i]);
+    }
+
+    if (files->len) printf("\nSlowest files:\n");
+    for (i = 0; i < MIN(files->len, PROFILE_TOP_N); i++)
+    {
+        file = &g_array_index(files, file_event_t, i);
+        printf("    %12.3f ms  %10" G_GUINT64_FORMAT " bytes  %s\n", file->duration / 1000.0, file->bytes, file->name);
+    }
+
+    if (dirs->len) printf("\nSlowest directories:\n");
+    for (i = 0; i < MIN(dirs->len, PROFILE_TOP_N); i++)
+    {
+        file = &g_array_index(dirs, file_event_t, i);
+        printf("    %12.3f ms  %10" G_GUINT64_FORMAT " bytes  %6u files  %s\n",
+               file->duration / 1000.0, file->bytes, file->files, file->name);
+    }
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Profile every following build:  the JSON profile goes to <profile>, the trace-event file to
+   <trace> [either may be NULL].  FALSE if an output file can't be written. */
+gboolean PROFILE_set_output(const gchar *profile, const gchar *trace)
+{
+    if ( (profile && !open_check(profile)) || (trace && !open_check(trace)) ) return(FALSE);
+
+    g_free(profile_file);
+    g_free(trace_file);
+    profile_file = g_strdup(profile);
+    trace_file = g_strdup(trace);
+    profiling = (profile || trace);
+
+    if ( profiling && !file_events )
+    {
+        file_events = g_array_new(FALSE, FALSE, sizeof(file_event_t));
+        phase_events = g_array_new(FALSE, FALSE, sizeof(phase_event_t));
+    }
+
+    return(TRUE);
+}
+
+
+
+/* A build starts:  drop the records of the previous build */
+void PROFILE_start(void)
+{
+    guint   i;
+
+    if ( !profiling ) return;
+
+    for (i = 0; i < file_events->len; i++) g_free(g_array_index(file_events, file_event_t, i).name);
+    g_array_set_size(file_events, 0);
+    g_array_set_size(phase_events, 0);
+
+    memset(phase_total, 0, sizeof(phase_total));
+    memset(phase_count, 0, sizeof(phase_count));
+    build_start = g_get_monotonic_time();
+}
+
+
+
+/* The build is complete:  write [and print] its profile */
+void PROFILE_finish(void)
+{
+    FILE    *output;
+    GArray  *files;
+    GArray  *dirs;
+    gint64  total;
+    guint   i;
+
+    if ( !profiling ) return;
+
+    total = g_get_monotonic_time() - build_start;
+    files = sort_files();
+    dirs = sum_directories();
+
+    if (profile_file)
+    {
+        if ( (output = fopen(profile_file, "w")) == NULL )
+            fprintf(stderr, "Error: Unable to write build profile: %s\n", profile_file);
+        else
+        {
+            put_profile(output, files, dirs, total);
+            fclose(output);
+        }
+    }
+
+    if (trace_file)
+    {
+        if ( (output = fopen(trace_file, "w")) == NULL )
+            fprintf(stderr, "Error: Unable to write build trace: %s\n", trace_file);
+        else
+        {
+            put_trace(output);
+            fclose(output);
+        }
+    }
+
+    if (settings.refOnly) put_summary(files, dirs, total);
+
+    for (i = 0; i < dirs->len; i++) g_free(g_array_index(dirs, file_event_t, i).name);
+    g_array_free(dirs, TRUE);
+    g_array_free(files, TRUE);
+}
+
+
+
+void PROFILE_begin(profile_phase_t phase)
+{
+    if ( !profiling ) return;
+
+    phase_start[phase] = g_get_monotonic_time();
+}
+
+
+
+void PROFILE_end(profile_phase_t phase)
+{
+    phase_event_t   event;
+
+    if ( !profiling ) return;
+
+    event.phase    = phase;
+    event.start    = phase_start[phase] - build_start;
+    event.duration = g_get_monotonic_time() - phase_start[phase];
+
+    phase_total[phase] += event.duration;
+    phase_count[phase]++;
+
+    if ( (phase != PROFILE_INCLUDE) && (phase != PROFILE_COPY) ) g_array_append_val(phase_events, event);
+}
+
+
+
+/* A source file is about to be parsed */
+void PROFILE_file_begin(void)
+{
+    if ( !profiling ) return;
+
+    file_start = g_get_monotonic_time();
+}
+
+
+
+/* <file> has been parsed [run from the same directory as the parse, so the name resolves] */
+void PROFILE_file_end(const gchar *file)
+{
+    file_event_t    event;
+    struct stat     statstruct;
+
+    if ( !profiling ) return;
+
+    event.duration = g_get_monotonic_time() - file_start;
+    event.start    = file_start - build_start;
+    event.name     = g_strdup(file);
+    event.bytes    = (stat(file, &statstruct) == 0) ? (guint64) statstruct.st_size : 0;
+    event.files    = 1;
+
+    g_array_append_val(file_events, event);
+}
@@ -0,0 +1,30 @@
+//===============================================================
+// typedefs
+//===============================================================
+
+/* The phases of a cross-reference build */
+typedef enum
+{
+    PROFILE_WALK,           /* Find the source files [or read the list from the old cross-reference] */
+    PROFILE_AUTOGEN,        /* Update the auto-generated headers */
+    PROFILE_PARSE,          /* Cross-reference the source files [includes the two phases below] */
+    PROFILE_INCLUDE,        /*   Resolve #include'd file names against the include search path */
+    PROFILE_COPY,           /*   Re-use the old cross-reference data of unchanged files */
+    PROFILE_WRITE,          /* Flush and close the new cross-reference */
+    PROFILE_RENAME,         /* Replace the old cross-reference with the new one */
+    PROFILE_RELOAD,         /* Load the new cross-reference for searching */
+    NUM_PROFILE_PHASES      /* Keep this item last */
+} profile_phase_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+gboolean    PROFILE_set_output  (const gchar *profile, const gchar *trace);
+void        PROFILE_start       (void);
+void        PROFILE_finish      (void);
+void        PROFILE_begin       (profile_phase_t phase);
+void        PROFILE_end         (profile_phase_t phase);
+void        PROFILE_file_begin  (void);
+void        PROFILE_file_end    (const gchar *file);
@@ -0,0 +1,283 @@
+/*
+ *  gscope headless queries
+ *
+ *  Runs queries of the form "<type>:<pattern>" [e.g. "def:main", "callers:malloc"] against the
+ *  cross-reference, without a GUI, and prints one line per match:
+ *    - text:  "<file> <function> <line> <source text>" [the "cscope -L" line format]
+ *    - JSON:  {"query":...,"file":...,"function":...,"line":...,"text":...}, followed by a
+ *             {"query":...,"matches":N} summary line for each query.
+ *
+ *  Only the results go to stdout.  Everything else [cross-reference build messages, errors]
+ *  goes to stderr.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "app_config.h"
+#include "search.h"
+#include "build.h"
+#include "query.h"
+#include "utils.h"
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static gboolean split_result    (const gchar *line_ptr, const gchar *end, const gchar **function,
+                                 const gchar **linenum, const gchar **text);
+static void     put_json_result (FILE *output, const gchar *line_ptr, const gchar *function, const gchar *linenum,
+                                 const gchar *text, const gchar *end);
+static void     put_results     (FILE *output, const gchar *query, search_results_t *results, gboolean json);
+static gboolean run_query_file  (gchar *query_file, gboolean json);
+
+
+
+/*
+ * Find the fields of the search results line from <line_ptr> up to <end> [its newline]:
+ *   <file name>|<function name> <line number> <source text>
+ */
+static gboolean split_result(const gchar *line_ptr, const gchar *end, const gchar **function,
+                             const gchar **linenum, const gchar **text)
+{
+    *function = memchr(line_ptr, '|', end - line_ptr);
+    *linenum  = *function ? memchr(*function, ' ', end - *function) : NULL;
+    *text     = *linenum ? memchr(*linenum + 1, ' ', end - *linenum - 1) : NULL;
+
+    if (*text == NULL)
+    {
+        fprintf(stderr, "Warning: Unexpected search results format: %.*s\n", (int) (end - line_ptr), line_ptr);
+        return(FALSE);
+    }
+
+    (*function)++;
+    (*linenum)++;
+    (*text)++;
+    return(TRUE);
+}
+
+
+
+/* Output the "file", "function", "line" and "text" members of a JSON result object */
+static void put_json_result(FILE *output, const gchar *line_ptr, const gchar *function, const gchar *linenum,
+                            const gchar *text, const gchar *end)
+{
+    fputs("\"file\":", output);
+    my_put_json_string(output, line_ptr, function - 1);
+    fputs(",\"function\":", output);
+    my_put_json_string(output, function, linenum - 1);
+    fprintf(output, ",\"line\":%ld,\"text\":", strtol(linenum, NULL, 10));
+    my_put_json_string(output, text, end);
+}
+
+
+
+/* Output the results of <query>, one line per match */
+static void put_results(FILE *output, const gchar *query, search_results_t *results, gboolean json)
+{
+    const gchar *line_ptr;
+    const gchar *function;
+    const gchar *linenum;
+    const gchar *text;
+    const gchar *end;
+
+    for (line_ptr = results->start_ptr; line_ptr < results->end_ptr; line_ptr = end + 1)
+    {
+        end = memchr(line_ptr, '\n', results->end_ptr - line_ptr);
+        if (end == NULL) end = results->end_ptr;
+
+        if ( !split_result(line_ptr, end, &function, &linenum, &text) ) continue;
+
+        if (json)
+        {
+            fputs("{\"query\":", output);
+            my_put_json_string(output, query, NULL);
+            putc(',', output);
+            put_json_result(output, line_ptr, function, linenum, text, end);
+            fputs("}\n", output);
+        }
+        else
+        {
+            fprintf(output, "%.*s %.*s %.*s\n",
+                    (int) (function - 1 - line_ptr), line_ptr,
+                    (int) (linenum - 1 - function), function,
+                    (int) (end - linenum), linenum);
+        }
+    }
+}
+
+
+
+/* Run the queries in <query_file> [one per line, '-' = stdin] as they are read */
+static gboolean run_query_file(gchar *query_file, gboolean json)
+{
+    FILE        *input;
+    char        *line = NULL;
+    size_t      line_size = 0;
+    gboolean    ok = TRUE;
+
+    if (strcmp(query_file, "-") == 0)
+        input = stdin;
+    else if ( (input = fopen(query_file, "r")) == NULL )
+    {
+        fprintf(stderr, "Error: Unable to open query file: %s\n", query_file);
+        return(FALSE);
+    }
+
+    while (getline(&line, &line_size, input) != -1)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        /* Skip blank lines and comments */
+        if ( (line[0] == '\0') || (line[0] == '#') ) continue;
+
+        if ( !QUERY_run(line, json, stdout) ) ok = FALSE;
+    }
+
+    free(line);
+    if (input != stdin) fclose(input);
+
+    return(ok);
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Split "<type>:<pattern>" [or just "<type>"] into the search operation and a copy of the pattern */
+gboolean QUERY_parse(const gchar *query, search_t *operation, gchar **pattern)
+{
+    const gchar *colon;
+
+    colon = strchr(query, ':');
+
+    if ( !SEARCH_type_from_name(query, colon ? (gsize) (colon - query) : strlen(query), operation) )
+        return(FALSE);
+
+    *pattern = g_strdup(colon ? colon + 1 : "");
+    return(TRUE);
+}
+
+
+
+/* Output <results> as a JSON array of {"file":...,"function":...,"line":...,"text":...} objects */
+void QUERY_put_json_results(FILE *output, search_results_t *results)
+{
+    const gchar *line_ptr;
+    const gchar *function;
+    const gchar *linenum;
+    const gchar *text;
+    const gchar *end;
+    gboolean    first = TRUE;
+
+    putc('[', output);
+
+    for (line_ptr = results->start_ptr; line_ptr < results->end_ptr; line_ptr = end + 1)
+    {
+        end = memchr(line_ptr, '\n', results->end_ptr - line_ptr);
+        if (end == NULL) end = results->end_ptr;
+
+        if ( !split_result(line_ptr, end, &function, &linenum, &text) ) continue;
+
+        fputs(first ? "{" : ",{", output);
+        put_json_result(output, line_ptr, function, linenum, text, end);
+        putc('}', output);
+        first = FALSE;
+    }
+
+    putc(']', output);
+}
+
+
+
+/*
+ * Run <query> and print its results to <output>.  Returns FALSE if the query is not valid.
+ */
+gboolean QUERY_run(const gchar *query, gboolean json, FILE *output)
+{
+    search_t            operation;
+    gchar               *pattern;
+    search_results_t    *results;
+    guint               matches = 0;
+
+    if ( !QUERY_parse(query, &operation, &pattern) )
+    {
+        fprintf(stderr, "Error: Unknown query type: %s\n", query);
+        if (json)
+        {
+            fputs("{\"query\":", output);
+            my_put_json_string(output, query, NULL);
+            fputs(",\"error\":\"Unknown query type\"}\n", output);
+            fflush(output);
+        }
+        return(FALSE);
+    }
+
+    results = SEARCH_lookup(operation, pattern);
+    if (results)
+    {
+        put_results(output, query, results, json);
+        matches = results->match_count;
+        SEARCH_free_results(results);
+    }
+
+    if (json)
+    {
+        fputs("{\"query\":", output);
+        my_put_json_string(output, query, NULL);
+        fprintf(output, ",\"matches\":%u}\n", matches);
+    }
+
+    fflush(output);     /* Each query's results are complete when they are seen */
+    g_free(pattern);
+
+    return(TRUE);
+}
+
+
+
+/*
+ * Headless session:  load the cross-reference [building it first only if --refOnly was given,
+ * otherwise the existing cross-reference is used as-is] and run the <queries>, then the queries
+ * in <query_file>.  Returns the exit status:  EXIT_FAILURE if any query was not valid.
+ */
+int QUERY_main(gchar **queries, gchar *query_file, gboolean json)
+{
+    int         saved_stdout;
+    gboolean    ok = TRUE;
+
+    if ( !settings.refOnly ) settings.noBuild = TRUE;
+    settings.refOnly = TRUE;    /* No GUI */
+
+    /* Keep stdout for the results: the start-up messages go to stderr */
+    fflush(stdout);
+    saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    APP_CONFIG_init(NULL);
+    BUILD_initDatabase(NULL);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    for (; queries && *queries; queries++)
+    {
+        if ( !QUERY_run(*queries, json, stdout) ) ok = FALSE;
+    }
+
+    if ( query_file && !run_query_file(query_file, json) ) ok = FALSE;
+
+    SEARCH_cleanup();
+
+    return(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
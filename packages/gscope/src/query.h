@@ -0,0 +1,9 @@
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+int             QUERY_main              (gchar **queries, gchar *query_file, gboolean json);
+gboolean        QUERY_run               (const gchar *query, gboolean json, FILE *output);
+gboolean        QUERY_parse             (const gchar *query, search_t *operation, gchar **pattern);
+void            QUERY_put_json_results  (FILE *output, search_results_t *results);
@@ -0,0 +1,296 @@
+/*
+ *  gscope query trace replay
+ *
+ *  Runs the queries of one or more traces [the "<type>:<pattern>" lines written by --queryLog,
+ *  or any --queryFile] against an existing cross-reference, and reports per query type:
+ *  latency percentiles [p50, p95, p99], and the work done [cross-reference bytes read, source
+ *  bytes read, source files opened].
+ *
+ *    --cache=cold:  the query results cache is flushed before every query.  The indexes built on
+ *                   first use [call graph, #include graph, ...] are kept, as in a long session.
+ *    --cache=warm:  the traces are replayed once, untimed, before the timed passes.
+ *
+ *  Run it where the cross-reference was built [or --dir], so the source file names resolve.
+ *  Only the engine [libgscope_core.a] is linked:  no GTK, no display.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "settings.h"
+#include "search.h"
+#include "build.h"
+#include "latency.h"
+#include "utils.h"
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+typedef struct
+{
+    search_t    operation;
+    gchar       *pattern;
+} replay_query_t;
+
+
+/* The totals of one query type [or of all of them] */
+typedef struct
+{
+    GArray      *samples;       /* gdouble milliseconds, one per query */
+    guint       cached;
+    guint64     cref_bytes;
+    guint64     source_bytes;
+    guint64     files_opened;
+} replay_totals_t;
+
+
+//===============================================================
+//       Private Global Variables
+//===============================================================
+
+static gchar    *refFile = NULL;
+static gchar    *dir = NULL;
+static gchar    *cache = NULL;
+static gint     passes = 1;
+static gboolean json = FALSE;
+
+static GOptionEntry option_entries[] =
+{
+    { "refFile",    'f', 0, G_OPTION_ARG_FILENAME, &refFile, "The cross-reference file [cscope_db.out]", "FILE" },
+    { "dir",        0,   0, G_OPTION_ARG_FILENAME, &dir,     "Run in DIR [where the cross-reference was built]", "DIR" },
+    { "cache",      0,   0, G_OPTION_ARG_STRING,   &cache,   "cold: flush the query results cache before every query [default], "
+                                                             "warm: replay the traces once before timing them", "cold|warm" },
+    { "passes",     0,   0, G_OPTION_ARG_INT,      &passes,  "Timed passes over the traces [1]", "N" },
+    { "json",       0,   0, G_OPTION_ARG_NONE,     &json,    "Report as JSON", NULL },
+    { NULL }
+};
+
+static replay_totals_t  totals[NUM_FIND_TYPES + 1];     /* By query type, [NUM_FIND_TYPES] = all */
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static void     read_trace      (const gchar *trace_file, GArray *queries);
+static void     run_queries     (GArray *queries, gboolean timed, gboolean cold);
+static void     put_text_report (FILE *output, guint num_queries);
+static void     put_json_report (FILE *output, guint num_queries);
+
+
+
+/* Add the queries of <trace_file> ['-' = stdin] to <queries>.  Lines that are not queries are skipped, with a warning. */
+static void read_trace(const gchar *trace_file, GArray *queries)
+{
+    FILE            *input;
+    char            *line = NULL;
+    size_t          line_size = 0;
+    const char      *colon;
+    replay_query_t  query;
+    guint           line_num = 0;
+
+    if (strcmp(trace_file, "-") == 0)
+        input = stdin;
+    else if ( (input = fopen(trace_file, "r")) == NULL )
+    {
+        fprintf(stderr, "Error: Unable to open query trace: %s\n", trace_file);
+        exit(EXIT_FAILURE);
+    }
+
+    while (getline(&line, &line_size, input) != -1)
+    {
+        line_num++;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        /* Skip blank lines and comments */
+        if ( (line[0] == '\0') || (line[0] == '#') ) continue;
+
+        colon = strchr(line, ':');
+        if ( !SEARCH_type_from_name(line, colon ? (gsize) (colon - line) : strlen(line), &query.operation) )
+        {
+            fprintf(stderr, "Warning: %s:%u: Unknown query type: %s\n", trace_file, line_num, line);
+            continue;
+        }
+
+        query.pattern = g_strdup(colon ? colon + 1 : "");
+        g_array_append_val(queries, query);
+    }
+
+    free(line);
+    if (input != stdin) fclose(input);
+}
+
+
+
+/* Run every query once, adding the timings and the work done to the totals if <timed> */
+static void run_queries(GArray *queries, gboolean timed, gboolean cold)
+{
+    replay_query_t      *query;
+    search_results_t    *results;
+    search_work_t       work;
+    gchar               *pattern;
+    gdouble             ms;
+    gint64              start;
+    guint               i, t;
+
+    for (i = 0; i < queries->len; i++)
+    {
+        query = &g_array_index(queries, replay_query_t, i);
+        pattern = g_strdup(query->pattern);     /* Searches may trim the pattern in place */
+
+        if (cold) SEARCH_cache_flush();
+
+        start = g_get_monotonic_time();
+        results = SEARCH_lookup(query->operation, pattern);
+        if (results) SEARCH_free_results(results);
+        ms = (g_get_monotonic_time() - start) / 1000.0;
+
+        g_free(pattern);
+        if ( !timed ) continue;
+
+        SEARCH_last_work(&work);
+
+        for (t = query->operation; ; t = NUM_FIND_TYPES)
+        {
+            g_array_append_val(totals[t].samples, ms);
+            totals[t].cached       += work.cached;
+            totals[t].cref_bytes   += work.cref_bytes;
+            totals[t].source_bytes += work.source_bytes;
+            totals[t].files_opened += work.files_opened;
+
+            if (t == NUM_FIND_TYPES) break;
+        }
+    }
+}
+
+
+
+static void put_text_report(FILE *output, guint num_queries)
+{
+    latency_t   latency;
+    guint       t;
+
+    fprintf(output, "Replayed %u queries x %d pass%s, cache %s:  %s\n\n", num_queries, passes, (passes == 1) ? "" : "es",
+            cache, settings.refFile);
+    fprintf(output, "%-10s %8s %7s %9s %9s %9s %9s %12s %12s %8s\n",
+            "Type", "Queries", "Cached", "p50 ms", "p95 ms", "p99 ms", "Max ms", "Cref MB", "Source MB", "Files");
+
+    for (t = 0; t <= NUM_FIND_TYPES; t++)
+    {
+        if (totals[t].samples->len == 0) continue;
+
+        LATENCY_summarize(totals[t].samples, &latency);
+        fprintf(output, "%-10s %8u %7u %9.3f %9.3f %9.3f %9.3f %12.1f %12.1f %8" G_GUINT64_FORMAT "\n",
+                (t == NUM_FIND_TYPES) ? "all" : SEARCH_type_name(t),
+                latency.count, totals[t].cached, latency.median, latency.p95, latency.p99, latency.max,
+                totals[t].cref_bytes / 1e6, totals[t].source_bytes / 1e6, totals[t].files_opened);
+    }
+}
+
+
+
+static void put_json_report(FILE *output, guint num_queries)
+{
+    latency_t   latency;
+    gboolean    first = TRUE;
+    guint       t;
+
+    fputs("{\"cref\": ", output);
+    my_put_json_string(output, settings.refFile, NULL);
+    fputs(", \"cache\": ", output);
+    my_put_json_string(output, cache, NULL);
+    fprintf(output, ", \"passes\": %d, \"queries\": %u, \"types\": [", passes, num_queries);
+
+    for (t = 0; t <= NUM_FIND_TYPES; t++)
+    {
+        if (totals[t].samples->len == 0) continue;
+
+        LATENCY_summarize(totals[t].samples, &latency);
+        fprintf(output, "%s\n  {\"type\": \"%s\", \"queries\": %u, \"cached\": %u, \"p50_ms\": %.3f, \"p95_ms\": %.3f, "
+                        "\"p99_ms\": %.3f, \"max_ms\": %.3f, \"mean_ms\": %.3f, \"cref_bytes\": %" G_GUINT64_FORMAT ", "
+                        "\"source_bytes\": %" G_GUINT64_FORMAT ", \"files_opened\": %" G_GUINT64_FORMAT "}",
+                first ? "" : ",", (t == NUM_FIND_TYPES) ? "all" : SEARCH_type_name(t),
+                latency.count, totals[t].cached, latency.median, latency.p95, latency.p99, latency.max, latency.mean,
+                totals[t].cref_bytes, totals[t].source_bytes, totals[t].files_opened);
+        first = FALSE;
+    }
+
+    fprintf(output, "\n]}\n");
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    GOptionContext  *context;
+    GError          *error = NULL;
+    GArray          *queries;
+    gboolean        cold;
+    int             saved_stdout;
+    int             i;
+
+    context = g_option_context_new("TRACE... - replay gscope query traces ['-' = stdin]");
+    g_option_context_add_main_entries(context, option_entries, NULL);
+    if ( !g_option_context_parse(context, &argc, &argv, &error) )
+    {
+        fprintf(stderr, "%s\n", error->message);
+        exit(EXIT_FAILURE);
+    }
+    g_option_context_free(context);
+
+    if (cache == NULL) cache = "cold";
+    cold = (strcmp(cache, "cold") == 0);
+
+    if ( (argc < 2) || (passes < 1) || (!cold && (strcmp(cache, "warm") != 0)) )
+    {
+        fprintf(stderr, "Usage: %s [--refFile=FILE] [--dir=DIR] [--cache=cold|warm] [--passes=N] [--json] TRACE...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    queries = g_array_new(FALSE, FALSE, sizeof(replay_query_t));
+    for (i = 1; i < argc; i++) read_trace(argv[i], queries);
+
+    if ( dir && (chdir(dir) != 0) )
+    {
+        fprintf(stderr, "Error: Unable to change directory to %s\n", dir);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Load the cross-reference as-is [like --query]:  build messages go to stderr */
+    if (refFile) g_strlcpy(settings.refFile, refFile, MAX_STRING_ARG_SIZE);
+    settings.refOnly = TRUE;
+    settings.noBuild = TRUE;
+
+    fflush(stdout);
+    saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    BUILD_initDatabase(NULL);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    for (i = 0; i <= NUM_FIND_TYPES; i++) totals[i].samples = g_array_new(FALSE, FALSE, sizeof(gdouble));
+
+    if ( !cold ) run_queries(queries, FALSE, FALSE);
+    for (i = 0; i < passes; i++) run_queries(queries, TRUE, cold);
+
+    if (json)
+        put_json_report(stdout, queries->len);
+    else
+        put_text_report(stdout, queries->len);
+
+    SEARCH_cleanup();
+
+    return(EXIT_SUCCESS);
+}
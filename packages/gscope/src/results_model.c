@@ -0,0 +1,877 @@
+//===========================================================
+//
+//  The search results model:  a GtkTreeModel that indexes the
+//  lines of the search results, and only splits a line into
+//  its fields when the view asks for them.
+//
+//===========================================================
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <string.h>
+
+#include "search.h"
+#include "settings.h"
+#include "display.h"
+#include "results_model.h"
+
+// ==== defines ====
+#define MAX_FUNCTION_SIZE       100     /* Max size of function name */
+#define MAX_DISPLAY_SOURCE      511     /* Max number of character to display for source text */
+#define MAX_CRAZY_BIG_SIZE      15000   /* Max nubmer of source text chars before warnings are generated */
+#define MAX_EXCERPT_SIZE        100
+
+// ==== typedefs ====
+
+typedef struct
+{
+    gchar       *line;          /* The result line [in one of the model's buffers] */
+    gboolean    checked;        /* The line has been cleaned up, and checked for oversized fields */
+    guint32     key[RESULTS_COLUMNS];   /* Sort keys [valid for the model's keyed[] columns] */
+} results_row_t;
+
+
+/* The fields of a result line [not terminated] */
+typedef struct
+{
+    gchar       *start[RESULTS_COLUMNS];
+    gsize       length[RESULTS_COLUMNS];
+} results_fields_t;
+
+
+/* One field of a result line [not terminated] */
+typedef struct
+{
+    const gchar *start;
+    gsize       length;
+} results_slice_t;
+
+
+/* A row to sort:  its key, and its position before the sort */
+typedef struct
+{
+    guint32     key;
+    guint32     row;
+} results_sort_t;
+
+
+struct _ResultsModel
+{
+    GObject     parent;
+
+    gint        stamp;          /* Changed whenever rows move:  older iterators are invalid */
+    GArray      *rows;          /* results_row_t, in display order */
+    GPtrArray   *buffers;       /* Copies of the search results buffers the rows point into */
+    gboolean    keyed[RESULTS_COLUMNS];     /* The rows' sort keys for the column are up-to-date */
+};
+
+typedef struct
+{
+    GObjectClass parent_class;
+} ResultsModelClass;
+
+#ifndef GTK4_BUILD
+typedef GtkSelectionData    drag_data_t;
+#else
+typedef const GValue        drag_data_t;
+#endif
+
+
+//  ==== Private Global Variables ====
+
+/* The longest text shown for each column */
+static const gsize  field_max[RESULTS_COLUMNS] = { PATHLEN, MAX_FUNCTION_SIZE, MAX_LINENUM_SIZE, MAX_DISPLAY_SOURCE };
+
+
+/*** Local Function Prototypes ***/
+
+static void         results_model_tree_model_init   (GtkTreeModelIface *iface);
+static void         results_model_drag_source_init  (GtkTreeDragSourceIface *iface);
+static void         results_model_drag_dest_init    (GtkTreeDragDestIface *iface);
+static guint        add_rows                        (ResultsModel *model, search_results_t *results, guint first);
+static void         split_line                      (gchar *line, results_fields_t *fields);
+static void         check_row                       (results_row_t *row);
+static void         clean_text                      (results_fields_t *fields);
+static void         compute_keys                    (ResultsModel *model, gint column);
+static void         rank_strings                    (results_row_t *rows, guint n, gint column);
+static guint        slice_hash                      (gconstpointer key);
+static gboolean     slice_equal                     (gconstpointer a, gconstpointer b);
+static gint         slice_compare                   (gconstpointer a, gconstpointer b);
+static void         radix_sort                      (results_sort_t *entries, guint n);
+static void         report_overflow                 (results_fields_t *fields, gint column);
+static gchar        *field_string                   (results_fields_t *fields, gint column);
+static gboolean     get_row_index                   (ResultsModel *model, GtkTreePath *path, guint *index);
+
+
+G_DEFINE_TYPE_WITH_CODE(ResultsModel, results_model, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,       results_model_tree_model_init)
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_DRAG_SOURCE, results_model_drag_source_init)
+                        G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_DRAG_DEST,   results_model_drag_dest_init))
+
+
+
+static void results_model_init(ResultsModel *model)
+{
+    model->stamp   = g_random_int();
+    model->rows    = g_array_new(FALSE, FALSE, sizeof(results_row_t));
+    model->buffers = g_ptr_array_new_with_free_func(g_free);
+}
+
+
+
+static void results_model_finalize(GObject *object)
+{
+    ResultsModel *model = RESULTS_MODEL(object);
+
+    g_array_free(model->rows, TRUE);
+    g_ptr_array_free(model->buffers, TRUE);
+
+    G_OBJECT_CLASS(results_model_parent_class)->finalize(object);
+}
+
+
+
+static void results_model_class_init(ResultsModelClass *klass)
+{
+    G_OBJECT_CLASS(klass)->finalize = results_model_finalize;
+}
+
+
+
+// ======================= GtkTreeModel Interface ===============================
+
+static GtkTreeModelFlags results_model_get_flags(GtkTreeModel *tree_model)
+{
+    return(GTK_TREE_MODEL_LIST_ONLY);
+}
+
+
+
+static gint results_model_get_n_columns(GtkTreeModel *tree_model)
+{
+    return(RESULTS_COLUMNS);
+}
+
+
+
+static GType results_model_get_column_type(GtkTreeModel *tree_model, gint column)
+{
+    return(G_TYPE_STRING);
+}
+
+
+
+static gboolean results_model_get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreePath *path)
+{
+    ResultsModel    *model = RESULTS_MODEL(tree_model);
+    guint           index;
+
+    if ( !get_row_index(model, path, &index) || (index >= model->rows->len) ) return(FALSE);
+
+    iter->stamp     = model->stamp;
+    iter->user_data = GUINT_TO_POINTER(index);
+    return(TRUE);
+}
+
+
+
+static GtkTreePath *results_model_get_path(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    g_return_val_if_fail(iter->stamp == RESULTS_MODEL(tree_model)->stamp, NULL);
+
+    return( gtk_tree_path_new_from_indices(GPOINTER_TO_UINT(iter->user_data), -1) );
+}
+
+
+
+/* The row's fields are found [and copied out] on every request:  rows that are never shown cost nothing */
+static void results_model_get_value(GtkTreeModel *tree_model, GtkTreeIter *iter, gint column, GValue *value)
+{
+    ResultsModel        *model = RESULTS_MODEL(tree_model);
+    results_row_t       *row;
+    results_fields_t    fields;
+
+    g_return_if_fail(iter->stamp == model->stamp);
+    g_return_if_fail( (column >= 0) && (column < RESULTS_COLUMNS) );
+
+    row = &g_array_index(model->rows, results_row_t, GPOINTER_TO_UINT(iter->user_data));
+    if ( !row->checked ) check_row(row);
+
+    split_line(row->line, &fields);
+
+    g_value_init(value, G_TYPE_STRING);
+    g_value_take_string(value, field_string(&fields, column));
+}
+
+
+
+static gboolean results_model_iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    ResultsModel    *model = RESULTS_MODEL(tree_model);
+    guint           index = GPOINTER_TO_UINT(iter->user_data) + 1;
+
+    if (index >= model->rows->len)
+    {
+        iter->stamp = 0;
+        return(FALSE);
+    }
+
+    iter->user_data = GUINT_TO_POINTER(index);
+    return(TRUE);
+}
+
+
+
+static gboolean results_model_iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent, gint n)
+{
+    ResultsModel *model = RESULTS_MODEL(tree_model);
+
+    if ( parent || (n < 0) || ((guint) n >= model->rows->len) ) return(FALSE);   // A list:  no row has children
+
+    iter->stamp     = model->stamp;
+    iter->user_data = GUINT_TO_POINTER(n);
+    return(TRUE);
+}
+
+
+
+static gboolean results_model_iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *parent)
+{
+    return( results_model_iter_nth_child(tree_model, iter, parent, 0) );
+}
+
+
+
+static gboolean results_model_iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    return(FALSE);
+}
+
+
+
+static gint results_model_iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    return( iter ? 0 : (gint) RESULTS_MODEL(tree_model)->rows->len );
+}
+
+
+
+static gboolean results_model_iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter, GtkTreeIter *child)
+{
+    return(FALSE);
+}
+
+
+
+static void results_model_tree_model_init(GtkTreeModelIface *iface)
+{
+    iface->get_flags       = results_model_get_flags;
+    iface->get_n_columns   = results_model_get_n_columns;
+    iface->get_column_type = results_model_get_column_type;
+    iface->get_iter        = results_model_get_iter;
+    iface->get_path        = results_model_get_path;
+    iface->get_value       = results_model_get_value;
+    iface->iter_next       = results_model_iter_next;
+    iface->iter_children   = results_model_iter_children;
+    iface->iter_has_child  = results_model_iter_has_child;
+    iface->iter_n_children = results_model_iter_n_children;
+    iface->iter_nth_child  = results_model_iter_nth_child;
+    iface->iter_parent     = results_model_iter_parent;
+}
+
+
+
+// ======================= Drag and Drop [row reordering] ===============================
+//
+// As with GtkListStore, a move is a copy of the dragged row inserted at the drop position,
+// then the deletion of the original.
+
+static gboolean results_model_row_draggable(GtkTreeDragSource *drag_source, GtkTreePath *path)
+{
+    return(TRUE);
+}
+
+
+
+#ifndef GTK4_BUILD
+static gboolean results_model_drag_data_get(GtkTreeDragSource *drag_source, GtkTreePath *path, GtkSelectionData *selection_data)
+{
+    return( gtk_tree_set_row_drag_data(selection_data, GTK_TREE_MODEL(drag_source), path) );
+}
+#else
+static GdkContentProvider *results_model_drag_data_get(GtkTreeDragSource *drag_source, GtkTreePath *path)
+{
+    return( gtk_tree_create_row_drag_content(GTK_TREE_MODEL(drag_source), path) );
+}
+#endif
+
+
+
+static gboolean results_model_drag_data_delete(GtkTreeDragSource *drag_source, GtkTreePath *path)
+{
+    ResultsModel    *model = RESULTS_MODEL(drag_source);
+    guint           index;
+
+    if ( !get_row_index(model, path, &index) || (index >= model->rows->len) ) return(FALSE);
+
+    g_array_remove_index(model->rows, index);
+    model->stamp++;
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+
+    return(TRUE);
+}
+
+
+
+/* Only rows of this model can be dropped, anywhere from the top of the list to just after the last row */
+static gboolean results_model_row_drop_possible(GtkTreeDragDest *drag_dest, GtkTreePath *dest_path, drag_data_t *data)
+{
+    ResultsModel    *model = RESULTS_MODEL(drag_dest);
+    GtkTreeModel    *src_model = NULL;
+    GtkTreePath     *src_path = NULL;
+    guint           index;
+    gboolean        possible;
+
+    if ( !gtk_tree_get_row_drag_data(data, &src_model, &src_path) ) return(FALSE);
+
+    possible = (src_model == GTK_TREE_MODEL(model)) && get_row_index(model, dest_path, &index) && (index <= model->rows->len);
+
+    gtk_tree_path_free(src_path);
+    return(possible);
+}
+
+
+
+static gboolean results_model_drag_data_received(GtkTreeDragDest *drag_dest, GtkTreePath *dest_path, drag_data_t *data)
+{
+    ResultsModel    *model = RESULTS_MODEL(drag_dest);
+    GtkTreeModel    *src_model = NULL;
+    GtkTreePath     *src_path = NULL;
+    GtkTreePath     *path;
+    GtkTreeIter     iter;
+    results_row_t   row;
+    guint           src_index;
+    guint           index;
+    gboolean        received = FALSE;
+
+    if ( !gtk_tree_get_row_drag_data(data, &src_model, &src_path) ) return(FALSE);
+
+    if ( (src_model == GTK_TREE_MODEL(model)) && get_row_index(model, src_path, &src_index) && (src_index < model->rows->len) &&
+         get_row_index(model, dest_path, &index) )
+    {
+        index = MIN(index, model->rows->len);
+        row = g_array_index(model->rows, results_row_t, src_index);
+        g_array_insert_val(model->rows, index, row);
+        model->stamp++;
+
+        iter.stamp     = model->stamp;
+        iter.user_data = GUINT_TO_POINTER(index);
+        path = gtk_tree_path_new_from_indices(index, -1);
+        gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+        gtk_tree_path_free(path);
+
+        received = TRUE;
+    }
+
+    gtk_tree_path_free(src_path);
+    return(received);
+}
+
+
+
+static void results_model_drag_source_init(GtkTreeDragSourceIface *iface)
+{
+    iface->row_draggable    = results_model_row_draggable;
+    iface->drag_data_get    = results_model_drag_data_get;
+    iface->drag_data_delete = results_model_drag_data_delete;
+}
+
+
+
+static void results_model_drag_dest_init(GtkTreeDragDestIface *iface)
+{
+    iface->drag_data_received = results_model_drag_data_received;
+    iface->row_drop_possible  = results_model_row_drop_possible;
+}
+
+
+
+// ======================= Results Model Private Functions ===============================
+
+/* The row index of a top-level <path> [FALSE for any other path] */
+static gboolean get_row_index(ResultsModel *model, GtkTreePath *path, guint *index)
+{
+    if ( (path == NULL) || (gtk_tree_path_get_depth(path) != 1) || (gtk_tree_path_get_indices(path)[0] < 0) ) return(FALSE);
+
+    *index = gtk_tree_path_get_indices(path)[0];
+    return(TRUE);
+}
+
+
+
+/* Add rows for the <results> lines, starting at row <first>.  Returns the number of rows added.
+   The lines are copied in one piece:  the caller frees its results as soon as they are displayed. */
+static guint add_rows(ResultsModel *model, search_results_t *results, guint first)
+{
+    gsize           size = results->end_ptr - results->start_ptr;
+    guint           count = results->match_count;
+    gchar           *buffer;
+    gchar           *line;
+    gchar           *end;
+    results_row_t   *rows;
+    guint           i;
+
+    if ( (count == 0) || (size == 0) ) return(0);
+
+    memset(model->keyed, 0, sizeof(model->keyed));      // New strings:  the ranks must be recomputed
+
+    buffer = g_malloc(size + 1);
+    memcpy(buffer, results->start_ptr, size);
+    buffer[size] = '\0';
+    g_ptr_array_add(model->buffers, buffer);
+
+    /* Open a gap of <count> rows at <first> */
+    g_array_set_size(model->rows, model->rows->len + count);
+    rows = (results_row_t *) model->rows->data;
+    memmove(rows + first + count, rows + first, (model->rows->len - count - first) * sizeof(results_row_t));
+
+    /* Each line of the search results is one row [a malformed buffer leaves empty rows, not stray pointers] */
+    line = buffer;
+    end  = buffer + size;
+    for (i = 0; i < count; i++)
+    {
+        rows[first + i].line    = line;
+        rows[first + i].checked = FALSE;
+
+        if ( (line = memchr(line, '\n', end - line)) == NULL )
+            line = end;
+        else
+            line++;
+    }
+
+    return(count);
+}
+
+
+
+/*
+ * Find the fields of a result line.  The line format uses '|' and space ' ' characters for field
+ * delimiters as follows [although some fields may have dummy values]:
+ *
+ *   <file name>|<function name> <line number> <source text>\n
+ *
+ * Note: <source text> can contain any number of space ' ' characters.
+ */
+static void split_line(gchar *line, results_fields_t *fields)
+{
+    static const gchar  terminator[RESULTS_COLUMNS] = { '|', ' ', ' ', '\n' };
+    gchar   *end;
+    gchar   *next;
+    gint    i;
+
+    if ( (end = strchr(line, '\n')) == NULL ) end = line + strlen(line);
+
+    for (i = 0; i < RESULTS_COLUMNS; i++)
+    {
+        if ( (next = memchr(line, terminator[i], end - line)) == NULL ) next = end;
+
+        fields->start[i]  = line;
+        fields->length[i] = next - line;
+
+        line = (next < end) ? next + 1 : end;
+    }
+}
+
+
+
+/* The first time a row is shown:  eliminate non-ASCII chars from the source text, and report oversized fields */
+static void check_row(results_row_t *row)
+{
+    results_fields_t    fields;
+    gint                column;
+
+    split_line(row->line, &fields);
+    clean_text(&fields);
+
+    for (column = 0; column < RESULTS_COLUMNS; column++)
+    {
+        if (fields.length[column] > field_max[column]) report_overflow(&fields, column);
+    }
+
+    row->checked = TRUE;
+}
+
+
+
+/* Eliminate non-ASCII chars from the source text [in place] */
+static void clean_text(results_fields_t *fields)
+{
+    gchar   *text = fields->start[RESULTS_TEXT];
+    gsize   i;
+
+    for (i = 0; i < fields->length[RESULTS_TEXT]; i++)
+    {
+        if ((guchar) text[i] > 0x7f) text[i] = '?';
+    }
+}
+
+
+
+static void report_overflow(results_fields_t *fields, gint column)
+{
+    static const gchar  *name[RESULTS_COLUMNS] = { "File Path Name", "Function", "Line Number", "Source Text" };
+
+    gchar   *start  = fields->start[column];
+    gint    length  = fields->length[column];
+    gint    width   = MIN(field_max[column] / 4, (gsize) MAX_EXCERPT_SIZE);
+    gint    file_length = MIN(fields->length[RESULTS_FILE], (gsize) PATHLEN);
+
+    if (column == RESULTS_TEXT)
+    {
+        if ( (fields->length[RESULTS_LINE] == 1) && (*fields->start[RESULTS_LINE] == '1') )
+        {
+            fprintf(stderr, "*** Warning: File %.*s is not using Linux newline format\n", file_length, fields->start[RESULTS_FILE]);
+        }
+
+        if (length <= MAX_CRAZY_BIG_SIZE) return;   // Only the "worst" big source lines are reported
+    }
+
+    fprintf(stderr, "Warning: Field width overflow: [%s] will be truncated.\n", name[column]);
+    fprintf(stderr, "    Max %s length allowed: %d, Actual %s length: %d\n", name[column], (gint) field_max[column], name[column], length);
+
+    if (column != RESULTS_FILE)
+        fprintf(stderr, "    File: %.*s\n", file_length, fields->start[RESULTS_FILE]);
+
+    if (column == RESULTS_LINE)
+    {
+        fprintf(stderr, "    Full Line Number: %.*s\n\n", length, start);
+        return;
+    }
+
+    if (column == RESULTS_TEXT)
+        fprintf(stderr, "    Line: %.*s\n", (gint) MIN(fields->length[RESULTS_LINE], (gsize) MAX_LINENUM_SIZE), fields->start[RESULTS_LINE]);
+
+    fprintf(stderr, "    Excerpt [Head]: %.*s\n", width, start);
+    fprintf(stderr, "    Excerpt [Tail]: %.*s\n\n", width, start + length - width);
+}
+
+
+
+/* A copy of a field, ellipsized to the column's maximum length [line numbers end with an 'E' instead] */
+static gchar *field_string(results_fields_t *fields, gint column)
+{
+    gsize   max = field_max[column];
+    gchar   *text;
+
+    if (fields->length[column] <= max) return( g_strndup(fields->start[column], fields->length[column]) );
+
+    text = g_strndup(fields->start[column], max);
+    if (column == RESULTS_LINE)
+        text[max - 1] = 'E';
+    else
+        memcpy(text + max - 3, "...", 3);
+
+    return(text);
+}
+
+
+
+/* Compute every row's sort key for <column>:  the line number, or the rank of the field among the column's distinct strings */
+static void compute_keys(ResultsModel *model, gint column)
+{
+    results_row_t       *rows = (results_row_t *) model->rows->data;
+    results_fields_t    fields;
+    guint64             number;
+    gsize               j;
+    guint               i;
+
+    if (column == RESULTS_LINE)
+    {
+        for (i = 0; i < model->rows->len; i++)
+        {
+            split_line(rows[i].line, &fields);
+
+            number = 0;
+            for (j = 0; (j < fields.length[RESULTS_LINE]) && g_ascii_isdigit(fields.start[RESULTS_LINE][j]); j++)
+            {
+                number = MIN(number * 10 + (fields.start[RESULTS_LINE][j] - '0'), G_MAXUINT32);
+            }
+            rows[i].key[column] = number;
+        }
+    }
+    else
+        rank_strings(rows, model->rows->len, column);
+
+    model->keyed[column] = TRUE;
+}
+
+
+
+/*
+ * Set each row's <column> key to the rank [in byte order] of its field among the distinct fields of the column.
+ * Only the distinct strings are compared:  a few thousand file names for a million rows.
+ */
+static void rank_strings(results_row_t *rows, guint n, gint column)
+{
+    results_fields_t    fields;
+    results_slice_t     *slices = g_new(results_slice_t, n);
+    results_slice_t     **distinct = g_new(results_slice_t *, n);
+    guint32             *rank;
+    GHashTable          *ids = g_hash_table_new(slice_hash, slice_equal);
+    gpointer            id;
+    guint               count = 0;
+    guint               i;
+
+    /* Number the distinct strings in order of appearance */
+    for (i = 0; i < n; i++)
+    {
+        split_line(rows[i].line, &fields);
+        if (column == RESULTS_TEXT) clean_text(&fields);    // Sort the text as it is shown
+
+        slices[i].start  = fields.start[column];
+        slices[i].length = fields.length[column];
+
+        if ( (id = g_hash_table_lookup(ids, &slices[i])) == NULL )
+        {
+            distinct[count] = &slices[i];
+            id = GUINT_TO_POINTER(++count);
+            g_hash_table_insert(ids, &slices[i], id);
+        }
+        rows[i].key[column] = GPOINTER_TO_UINT(id) - 1;
+    }
+
+    /* Replace the numbers with ranks */
+    qsort(distinct, count, sizeof(results_slice_t *), slice_compare);
+
+    rank = g_new(guint32, count);
+    for (i = 0; i < count; i++) rank[ rows[distinct[i] - slices].key[column] ] = i;
+    for (i = 0; i < n; i++) rows[i].key[column] = rank[ rows[i].key[column] ];
+
+    g_hash_table_destroy(ids);
+    g_free(rank);
+    g_free(distinct);
+    g_free(slices);
+}
+
+
+
+static guint slice_hash(gconstpointer key)
+{
+    const results_slice_t   *slice = key;
+    guint                   hash = 5381;
+    gsize                   i;
+
+    for (i = 0; i < slice->length; i++) hash = (hash * 33) + (guchar) slice->start[i];
+
+    return(hash);
+}
+
+
+
+static gboolean slice_equal(gconstpointer a, gconstpointer b)
+{
+    const results_slice_t   *x = a;
+    const results_slice_t   *y = b;
+
+    return( (x->length == y->length) && (memcmp(x->start, y->start, x->length) == 0) );
+}
+
+
+
+/* qsort() comparison of two results_slice_t pointers */
+static gint slice_compare(gconstpointer a, gconstpointer b)
+{
+    const results_slice_t   *x = *(results_slice_t * const *) a;
+    const results_slice_t   *y = *(results_slice_t * const *) b;
+    gint                    order;
+
+    if ( (order = memcmp(x->start, y->start, MIN(x->length, y->length))) != 0 ) return(order);
+
+    return( (x->length > y->length) - (x->length < y->length) );
+}
+
+
+
+/* Stable LSD radix sort of <entries> by key, a byte at a time.  Bytes that are the same in every key are skipped. */
+static void radix_sort(results_sort_t *entries, guint n)
+{
+    results_sort_t  *scratch = g_new(results_sort_t, n);
+    results_sort_t  *from = entries;
+    results_sort_t  *to = scratch;
+    results_sort_t  *swap;
+    guint           count[256];
+    guint           shift;
+    guint           total;
+    guint           digit;
+    guint           i;
+
+    for (shift = 0; shift < 32; shift += 8)
+    {
+        memset(count, 0, sizeof(count));
+        for (i = 0; i < n; i++) count[(from[i].key >> shift) & 0xff]++;
+
+        if (count[(from[0].key >> shift) & 0xff] == n) continue;
+
+        for (digit = 0, total = 0; digit < 256; digit++)
+        {
+            i = count[digit];
+            count[digit] = total;
+            total += i;
+        }
+
+        for (i = 0; i < n; i++) to[ count[(from[i].key >> shift) & 0xff]++ ] = from[i];
+
+        swap = from;
+        from = to;
+        to   = swap;
+    }
+
+    if (from != entries) memcpy(entries, from, n * sizeof(results_sort_t));
+    g_free(scratch);
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* A new model holding the <results> rows [NULL:  no rows].  No row signals:  it is not shown yet. */
+ResultsModel *RESULTS_model_new(search_results_t *results)
+{
+    ResultsModel *model = g_object_new(RESULTS_TYPE_MODEL, NULL);
+
+    if (results) add_rows(model, results, 0);
+
+    return(model);
+}
+
+
+
+/* Insert the <results> rows at row <position> [-1 = append to the end of the list] */
+void RESULTS_model_insert(ResultsModel *model, search_results_t *results, gint position)
+{
+    GtkTreePath *path;
+    GtkTreeIter iter;
+    guint       first;
+    guint       count;
+    guint       i;
+
+    first = ( (position < 0) || ((guint) position > model->rows->len) ) ? model->rows->len : (guint) position;
+
+    if ( (count = add_rows(model, results, first)) == 0 ) return;
+    model->stamp++;
+
+    path = gtk_tree_path_new_from_indices(first, -1);
+    iter.stamp = model->stamp;
+
+    for (i = first; i < first + count; i++)
+    {
+        iter.user_data = GUINT_TO_POINTER(i);
+        gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+        gtk_tree_path_next(path);
+    }
+
+    gtk_tree_path_free(path);
+}
+
+
+
+/*
+ * Sort the rows by <column>.  The sort is stable:  rows with the same value stay in their current order
+ * [so sorting by line, then by file, orders by file and line].  The keys are computed once per column
+ * and kept until rows are added.
+ */
+void RESULTS_model_sort(ResultsModel *model, gint column, gboolean descending)
+{
+    results_row_t   *rows = (results_row_t *) model->rows->data;
+    results_sort_t  *entries;
+    GArray          *sorted;
+    GtkTreePath     *path;
+    gint            *new_order;
+    guint           n = model->rows->len;
+    guint           i;
+
+    g_return_if_fail( (column >= 0) && (column < RESULTS_COLUMNS) );
+    if (n < 2) return;
+
+    if ( !model->keyed[column] ) compute_keys(model, column);
+
+    /* Descending order is the ascending order of the inverted keys:  equal keys still keep their order */
+    entries = g_new(results_sort_t, n);
+    for (i = 0; i < n; i++)
+    {
+        entries[i].key = descending ? ~rows[i].key[column] : rows[i].key[column];
+        entries[i].row = i;
+    }
+
+    radix_sort(entries, n);
+
+    /* Apply the permutation [new_order[new position] = old position] */
+    sorted    = g_array_sized_new(FALSE, FALSE, sizeof(results_row_t), n);
+    new_order = g_new(gint, n);
+    for (i = 0; i < n; i++)
+    {
+        g_array_append_val(sorted, rows[entries[i].row]);
+        new_order[i] = entries[i].row;
+    }
+
+    g_array_free(model->rows, TRUE);
+    model->rows = sorted;
+    model->stamp++;
+
+    path = gtk_tree_path_new();
+    gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, NULL, new_order);
+    gtk_tree_path_free(path);
+
+    g_free(new_order);
+    g_free(entries);
+}
+
+
+
+/*
+ * Find the row with the longest field [in bytes, up to the displayed length] for each column, in
+ * a sample of at most <sample> rows spread over the list [0 = every row].  <longest> is -1 for
+ * each column if the list is empty.  The rows are not checked:  only their lengths are used.
+ */
+void RESULTS_model_longest(ResultsModel *model, guint sample, gint longest[RESULTS_COLUMNS])
+{
+    results_row_t       *rows = (results_row_t *) model->rows->data;
+    results_fields_t    fields;
+    gsize               length[RESULTS_COLUMNS];
+    gsize               field_length;
+    guint               n = model->rows->len;
+    guint               step;
+    guint               i;
+    gint                column;
+
+    for (column = 0; column < RESULTS_COLUMNS; column++)
+    {
+        longest[column] = -1;
+        length[column]  = 0;
+    }
+
+    step = ( (sample > 0) && (n > sample) ) ? n / sample : 1;
+
+    for (i = 0; i < n; i += step)
+    {
+        split_line(rows[i].line, &fields);
+
+        for (column = 0; column < RESULTS_COLUMNS; column++)
+        {
+            field_length = MIN(fields.length[column], field_max[column]);
+            if ( (longest[column] < 0) || (field_length > length[column]) )
+            {
+                longest[column] = i;
+                length[column]  = field_length;
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+//===============================================================
+// Defines
+//===============================================================
+
+#define RESULTS_TYPE_MODEL      (results_model_get_type())
+#define RESULTS_MODEL(obj)      (G_TYPE_CHECK_INSTANCE_CAST((obj), RESULTS_TYPE_MODEL, ResultsModel))
+
+
+//===============================================================
+// typedefs
+//===============================================================
+
+/* The search results list:  a GtkTreeModel over the result lines themselves [no per-row strings] */
+typedef struct _ResultsModel ResultsModel;
+
+/* The model's columns [all G_TYPE_STRING] */
+enum
+{
+    RESULTS_FILE = 0,
+    RESULTS_FUNCTION,
+    RESULTS_LINE,
+    RESULTS_TEXT,
+    RESULTS_COLUMNS
+};
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+GType           results_model_get_type  (void);
+
+ResultsModel    *RESULTS_model_new      (search_results_t *results);
+void            RESULTS_model_insert    (ResultsModel *model, search_results_t *results, gint position);
+void            RESULTS_model_sort      (ResultsModel *model, gint column, gboolean descending);
+void            RESULTS_model_longest   (ResultsModel *model, guint sample, gint longest[RESULTS_COLUMNS]);
@@ -0,0 +1,83 @@
+
+/*
+ *  Cross-reference scanning primitives
+ *
+ *  The database walkers spend most of their time skipping to the next newline or the next
+ *  mark tab.  These replace the byte-at-a-time loops with a vectorized search:  glibc's
+ *  rawmemchr() (which selects an AVX2/SSE2 implementation at run time), an SSE2 loop on other
+ *  x86 C libraries, or the original scalar loop everywhere else.
+ *
+ *  Like the loops they replace, these never check for the end of the buffer.  The character
+ *  being searched for MUST be present (the database always ends with "\t@\n").
+ */
+
+#include <string.h>      /* rawmemchr() is a GNU extension: AC_USE_SYSTEM_EXTENSIONS provides _GNU_SOURCE */
+#include <stdint.h>
+
+#if defined(__SSE2__) && !defined(__GLIBC__)
+#include <emmintrin.h>
+#endif
+
+
+/* Return a pointer to the first <c> at or after <ptr> */
+static inline char *SCAN_find_char(const char *ptr, int c)
+{
+#if defined(__GLIBC__)
+
+    return( (char *) rawmemchr(ptr, c) );
+
+#elif defined(__SSE2__)
+
+    /* Aligned 16-byte loads never cross a page boundary, so reading a few bytes on either
+       side of the target is safe */
+    const __m128i   target = _mm_set1_epi8((char) c);
+    const char      *block = (const char *) ((uintptr_t) ptr & ~(uintptr_t) 15);
+    unsigned        mask;
+
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) block), target));
+    mask &= ~0u << (ptr - block);       /* Ignore any matches before <ptr> */
+
+    while (mask == 0)
+    {
+        block += 16;
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *) block), target));
+    }
+    return( (char *) block + __builtin_ctz(mask) );
+
+#else
+
+    while (*ptr != (char) c) ptr++;
+    return( (char *) ptr );
+
+#endif
+}
+
+
+
+/* Return a pointer to the next newline at or after <ptr>.      Replaces: while (*ptr != '\n') ptr++; */
+static inline char *SCAN_newline(const char *ptr)
+{
+    return( SCAN_find_char(ptr, '\n') );
+}
+
+
+
+/* Return a pointer to the character following the next tab.   Replaces: while (*ptr++ != '\t'); */
+static inline char *SCAN_past_tab(const char *ptr)
+{
+    return( SCAN_find_char(ptr, '\t') + 1 );
+}
+
+
+
+/* Return a pointer to the character following the next "\t<mark>" pair [e.g. the next "\t@" file boundary] */
+static inline char *SCAN_past_mark(const char *ptr, char mark)
+{
+    do
+    {
+        ptr = SCAN_past_tab(ptr);
+    }
+    while (*ptr++ != mark);
+
+    return( (char *) ptr );
+}
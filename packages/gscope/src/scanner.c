@@ -1104,7 +1104,6 @@ char *yytext;
 #include "config.h"
 #endif
 
-#include <gtk/gtk.h>
 #include <assert.h>
 #include <string.h>
 #include <glib.h>
@@ -1115,7 +1114,7 @@ char *yytext;
 #include "crossref.h"
 #include "dir.h"
 #include "utils.h"
-#include "app_config.h"
+#include "settings.h"
 
 #define     PATLEN                  PATHLEN         /* symbol pattern length */
 #define     STMTMAX                 50000           /* maximum source statement length */
@@ -7,15 +7,17 @@
 #include "config.h"
 #endif
 
-#include <gtk/gtk.h>
+#include <glib.h>
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <time.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <regex.h>
 #include <string.h>
@@ -27,15 +29,15 @@
 #include "lookup.h"
 #include "crossref.h"
 #include "utils.h"
-#include "display.h"
-#include "app_config.h"
-#include "callbacks_pub.h"
-
-#ifndef GTK4_BUILD
-#ifndef GTK3_BUILD
-#include "support.h"
-#endif
-#endif
+#include "settings.h"
+#include "symset.h"
+#include "dict.h"
+#include "cgraph.h"
+#include "incgraph.h"
+#include "pathidx.h"
+#include "scan.h"
+#include "engine.h"
+#include "probes.h"
 
 
 //===============================================================
@@ -44,6 +46,18 @@
 #define MAX_SYMBOL_SIZE     1024
 #define MAX_PID_SIZE        (7+1)   /* For most 64-bit systems, Max PID is 2^22 = 4194304 (7 digits + null termination) */
 #define MAX_TMP_PATH        PATHLEN + sizeof("/cscope.1") + MAX_PID_SIZE
+#define STREAM_BATCH_ROWS   1000            /* Deliver a streamed batch once this many matches are pending... */
+#define STREAM_BATCH_USEC   (10 * 1000)     /* ...or once the oldest pending match is this old (microseconds) */
+#define PROGRESS_USEC       (100 * 1000)    /* Minimum time between progress notifications (microseconds) */
+#define PROGRESS_CHECK      16              /* Only consult the clock once every PROGRESS_CHECK files */
+#define QUERY_CACHE_BYTES   (32 * 1024 * 1024)  /* Memory budget for cached query results */
+#define QUERY_CACHE_ENTRIES 64                  /* Maximum number of cached queries */
+#define REACH_DEPTH         3       /* Default number of calls followed by FIND_REACHABLE */
+#define PATH_DEPTH          6       /* Default maximum length (calls) of a FIND_CALL_PATHS path */
+#define MAX_CALL_PATHS      100     /* Maximum number of paths reported by FIND_CALL_PATHS */
+#define INCLUDE_DEPTH       0       /* Default number of #include levels followed by FIND_INCLUDERS (0 = all) */
+#define PATH_SCAN_FILES     4096    /* Minimum number of files per thread for a parallel FIND_FILE regex scan */
+#define MAX_SCAN_THREADS    16
 
 //===============================================================
 //       Local Type Definitions
@@ -56,6 +70,89 @@ typedef enum    {       /* Search result codes */
 } search_result_t;
 
 
+typedef enum    {       /* How a symbol search pattern is matched against the cross-reference */
+    MATCH_BYTES,        /* Byte-for-byte against the compressed symbol */
+    MATCH_FOLDED,       /* Case-insensitive, against the compressed symbol (pattern is lower case, uncompressed) */
+    MATCH_REGEXP        /* regexec() against the expanded symbol */
+} match_mode_t;
+
+
+/* A search request.  Asynchronous requests are owned by the search engine until their 'done'
+   notification has been delivered.  Synchronous requests live on the caller's stack. */
+struct _search_token
+{
+    search_t            operation;
+    gchar               *pattern;
+    search_callbacks_t  callbacks;
+    gpointer            user_data;
+    gint                cancelled;      /* Atomic: set by SEARCH_token_cancel() */
+    gint                generation;     /* cancel_generation at the time of the request */
+    gboolean            ignore_case;    /* settings.ignoreCase and settings.truncateSymbols at the time of the request: */
+    gboolean            truncate_symbols;   /* the GUI may change them while the search thread is busy */
+    search_results_t    results;
+};
+
+
+/* A cached query result, keyed by operation, pattern, ignoreCase and truncateSymbols.  Every entry belongs to
+   the same database generation (cache_generation): the cache is flushed when the generation changes. */
+typedef struct
+{
+    search_t            operation;
+    gchar               *pattern;
+    gboolean            ignore_case;
+    gboolean            truncate_symbols;
+    gchar               *data;          /* Copy of the complete results file */
+    gsize               size;
+    guint               match_count;
+} cache_entry_t;
+
+
+/* The output of one pattern in a batched lookup (see SEARCH_lookup_batch).  Like the
+   temp files of a normal lookup, <global> references [0] are listed before the others [1]. */
+typedef struct
+{
+    FILE                *output[2];
+    char                *buf[2];
+    size_t              size[2];
+} batch_group_t;
+
+
+/* One thread's share of a FIND_FILE regular expression scan (see match_paths) */
+typedef struct
+{
+    const char          *pattern;
+    GArray              *files;         /* The files to check [NULL = every file] */
+    guint               first;          /* Check files[first] to files[last - 1] */
+    guint               last;
+    gboolean            *matched;       /* Result for each file checked [indexed like 'files'] */
+    gboolean            ignore_case;
+    gint64              cpu_time;       /* CPU time used by the scan, in microseconds */
+} path_scan_t;
+
+
+typedef enum    {       /* UI notification types */
+    NOTIFY_STATUS,
+    NOTIFY_CREF,
+    NOTIFY_PROGRESS,
+    NOTIFY_BATCH,
+    NOTIFY_DONE
+} notify_type_t;
+
+
+/* A notification for the UI.  Notifications from the search thread are delivered, in order, by the GTK main loop */
+typedef struct
+{
+    notify_type_t       type;
+    search_token_t      *token;
+    gchar               *msg;           /* NOTIFY_STATUS */
+    gboolean            up_to_date;     /* NOTIFY_CREF */
+    guint               searched;       /* NOTIFY_PROGRESS */
+    guint               total;
+    guint               matches;
+    search_batch_t      batch;          /* NOTIFY_BATCH */
+} notify_t;
+
+
 //===============================================================
 //       Public Global Variables
 //===============================================================
@@ -67,15 +164,75 @@ typedef enum    {       /* Search result codes */
 //===============================================================
 
 static char         *cref_file_buf = NULL;  /* Buffer the holds the entire cross reference database */
+static off_t        cref_file_size = 0;
+static gboolean     cref_file_mapped = FALSE;   /* cref_file_buf is a read-only mapping of the file, not a private copy */
+static cgraph_t     *call_graph = NULL;     /* Call graph of cref_file_buf (built on first use, see get_call_graph) */
+static incgraph_t   *include_graph = NULL;  /* #include graph of cref_file_buf (built on first use, see get_include_graph) */
+static pathidx_t    *path_index = NULL;     /* Index of DIR_src_files (built on first use, see get_path_index) */
+static GHashTable   *file_sections = NULL;  /* File name -> offset of the file's section in cref_file_buf + 1 (see get_file_section) */
 static char         global[] = "<global>";  /* dummy global function name */
 static uint32_t     imatch_count;           /* Intermediate match count */
 static char         temp1[MAX_TMP_PATH + 1]; /* temporary file name */
 static char         temp2[MAX_TMP_PATH + 1]; /* temporary file name */
 static FILE         *nonglobalrefs;
-static gboolean     cancel_search = FALSE;  /* UI hook to abort a lengthy search */
 static gboolean     cref_status   = TRUE;   /* Cross reference up-to-date status */
 static FILE         *refsfound;
 
+/* Search thread state */
+static GMutex       engine_lock;                /* Held while the cross-reference or the temp files are in use */
+static GThread      *ui_thread = NULL;          /* The thread that owns the GTK main loop */
+static GAsyncQueue  *request_queue = NULL;      /* Pending asynchronous search requests */
+static gint         cancel_generation = 0;      /* Atomic: bumped by SEARCH_cancel() to cancel every outstanding request */
+static search_token_t *active_token = NULL;     /* The request currently being searched */
+static gint64       progress_time;              /* Time of the most recent progress notification */
+
+/* Streaming results state (active only while searching for a request with a 'batch' callback) */
+static gboolean     stream_active = FALSE;
+static int          stream_fd[2] = { -1, -1 };   /* Read-side descriptors for temp1 [head] and temp2 [tail] */
+static off_t        stream_offset[2];           /* Bytes already delivered from each temp file */
+static uint32_t     stream_count;               /* Matches already delivered */
+static gint64       stream_time;                /* Time of the most recent delivery */
+
+/* Query results cache state (protected by engine_lock, except for db_generation) */
+static gint         db_generation = 0;          /* Atomic: bumped whenever the database is reloaded or found stale */
+static gint         cache_generation = 0;       /* The database generation of every entry in the cache */
+static GQueue       cache_lru = G_QUEUE_INIT;   /* Cached results, most recently used first */
+static gsize        cache_bytes = 0;
+static guint        cache_hits = 0;
+static guint        cache_misses = 0;
+
+/* Query trace and accounting state (protected by engine_lock, except for the history ring) */
+static FILE         *query_log = NULL;          /* Every query is appended here [SEARCH_set_query_log], NULL = off */
+static search_work_t last_work;                 /* The work done by the search in progress, or by the last one */
+
+/* Search history ring (protected by history_lock:  the statistics dialog must not wait for a search to finish) */
+static GMutex       history_lock;
+static search_work_t work_history[SEARCH_WORK_HISTORY];    /* Ring buffer of the most recent searches */
+static guint        history_next = 0;           /* The next work_history[] slot to fill */
+static guint        history_count = 0;
+
+/* The names of the query types:  query traces, --query and the query server use "<name>:<pattern>" */
+static const struct
+{
+    const gchar     *name;
+    search_t        operation;
+} type_names[] =
+{
+    { "symbol",     FIND_SYMBOL },
+    { "def",        FIND_DEF },
+    { "callees",    FIND_CALLEDBY },
+    { "callers",    FIND_CALLING },
+    { "text",       FIND_STRING },
+    { "regexp",     FIND_REGEXP },
+    { "file",       FIND_FILE },
+    { "including",  FIND_INCLUDING },
+    { "functions",  FIND_ALL_FUNCTIONS },
+    { "reachable",  FIND_REACHABLE },
+    { "paths",      FIND_CALL_PATHS },
+    { "includers",  FIND_INCLUDERS },
+    { "outline",    FIND_OUTLINE },
+};
+
 //===============================================================
 //      Local Functions
 //===============================================================
@@ -85,36 +242,81 @@ static gboolean         putsource(FILE *output, char **src_ptr);
 
 static void             progress      (uint32_t n1, uint32_t n2);
 static void             initprogress  (void);
-static search_result_t  find_regexp   (char *pattern);
-static search_result_t  find_string   (char *pattern);
-static search_result_t  find_symbol   (char *pattern);
-static search_result_t  find_def      (char *pattern);
-static search_result_t  find_called_by(char *pattern);
-static search_result_t  find_calling  (char *pattern);
-static search_result_t  find_file     (char *pattern);
-static search_result_t  find_include  (char *pattern);
+static void             stream_start  (void);
+static void             stream_check  (void);
+static void             stream_flush  (void);
+static void             stream_stop   (void);
+static gboolean         search_cancelled(void);
+static void             search_status (gchar *msg);
+static void             search_cref_current(gboolean up_to_date);
+static void             post_notify   (notify_t *notify);
+static gboolean         notify_ui     (gpointer data);
+static gpointer         search_thread (gpointer data);
+static gboolean         perform_lookup(search_token_t *token);
+static gboolean         cacheable     (search_t operation);
+static cache_entry_t    *cache_find   (search_t operation, gchar *pattern, gboolean ignore_case, gboolean truncate_symbols);
+static void             cache_store   (search_t operation, gchar *pattern, gboolean ignore_case, gboolean truncate_symbols,
+                                       gint generation,
+                                       search_results_t *results);
+static void             cache_evict   (GList *link);
+static void             cache_flush   (void);
+static void             log_query     (search_t operation, const gchar *pattern);
+static gint64           cpu_time      (void);
+static void             record_work   (search_results_t *results, gint64 wall_start, gint64 cpu_start);
+static search_result_t  find_regexp   (char *pattern, gboolean ignore_case);
+static search_result_t  find_string   (char *pattern, gboolean ignore_case);
+static search_result_t  find_symbol   (char *pattern, gboolean ignore_case, gboolean truncate_symbols);
+static search_result_t  find_def      (char *pattern, gboolean ignore_case, gboolean truncate_symbols);
+static search_result_t  find_called_by(char *pattern, gboolean ignore_case, gboolean truncate_symbols);
+static search_result_t  find_calling  (char *pattern, gboolean ignore_case, gboolean truncate_symbols);
+static search_result_t  find_file     (char *pattern, gboolean ignore_case);
+static search_result_t  find_include  (char *pattern, gboolean ignore_case);
+static const pathidx_t  *get_path_index(void);
+static gboolean         literal_path_pattern(const char *pattern, char *literal, pathidx_match_t *match);
+static GArray           *match_paths   (const char *pattern, GArray *candidates, gboolean ignore_case);
+static gpointer         scan_paths    (gpointer data);
 static search_result_t  find_all_functions(void);
+static search_result_t  find_reachable(char *pattern);
+static search_result_t  find_call_paths(char *pattern);
+static const cgraph_t   *get_call_graph(void);
+static search_result_t  find_includers(char *pattern);
+static search_result_t  find_outline  (char *pattern);
+static char             *get_file_section(const char *file);
+static const incgraph_t *get_include_graph(void);
+static void             put_call      (const cgraph_t *graph, const cgraph_call_t *call);
 static void             find_called_by_sub(char *file, char **src);
+static void             find_calling_batch  (symset_t *names, batch_group_t *groups);
+static void             find_called_by_batch(symset_t *names, batch_group_t *groups);
+static void             find_batch_in_graph(search_t search_operation, gchar **patterns, guint count, gint *group_of,
+                                            batch_group_t *groups, guint num_groups);
+static void             batch_putref(batch_group_t *group, char *file, char *func, char **src);
+static void             batch_results(batch_group_t *group, search_results_t *results);
 
 static gboolean         writerefsfound(void);
 static void             get_string(char *dest, char **src);
 static char             *html_copy(FILE *output_file, char *read_ptr, char match_char);
 static char             *open_results_file(char *results_file, off_t *size);
+static char             *read_results_file(char *results_file, off_t *size);
 static FILE             *open_out_file(gchar *full_filename);
 static gboolean         is_regexp(char *pattern);
-static void             match_file(char *infile_name, regex_t regex_ptr, char *format);
+static gboolean         is_symbol(char *pattern);
+static void             cref_advise(int advice);
+static void             match_file(char *infile_name, regex_t regex_ptr, const char *literal, char *format);
+static const char       *required_literal(const char *pattern, char *literal, gboolean ignore_case);
 static gboolean         match_regex(char **src, regex_t regex_ptr);
 static gboolean         match_bytes(char **src_ptr, char *cpattern);
+static gboolean         match_folded(char **src_ptr, char *fpattern);
 static void             strip_anchors(char *pattern);
-static gboolean         compress_search_pattern(char *cpattern, char *pattern);
+static gboolean         compress_search_pattern(char *cpattern, char *pattern, gboolean truncate_symbols);
 
-static search_result_t  configure_search(char *pattern,   gboolean *use_regexp, regex_t *regex_ptr,       char *cpattern);
-static gboolean         mega_match(      char **read_ptr, gboolean use_regexp,  const regex_t *regex_ptr, char *cpattern);
+static search_result_t  configure_search(char *pattern,   gboolean ignore_case, gboolean truncate_symbols,
+                                         match_mode_t *match_mode, regex_t *regex_ptr, char *cpattern);
+static gboolean         mega_match(      char **read_ptr, match_mode_t match_mode,  const regex_t *regex_ptr, char *cpattern);
 
 
 
 /* find the symbol in the cross-reference */
-static search_result_t find_symbol(char *pattern)
+static search_result_t find_symbol(char *pattern, gboolean ignore_case, gboolean truncate_symbols)
 {
     char        file[MAX_SYMBOL_SIZE + 1];     /* source file name */
     char        function[MAX_SYMBOL_SIZE + 1];  /* function name */
@@ -130,12 +332,12 @@ static search_result_t find_symbol(char *pattern)
 
     regex_t     regex_ptr;
     char        cpattern[MAX_SYMBOL_SIZE + 1];   /* compressed version of symbol pattern */
-    gboolean    use_regexp;
+    match_mode_t match_mode;
     search_result_t error;
 
 
     /*** Perform search initialization ***/
-    error = configure_search(pattern, &use_regexp, &regex_ptr, cpattern);
+    error = configure_search(pattern, ignore_case, truncate_symbols, &match_mode, &regex_ptr, cpattern);
 
     if (error != NOERROR) return(error);
 
@@ -144,7 +346,7 @@ static search_result_t find_symbol(char *pattern)
 
     read_ptr = cref_file_buf;
 
-    while (*read_ptr++ != '\t');            /* Skip the header, scan past the next tab char */
+    read_ptr = SCAN_past_tab(read_ptr);     /* Skip the header, scan past the next tab char */
     read_ptr++;                             /* Skip the file marker */
     get_string(file, &read_ptr);            /* Get the file name */
 
@@ -154,10 +356,7 @@ static search_result_t find_symbol(char *pattern)
     while (!done)
     {
         /* find the next symbol */
-        while (*read_ptr != '\n')
-        {
-            ++read_ptr;
-        }
+        read_ptr = SCAN_newline(read_ptr);
 
         ++read_ptr;
 
@@ -223,7 +422,7 @@ static search_result_t find_symbol(char *pattern)
         /*** Compare the search pattern to the selected symbol in the cross-reference.
              If a match is found, output the matching symbol info to the results file. ***/
 
-        if ( mega_match(&read_ptr, use_regexp, &regex_ptr, cpattern) )
+        if ( mega_match(&read_ptr, match_mode, &regex_ptr, cpattern) )
         {
             get_string(match_string, &tmp_ptr);
 
@@ -245,15 +444,12 @@ static search_result_t find_symbol(char *pattern)
             }
         }
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+        if ( search_cancelled() ) break;
     }
+    last_work.cref_bytes += read_ptr - cref_file_buf;
 
     /* Free memory allocated to the pattern buffer by the regcom() compiling process (performed in configure_search() */
-    if (use_regexp) regfree(&regex_ptr);
+    if (match_mode == MATCH_REGEXP) regfree(&regex_ptr);
 
     return(NOERROR);
 }
@@ -261,7 +457,7 @@ static search_result_t find_symbol(char *pattern)
 
 
 /* find the function definition or #define */
-static search_result_t find_def(char *pattern)
+static search_result_t find_def(char *pattern, gboolean ignore_case, gboolean truncate_symbols)
 {
     char        file[MAX_SYMBOL_SIZE + 1];  /* source file name */
 
@@ -270,12 +466,12 @@ static search_result_t find_def(char *pattern)
     gboolean    done = FALSE;
     regex_t     regex_ptr;
     char        cpattern[MAX_SYMBOL_SIZE + 1];   /* compressed version of symbol pattern */
-    gboolean    use_regexp;
+    match_mode_t match_mode;
     search_result_t error;
 
 
     /*** Perform search initialization ***/
-    error = configure_search(pattern, &use_regexp, &regex_ptr, cpattern);
+    error = configure_search(pattern, ignore_case, truncate_symbols, &match_mode, &regex_ptr, cpattern);
 
     if (error != NOERROR) return(error);
 
@@ -285,14 +481,14 @@ static search_result_t find_def(char *pattern)
     read_ptr = cref_file_buf;
 
     /* find the next file name */
-    while (*read_ptr++ != '\t');        /* Skip the header.  Scan past the next tab char */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header.  Scan past the next tab char */
     read_ptr++;                         /* Skip the file marker */
     get_string(file, &read_ptr);        /* Get the first file name */
 
     while (!done)
     {
         /* find the next scan token */
-        while (*read_ptr++ != '\t');
+        read_ptr = SCAN_past_tab(read_ptr);
 
         switch (*read_ptr)
         {
@@ -322,7 +518,7 @@ static search_result_t find_def(char *pattern)
             case UNIONDEF:
             case GLOBALDEF:     /* other global definition */
                 read_ptr++;     /* match name to pattern */
-                if ( mega_match(&read_ptr, use_regexp, &regex_ptr, cpattern) )
+                if ( mega_match(&read_ptr, match_mode, &regex_ptr, cpattern) )
                 {
                     /* output the file, function and source line */
                     putref(file, pattern, &read_ptr);
@@ -334,15 +530,12 @@ static search_result_t find_def(char *pattern)
             break;
         }
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+        if ( search_cancelled() ) break;
     }
+    last_work.cref_bytes += read_ptr - cref_file_buf;
 
     /* Free memory allocated to the pattern buffer by the regcom() compiling process (performed in configure_search() */
-    if (use_regexp) regfree(&regex_ptr);
+    if (match_mode == MATCH_REGEXP) regfree(&regex_ptr);
 
     return(NOERROR);
 }
@@ -361,14 +554,14 @@ static search_result_t find_all_functions()
     read_ptr = cref_file_buf;
 
     /* find the next file name */
-    while (*read_ptr++ != '\t');        /* Skip the header.  Scan past the next tab char */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header.  Scan past the next tab char */
     read_ptr++;                         /* Skip the file marker */
     get_string(file, &read_ptr);        /* Get the first file name */
 
     while (!done)
     {
         /* find the next scan token */
-        while (*read_ptr++ != '\t');
+        read_ptr = SCAN_past_tab(read_ptr);
 
         switch (*read_ptr)
         {
@@ -401,19 +594,17 @@ static search_result_t find_all_functions()
                 break;
         }
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+        if ( search_cancelled() ) break;
     }
+    last_work.cref_bytes += read_ptr - cref_file_buf;
+
     return(NOERROR);
 }
 
 
 
 /* find the functions called by this function */
-static search_result_t find_called_by(char *pattern)
+static search_result_t find_called_by(char *pattern, gboolean ignore_case, gboolean truncate_symbols)
 {
     char        file[MAX_SYMBOL_SIZE + 1];  /* source file name */
 
@@ -422,34 +613,47 @@ static search_result_t find_called_by(char *pattern)
     gboolean    done = FALSE;
     regex_t     regex_ptr;
     char        cpattern[MAX_SYMBOL_SIZE + 1];   /* compressed version of symbol pattern */
-    gboolean    use_regexp;
+    match_mode_t match_mode;
     search_result_t error;
 
 
     /*** Perform search initialization ***/
-    error = configure_search(pattern, &use_regexp, &regex_ptr, cpattern);
+    error = configure_search(pattern, ignore_case, truncate_symbols, &match_mode, &regex_ptr, cpattern);
 
     if (error != NOERROR) return(error);
 
-    /* Note: User provided regular expression and/or ignoreCase (use_regexp == TRUE) might match more than a */
+    /* Note: User provided regular expression and/or ignoreCase (match_mode != MATCH_BYTES) might match more than a */
     /*       single calling function. TF - 8/5/13 */
 
+    /* A single function: look up its calls in the call graph */
+    if ( (match_mode == MATCH_BYTES) && !truncate_symbols )
+    {
+        const cgraph_t      *graph = get_call_graph();
+        const cgraph_call_t *calls;
+        gint                id;
+        guint               i, num_calls;
+
+        if ( (id = CGRAPH_id(graph, pattern)) >= 0 )
+        {
+            num_calls = CGRAPH_callees(graph, id, &calls);
+            for (i = 0; i < num_calls; i++) put_call(graph, &calls[i]);
+        }
+        return(NOERROR);
+    }
+
     /*** Start the searching the cross-reference data ***/
 
     read_ptr = cref_file_buf;
 
     /* find the next file name */
-    while (*read_ptr++ != '\t');    /* Skip the header */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header */
     read_ptr++;                     /* Skip the file marker */
     get_string(file, &read_ptr);    /* Get the first file name */
 
     while (!done)
     {
         /* find the next symbol */
-        while (*read_ptr != '\n')
-        {
-            ++read_ptr;
-        }
+        read_ptr = SCAN_newline(read_ptr);
 
         ++read_ptr;
 
@@ -473,7 +677,7 @@ static search_result_t find_called_by(char *pattern)
 
                 case FCNDEF:
                     read_ptr++;  /* match name to pattern */
-                    if ( mega_match(&read_ptr, use_regexp, &regex_ptr, cpattern) )
+                    if ( mega_match(&read_ptr, match_mode, &regex_ptr, cpattern) )
                     {
                         find_called_by_sub(file, &read_ptr);
                     }
@@ -485,15 +689,12 @@ static search_result_t find_called_by(char *pattern)
             }
         }
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+        if ( search_cancelled() ) break;
     }
+    last_work.cref_bytes += read_ptr - cref_file_buf;
 
     /* Free memory allocated to the pattern buffer by the regcom() compiling process (performed in configure_search() */
-    if (use_regexp) regfree(&regex_ptr);
+    if (match_mode == MATCH_REGEXP) regfree(&regex_ptr);
 
     return(NOERROR);
 }
@@ -508,7 +709,7 @@ static void find_called_by_sub(char *file, char **src)
     while (!done)
     {
         /* find the next function call or the end of this function */
-        while ( *(*src)++ != '\t');
+        *src = SCAN_past_tab(*src);
 
         switch ( *(*src) )
         {
@@ -534,7 +735,7 @@ static void find_called_by_sub(char *file, char **src)
 
 
 /* find the functions calling this function */
-static search_result_t find_calling(char *pattern)
+static search_result_t find_calling(char *pattern, gboolean ignore_case, gboolean truncate_symbols)
 {
     char        file[MAX_SYMBOL_SIZE + 1];     /* source file name */
     char        function[MAX_SYMBOL_SIZE + 1];  /* function name */
@@ -545,15 +746,31 @@ static search_result_t find_calling(char *pattern)
     gboolean    done = FALSE;
     regex_t     regex_ptr;
     char        cpattern[MAX_SYMBOL_SIZE + 1];   /* compressed version of symbol pattern */
-    gboolean    use_regexp;
+    match_mode_t match_mode;
     search_result_t error;
 
 
     /*** Perform search initialization ***/
-    error = configure_search(pattern, &use_regexp, &regex_ptr, cpattern);
+    error = configure_search(pattern, ignore_case, truncate_symbols, &match_mode, &regex_ptr, cpattern);
 
     if (error != NOERROR) return(error);
 
+    /* A single function: look up the calls to it in the call graph */
+    if ( (match_mode == MATCH_BYTES) && !truncate_symbols )
+    {
+        const cgraph_t      *graph = get_call_graph();
+        const cgraph_call_t *calls;
+        gint                id;
+        guint               i, num_calls;
+
+        if ( (id = CGRAPH_id(graph, pattern)) >= 0 )
+        {
+            num_calls = CGRAPH_callers(graph, id, &calls);
+            for (i = 0; i < num_calls; i++) put_call(graph, &calls[i]);
+        }
+        return(NOERROR);
+    }
+
 
     /*** Start the searching the cross-reference data ***/
 
@@ -563,7 +780,7 @@ static search_result_t find_calling(char *pattern)
     *macro = '\0';
 
     /* find the next file name */
-    while (*read_ptr++ != '\t');    /* Skip the header */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header */
     read_ptr++;                     /* Skip the file marker */
     get_string(file, &read_ptr);    /* Get the first file name */
 
@@ -572,7 +789,7 @@ static search_result_t find_calling(char *pattern)
     while (!done)
     {
         /* Find the next scan token */
-        while (*read_ptr++ != '\t');
+        read_ptr = SCAN_past_tab(read_ptr);
 
         switch (*read_ptr)
         {
@@ -612,7 +829,7 @@ static search_result_t find_calling(char *pattern)
 
             case FCNCALL:       /* match function called to pattern */
                 read_ptr++;
-                if ( mega_match(&read_ptr, use_regexp, &regex_ptr, cpattern) )
+                if ( mega_match(&read_ptr, match_mode, &regex_ptr, cpattern) )
                 {
                     /* output the file, calling function or macro, and source */
                     if (*macro != '\0')
@@ -631,215 +848,366 @@ static search_result_t find_calling(char *pattern)
             break;
         }
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+        if ( search_cancelled() ) break;
     }
+    last_work.cref_bytes += read_ptr - cref_file_buf;
 
     /* Free memory allocated to the pattern buffer by the regcom() compiling process (performed in configure_search() */
-    if (use_regexp) regfree(&regex_ptr);
+    if (match_mode == MATCH_REGEXP) regfree(&regex_ptr);
 
     return(NOERROR);
 }
 
 
 
-/* find the text in the source files */
-
-static search_result_t find_string(char *pattern)
+/*
+ * find the functions reachable from a function:  "<function> [calls]"
+ * Each function is listed (like a FIND_CALLEDBY match) at the call that first reaches it, nearest first.
+ */
+static search_result_t find_reachable(char *pattern)
 {
-    uint32_t    i;
-    regex_t     regex_ptr;
-    char        new_pattern[MAX_SYMBOL_SIZE * 2];
+    char                function[MAX_SYMBOL_SIZE + 1];
+    guint               depth = REACH_DEPTH;
+    const cgraph_t      *graph;
+    GPtrArray           *calls;
+    gint                id;
+    guint               i;
 
-    char        *file;
-    char        *write_ptr;
-    char        *read_ptr;
+    if ( (sscanf(pattern, "%1024s %u", function, &depth) < 1) || !is_symbol(function) )
+        return(NOTSYMBOL);
 
+    graph = get_call_graph();
+    if ( (id = CGRAPH_id(graph, function)) < 0 ) return(NOERROR);
 
-    /*** Set up the search ***/
+    calls = CGRAPH_reachable(graph, id, depth);
+    for (i = 0; i < calls->len; i++) put_call(graph, g_ptr_array_index(calls, i));
+    g_ptr_array_free(calls, TRUE);
 
-    if ( is_regexp(pattern) )
+    return(NOERROR);
+}
+
+
+
+/*
+ * find the call paths from one function to another:  "<from function> <to function> [max calls]"
+ * Each path is listed as its calls (like FIND_CALLEDBY matches), in order.  Every path ends with a call to <to function>.
+ */
+static search_result_t find_call_paths(char *pattern)
+{
+    char                from[MAX_SYMBOL_SIZE + 1];
+    char                to[MAX_SYMBOL_SIZE + 1];
+    guint               depth = PATH_DEPTH;
+    const cgraph_t      *graph;
+    GPtrArray           *calls;
+    gint                from_id, to_id;
+    guint               i;
+
+    if ( (sscanf(pattern, "%1024s %1024s %u", from, to, &depth) < 2) || !is_symbol(from) || !is_symbol(to) )
+        return(NOTSYMBOL);
+
+    graph = get_call_graph();
+    if ( ((from_id = CGRAPH_id(graph, from)) < 0) || ((to_id = CGRAPH_id(graph, to)) < 0) ) return(NOERROR);
+
+    calls = CGRAPH_paths(graph, from_id, to_id, depth, MAX_CALL_PATHS);
+    for (i = 0; i < calls->len; i++)
     {
-        /* Escape all regular expression special charactes */
-        write_ptr = new_pattern;
-        for (read_ptr = pattern; *read_ptr != '\0'; ++read_ptr)
-        {
-            if (strchr("^.*[]{}()\\$?+|", *read_ptr) != NULL)
-            {
-                *write_ptr++ = '\\';
-            }
-            *write_ptr++ = *read_ptr;
-        }
-        *write_ptr = '\0';
+        if ( g_ptr_array_index(calls, i) ) put_call(graph, g_ptr_array_index(calls, i));
     }
-    else
+    g_ptr_array_free(calls, TRUE);
+
+    return(NOERROR);
+}
+
+
+
+/* Return the call graph of the cross-reference, building it if necessary.  Caller must hold the engine lock. */
+static const cgraph_t *get_call_graph()
+{
+    if ( !call_graph )
     {
-        strcpy(new_pattern, pattern);
+        search_status("Building the call graph ...");
+        cref_advise(MADV_SEQUENTIAL);
+        call_graph = CGRAPH_build(cref_file_buf);
+        cref_advise(MADV_NORMAL);
+        last_work.cref_bytes += cref_file_size;
     }
 
-    /* This search utilizes regexec() even if there are no metacharacters in the user-provided search pattern. */
-    /* allow a match anywhere inside the string */
-    if (regcomp (&regex_ptr, new_pattern, REG_EXTENDED | REG_NOSUB | (settings.ignoreCase ? REG_ICASE : 0) ) != 0)
-        return(REGCMPERROR);
+    return(call_graph);
+}
 
-    /*** Perform the search ***/
 
-    for (i = 0; i < nsrcfiles; ++i)
+
+/*
+ * find the files that #include a file, directly or indirectly:  "<file> [levels]"
+ * <file> is a file name, or the trailing part of one [e.g. "foo.h" for "include/foo.h"].  Each
+ * file is listed once, at the #include through which it was first reached, direct includers first.
+ */
+static search_result_t find_includers(char *pattern)
+{
+    char                file[MAX_SYMBOL_SIZE + 1];
+    guint               depth = INCLUDE_DEPTH;
+    const incgraph_t    *graph;
+    GArray              *files;
+    GPtrArray           *includes;
+    const incgraph_include_t *include;
+    char                *src;
+    guint               i;
+
+    if (sscanf(pattern, "%1024s %u", file, &depth) < 1)
+        return(NOTSYMBOL);
+
+    graph = get_include_graph();
+    files = INCGRAPH_match(graph, file);
+
+    includes = INCGRAPH_affected(graph, files, depth);
+    for (i = 0; i < includes->len; i++)
     {
-        file = DIR_src_files[i];
-        progress(i, nsrcfiles);
+        include = g_ptr_array_index(includes, i);
+        src = cref_file_buf + include->site;
+        putref( (char *) INCGRAPH_file(graph, include->file), global, &src );
+    }
+    g_ptr_array_free(includes, TRUE);
+    g_array_free(files, TRUE);
+
+    return(NOERROR);
+}
+
+
+
+/*
+ * find the definitions in a file:  "<file>"
+ * Only the file's own section of the cross-reference is read.  Each definition is listed [in
+ * the order it appears in the file] with the defined name in the function column.
+ */
+static search_result_t find_outline(char *pattern)
+{
+    char        name[MAX_SYMBOL_SIZE + 1];
+    char        *section;
+    char        *read_ptr;
+    char        *s;
+
+    /* remove leading and trailing white space */
+    while (isspace(*pattern)) pattern++;
+    for (s = pattern + strlen(pattern) - 1; (s >= pattern) && isspace(*s); --s) *s = '\0';
 
-        match_file(file, regex_ptr, "%s|<unknown> %ld %s\n");
+    if ( (section = read_ptr = get_file_section(pattern)) == NULL ) return(NOERROR);
+
+    for (;;)
+    {
+        /* find the next scan token */
+        read_ptr = SCAN_past_tab(read_ptr);
 
-        if (cancel_search)
+        switch (*read_ptr)
         {
-            cancel_search = FALSE;
+            case NEWFILE:       /* The end of the file's section */
+                last_work.cref_bytes += read_ptr - section;
+                return(NOERROR);
+
+            case DEFINE:
+            case FCNDEF:
+            case CLASSDEF:
+            case ENUMDEF:
+            case MEMBERDEF:
+            case STRUCTDEF:
+            case TYPEDEF:
+            case UNIONDEF:
+            case GLOBALDEF:
+                read_ptr++;
+                get_string(name, &read_ptr);
+                if (*name != '\0')
+                {
+                    /* output the file, definition and source line */
+                    putref(pattern, name, &read_ptr);
+                }
+            break;
+
+            default:
+                /* do nothing */
             break;
         }
+
+        if ( search_cancelled() ) break;
     }
 
-    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
     return(NOERROR);
 }
 
 
 
+/*
+ * Return the start of <file>'s section of the cross-reference [just past the file name], or NULL
+ * if the file is not in the cross-reference.  The table of sections is collected on first use
+ * and kept until the next database is loaded.  Caller must hold the engine lock.
+ */
+static char *get_file_section(const char *file)
+{
+    char        name[MAX_SYMBOL_SIZE + 1];
+    char        *read_ptr;
+    gsize       offset;
 
+    if ( !file_sections )
+    {
+        search_status("Indexing the cross-reference files ...");
+        cref_advise(MADV_SEQUENTIAL);
 
-/* find this regular expression in the source files */
+        file_sections = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 
-static search_result_t find_regexp(char *pattern)
-{
-    uint32_t    i;
-    regex_t     regex_ptr;
-    char        *file;
+        read_ptr = cref_file_buf;
+        read_ptr = SCAN_past_tab(read_ptr);     /* Skip the header, scan past the next tab char */
+        read_ptr++;                             /* Skip the file marker */
+        get_string(name, &read_ptr);            /* Get the first file name */
 
-    /* This search utilizes regexec() even if there are no metacharacters in the user-provided search pattern. */
-    /* allow a match anywhere inside the string */
-    if (regcomp (&regex_ptr, pattern, REG_EXTENDED | REG_NOSUB | (settings.ignoreCase ? REG_ICASE : 0) ) != 0)
-        return(REGCMPERROR);
+        while (*name != '\0')                  /* An empty file name marks the end of the symbols */
+        {
+            /* A file listed twice keeps its first section */
+            if ( !g_hash_table_contains(file_sections, name) )
+                g_hash_table_insert(file_sections, g_strdup(name), GSIZE_TO_POINTER(read_ptr - cref_file_buf + 1));
 
-    /*** Perform the search ***/
+            read_ptr = SCAN_past_mark(read_ptr, NEWFILE);   /* Every file boundary, as in DIR_create_offset_hash() */
+            get_string(name, &read_ptr);
+        }
 
-    for (i = 0; i < nsrcfiles; ++i)
-    {
-        file = DIR_src_files[i];
-        progress(i, nsrcfiles);
+        cref_advise(MADV_NORMAL);
+        last_work.cref_bytes += read_ptr - cref_file_buf;
+    }
 
-        match_file(file, regex_ptr, "%s|<unknown> %ld %s\n");
+    offset = GPOINTER_TO_SIZE( g_hash_table_lookup(file_sections, file) );
+    return( offset ? cref_file_buf + offset - 1 : NULL );
+}
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+
+
+/* Return the #include graph of the cross-reference, building it if necessary.  Caller must hold the engine lock. */
+static const incgraph_t *get_include_graph()
+{
+    if ( !include_graph )
+    {
+        search_status("Building the #include graph ...");
+        cref_advise(MADV_SEQUENTIAL);
+        include_graph = INCGRAPH_build(cref_file_buf);
+        cref_advise(MADV_NORMAL);
+        last_work.cref_bytes += cref_file_size;
     }
 
-    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
-    return(NOERROR);
+    return(include_graph);
 }
 
 
 
-/* find matching file names */
-static search_result_t find_file(char *pattern)
+/* put a call from the call graph into the results file */
+static void put_call(const cgraph_t *graph, const cgraph_call_t *call)
 {
-    uint32_t    i;
-    uint32_t    searchcount = 0;
-    regex_t     regex_ptr;
-    char        *s;
+    char *src = cref_file_buf + call->site;
 
-    /* remove trailing white space */
-    for (s = pattern + strlen(pattern) - 1; isspace(*s); --s) *s = '\0';
+    putref( (char *) CGRAPH_file(graph, call->file), (char *) CGRAPH_name(graph, call->name), &src );
+}
 
-    /* This searches utilize regexec() even if there are no metacharacters in the search pattern. */
-    /* allow a match anywhere inside the string */
-    if (regcomp (&regex_ptr, pattern, REG_EXTENDED | REG_NOSUB | (settings.ignoreCase ? REG_ICASE : 0) ) != 0)
-        return(REGCMPERROR);
 
 
-    for (i = 0; i < nsrcfiles; ++i)
+/* Look up the calls of each batched function (the first pattern of each group) in the call graph */
+static void find_batch_in_graph(search_t search_operation, gchar **patterns, guint count, gint *group_of,
+                                batch_group_t *groups, guint num_groups)
+{
+    const cgraph_t      *graph = get_call_graph();
+    const cgraph_call_t *calls;
+    gboolean            *found;
+    char                *src;
+    gint                id;
+    guint               i, j, num_calls;
+
+    found = g_new0(gboolean, num_groups);
+
+    for (i = 0; i < count; i++)
     {
-        s = DIR_src_files[i];
-        if (regexec (&regex_ptr, s, (size_t)0, NULL, 0) == 0)
-        {
-            fprintf(refsfound, "%s|<unknown> 1 <unknown>\n", DIR_src_files[i]);
-            imatch_count++;
-        }
+        if ( (group_of[i] < 0) || found[group_of[i]] ) continue;
+        found[group_of[i]] = TRUE;
 
-        if (cancel_search)
+        if ( (id = CGRAPH_id(graph, patterns[i])) < 0 ) continue;
+
+        if (search_operation == FIND_CALLING)
+            num_calls = CGRAPH_callers(graph, id, &calls);
+        else
+            num_calls = CGRAPH_callees(graph, id, &calls);
+
+        for (j = 0; j < num_calls; j++)
         {
-            cancel_search = FALSE;
-            break;
+            src = cref_file_buf + calls[j].site;
+            batch_putref(&groups[group_of[i]], (char *) CGRAPH_file(graph, calls[j].file),
+                         (char *) CGRAPH_name(graph, calls[j].name), &src);
         }
-
-        searchcount++;
-        progress(searchcount, nsrcfiles);
     }
 
-    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
-    return(NOERROR);
+    g_free(found);
 }
 
 
 
-/* find files #including this file */
-static search_result_t find_include(char *pattern)
+/* find the functions calling any of the batched functions (one pass for the whole batch) */
+static void find_calling_batch(symset_t *names, batch_group_t *groups)
 {
-    char        file[MAX_SYMBOL_SIZE + 1];  /* source file name */
-    uint32_t    searchcount = 0;
+    char        file[MAX_SYMBOL_SIZE + 1];      /* source file name */
+    char        function[MAX_SYMBOL_SIZE + 1];  /* function name */
+    char        macro[MAX_SYMBOL_SIZE + 1];     /* macro name */
+
     char        *read_ptr;
     gboolean    done = FALSE;
-    char        *s;
-    regex_t     regex_ptr;
-
-    /* remove trailing white space */
-    for (s = pattern + strlen(pattern) - 1; isspace(*s); --s) *s = '\0';
-
-    /* This search utilizes regexec() for all search patterns */
-    /* allow a match anywhere inside the string */
-    if (regcomp (&regex_ptr, pattern, REG_EXTENDED | REG_NOSUB | (settings.ignoreCase ? REG_ICASE : 0) ) != 0)
-        return(REGCMPERROR);
+    gint        index;
 
     read_ptr = cref_file_buf;
 
-    /* find the next source file name or #include */
-    while (*read_ptr++ != '\t');    /* Skip the header, Scan past the next tab char */
+    /* If the function call is from a macro, report the host 'macro' as the calling function */
+    *macro = '\0';
+
+    /* find the next file name */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header */
     read_ptr++;                     /* Skip the file marker */
     get_string(file, &read_ptr);    /* Get the first file name */
 
+    function[0] = '\0';
+
     while (!done)
     {
         /* Find the next scan token */
-        while (*read_ptr++ != '\t');
+        read_ptr = SCAN_past_tab(read_ptr);
 
         switch (*read_ptr)
         {
-
             case NEWFILE:       /* save file name */
                 read_ptr++;
                 get_string(file, &read_ptr);
 
-                /* Check for end of symbols */
+                /* Check for the end of the symbols */
                 if (*file == '\0')
                 {
                     done = TRUE;
                     continue;
                 }
-                searchcount++;
-                progress(searchcount, nsrcfiles);
+                (void) strcpy(function, global);
             break;
 
-            case INCLUDE:
+            case DEFINE:        /* could be a macro */
                 read_ptr++;
-                read_ptr++;  /* skip global or local #include marker '<' or '"' */
-                if (match_regex(&read_ptr, regex_ptr))
+                get_string(macro, &read_ptr);
+            break;
+
+            case DEFINEEND:
+                *macro = '\0';
+            break;
+
+            case FCNDEF:        /* save calling function name */
+                read_ptr++;
+                get_string(function, &read_ptr);
+            break;
+
+            case FCNEND:
+                function[0] = '\0';
+            break;
+
+            case FCNCALL:       /* is the called function one of ours? */
+                read_ptr++;
+                if ( (index = SYMSET_match(names, &read_ptr)) >= 0 )
                 {
-                    /* output the file and source line */
-                    putref(file, global, &read_ptr);
+                    batch_putref(&groups[index], file, (*macro != '\0') ? macro : function, &read_ptr);
                 }
             break;
 
@@ -848,97 +1216,117 @@ static search_result_t find_include(char *pattern)
             break;
         }
 
-        if (cancel_search)
-        {
-            cancel_search = FALSE;
-            break;
-        }
+        if ( search_cancelled() ) break;
     }
-
-    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
-    return(NOERROR);
 }
 
 
 
-static gboolean is_regexp(char *pattern)
+/* find the functions called by any of the batched functions (one pass for the whole batch) */
+static void find_called_by_batch(symset_t *names, batch_group_t *groups)
 {
-    char *work_ptr;
-    gboolean isregexp = FALSE;
+    char        file[MAX_SYMBOL_SIZE + 1];      /* source file name */
+    char        function[MAX_SYMBOL_SIZE + 1];  /* called function name */
 
-    work_ptr = pattern;
+    char            *read_ptr;
+    gboolean        done = FALSE;
+    gboolean        in_function;
+    batch_group_t   *group;
+    gint            index;
 
-    while ( (!isregexp) && (*work_ptr != '\0') )
-    {
-        isregexp = (strchr("^.*[{(\\$?+|", *work_ptr) != NULL );
-        work_ptr++;
-    }
+    read_ptr = cref_file_buf;
 
-    return(isregexp);
-}
+    /* find the next file name */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header */
+    read_ptr++;                     /* Skip the file marker */
+    get_string(file, &read_ptr);    /* Get the first file name */
 
+    while (!done)
+    {
+        /* find the next symbol */
+        read_ptr = SCAN_newline(read_ptr);
 
+        ++read_ptr;
 
-/* match the pattern to the string */
-static gboolean match_regex(char **src, regex_t regex_ptr)
-{
-    char    string[MAX_SYMBOL_SIZE + 1];
+        if (*read_ptr == '\t')
+        {
+            switch ( *(++read_ptr) )
+            {
+                case NEWFILE:
+                    read_ptr++;  /* save file name */
+                    get_string(file, &read_ptr);
 
-    get_string(string, src);
-    if (*string == '\0')
-    {
-        return(FALSE);
-    }
+                    /* Check for the end of the symbols */
+                    if (*file == '\0')
+                    {
+                        done = TRUE;
+                        continue;
+                    }
+                break;
 
-    return(regexec (&regex_ptr, string, (size_t)0, NULL, 0) ? FALSE : TRUE);
-}
+                case FCNDEF:
+                    read_ptr++;
+                    if ( (index = SYMSET_match(names, &read_ptr)) < 0 ) break;
+                    group = &groups[index];
 
+                    /* Same as find_called_by_sub(), but reporting to this pattern's group */
+                    in_function = TRUE;
+                    while (in_function)
+                    {
+                        read_ptr = SCAN_past_tab(read_ptr);
 
+                        switch (*read_ptr)
+                        {
+                            case FCNCALL:
+                                read_ptr++;
+                                get_string(function, &read_ptr);
+                                batch_putref(group, file, function, &read_ptr);
+                            break;
 
-static gboolean match_bytes(char **src_ptr, char *cpattern)
-{
-    int i = 1;
-    char *match_ptr = *src_ptr;
+                            case FCNEND:
+                            case NEWFILE:
+                                in_function = FALSE;
+                            break;
 
-    while (*match_ptr == cpattern[i])
-    {
-        ++match_ptr;
-        ++i;
-    }
+                            default:
+                                /* do nothing */
+                            break;
+                        }
+                    }
+                break;
 
-    *src_ptr = match_ptr;
-    if (*match_ptr == '\n' && cpattern[i] == '\0')
-    {
-        return(TRUE);
+                default:
+                    /* do nothing */
+                break;
+            }
+        }
+
+        if ( search_cancelled() ) break;
     }
-    return(FALSE);
 }
 
 
 
-/* put the reference into the file */
-static void putref(char *file, char *func, char **src)
+/* put the reference into the batched pattern's output */
+static void batch_putref(batch_group_t *group, char *file, char *func, char **src)
 {
-    FILE    *output;
+    int i = (strcmp(func, global) == 0) ? 0 : 1;
 
-    imatch_count++;
-
-    if (strcmp(func, global) == 0)
-    {
-        output = refsfound;
-    }
-    else
+    if ( !group->output[i] )
     {
-        output = nonglobalrefs;
+        if ( (group->output[i] = open_memstream(&group->buf[i], &group->size[i])) == NULL )
+        {
+            fprintf(stderr, "Error: Unable to allocate memory for batched search results\n");
+            exit(EXIT_FAILURE);
+        }
     }
-    (void) fprintf(output, "%s|%s ", file, func);
 
-    if ( !putsource(output, src) )
+    (void) fprintf(group->output[i], "%s|%s ", file, func);
+
+    if ( !putsource(group->output[i], src) )
     {
         fprintf(stderr,"\nGscope Internal error: cannot get source line from database\n\n");
-        fprintf(stderr,"This failure is typically caused by a file using non-UNIX newline format.\n");
         fprintf(stderr,"Problem file: %s\n", file);
-        fprintf(stderr,"Fix the newline format of this file to correct this failure.\n");
         SEARCH_cleanup();
         exit(EXIT_FAILURE);
     }
@@ -946,424 +1334,1575 @@ static void putref(char *file, char *func, char **src)
 
 
 
-/* put the source line into the file */
-static gboolean putsource(FILE *output, char **src_ptr)
+/* Convert a batched pattern's output into a search results structure */
+static void batch_results(batch_group_t *group, search_results_t *results)
 {
-    char     *cp;
-    char     nextc = '\0';
+    gchar   *work_ptr;
+    int     i;
 
-    cp = *src_ptr;
-
-    /* scan back to the beginning of the source line (double-newline chars) */
-    while (*cp != '\n' || nextc != '\n')
+    for (i = 0; i < 2; i++)
     {
-        nextc = *cp;
-        --cp;
+        if (group->output[i]) fclose(group->output[i]);     /* Finalizes buf[i] and size[i] */
     }
-    if (*cp != '\n' || *(++cp) != '\n' || !isdigit(*(++cp)) )
+
+    results->match_count = 0;
+    if (group->size[0] + group->size[1] == 0)
     {
-        return(FALSE);
+        results->start_ptr = NULL;
+        results->end_ptr   = NULL;
     }
-
-    /* A double newline followed by a single digit [0..9] is found */
-    do
+    else
     {
-        /* skip a symbol type */
-        if (*cp == '\t')
+        results->start_ptr = g_malloc(group->size[0] + group->size[1]);
+        memcpy(results->start_ptr, group->buf[0], group->size[0]);
+        memcpy(results->start_ptr + group->size[0], group->buf[1], group->size[1]);
+        results->end_ptr = results->start_ptr + group->size[0] + group->size[1];
+
+        for (work_ptr = results->start_ptr; work_ptr != results->end_ptr; work_ptr++)
         {
-            cp += 2;;
+            if (*work_ptr == '\n') results->match_count++;
         }
-        *src_ptr = cp;
-
-        /* output a piece of the source line */
-        putline(output, &cp);
-    } while (*(++cp) != '\n');  /* until a double newline is found */
-
-    (void) putc('\n', output);
-    *src_ptr = cp;
+    }
 
-    return(TRUE);
+    free(group->buf[0]);    /* open_memstream() buffers come from malloc() */
+    free(group->buf[1]);
 }
 
 
 
-/* put the rest of the cross-reference line into the file */
-static void putline(FILE *output, char **src_ptr)
+/* find the text in the source files */
+
+static search_result_t find_string(char *pattern, gboolean ignore_case)
 {
-    char    *line_ptr = *src_ptr;
-    unsigned c;
+    uint32_t    i;
+    regex_t     regex_ptr;
+    char        new_pattern[MAX_SYMBOL_SIZE * 2];
+    char        literal_buf[MAX_SYMBOL_SIZE * 2];
+    const char  *literal;
 
-    while ((c = (unsigned)(*line_ptr)) != '\n')
-    {
+    char        *file;
+    char        *write_ptr;
+    char        *read_ptr;
 
-        /* check for a compressed digraph */
-        if (c > 0x7f)
-        {
-            c &= 0x7f;
-            (void) putc(dichar1[c / 8], output);
-            (void) putc(dichar2[c & 7], output);
-        }
-        /* check for a compressed keyword */
-        else if (c < ' ')
+
+    /*** Set up the search ***/
+
+    if ( is_regexp(pattern) )
+    {
+        /* Escape all regular expression special charactes */
+        write_ptr = new_pattern;
+        for (read_ptr = pattern; *read_ptr != '\0'; ++read_ptr)
         {
-            (void) fputs(keyword[c].text, output);
-            if (keyword[c].delim != '\0')
-            {
-                (void) putc(' ', output);
-            }
-            if (keyword[c].delim == '(')
+            if (strchr("^.*[]{}()\\$?+|", *read_ptr) != NULL)
             {
-                (void) putc('(', output);
+                *write_ptr++ = '\\';
             }
+            *write_ptr++ = *read_ptr;
         }
-        else
-        {
-            (void) putc((int) c, output);
-        }
-        ++line_ptr;
+        *write_ptr = '\0';
+    }
+    else
+    {
+        strcpy(new_pattern, pattern);
     }
-    *src_ptr = line_ptr;    /* Return the new read-pointer value */
-}
 
+    /* This search utilizes regexec() even if there are no metacharacters in the user-provided search pattern. */
+    /* allow a match anywhere inside the string */
+    if (regcomp (&regex_ptr, new_pattern, REG_EXTENDED | REG_NOSUB | (ignore_case ? REG_ICASE : 0) ) != 0)
+        return(REGCMPERROR);
 
+    /* ...but only on the lines that contain the string */
+    literal = required_literal(new_pattern, literal_buf, ignore_case);
 
-/* put the rest of the cross-reference line into the string */
-static void get_string(char *dest, char **src)
-{
-    uint8_t     byte;
-    char        *src_ptr = *src;
-    guint       byte_count = 0;
-    char        *start = dest;
-    gboolean    truncated = FALSE;
+    /*** Perform the search ***/
 
-    while ( (byte = (unsigned) (*src_ptr)) != '\n' )
+    for (i = 0; i < nsrcfiles; ++i)
     {
-        if (byte > 0x7f)
-        {
-            if (byte_count + 2 > MAX_SYMBOL_SIZE)
-            {
-                truncated = TRUE;
-                break;    // The dicode expansion would overrun our buffer, so truncate
-            }
+        file = DIR_src_files[i];
+        progress(i, nsrcfiles);
 
-            byte   &= 0x7f;
-            *dest++ = dichar1[byte / 8];
-            *dest++ = dichar2[byte & 7];
-            byte_count += 2;
-        }
-        else
-        {
-            *dest++ = byte;
-            byte_count++;
-        }
-        src_ptr++;
+        match_file(file, regex_ptr, literal, "%s|<unknown> %ld %s\n");
 
-        if (byte_count == MAX_SYMBOL_SIZE)
-        {
-            truncated = TRUE;
-            break;   // The buffer is full, so truncate
-        }
+        if ( search_cancelled() ) break;
     }
-    *dest++ = '\0';    // Null-terminate the extracted string
 
-    if (truncated)
-    {
-        fprintf(stderr, "Warning: Unusually large (> %d bytes) symbol encountered.  Symbol Truncated to:\n    %s\n"
-                       "Pattern Matches for the non-truncated version of this symbol will fail.\n"
-                       "If this is a problem, request a new Gscope build with a larger MAX_SYMBOL_SIZE limit.\n",
-               MAX_SYMBOL_SIZE,
-               start);
-    }
-    *src = src_ptr;    // Update the caller's copy of the source pointer.
+    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
+    return(NOERROR);
 }
 
 
 
-/* initialize the progress message */
-static void initprogress()
-{
-    imatch_count = 0;
-}
 
 
+/* find this regular expression in the source files */
 
-/* Periodically display the search progress */
-static void progress(uint32_t n1, uint32_t n2)
+static search_result_t find_regexp(char *pattern, gboolean ignore_case)
 {
-    static time_t       starttime = 0; 
-    time_t              now = 0;
-    char                *msg;
-    static GtkWidget    *progress_bar = NULL;
-    static char format[] = "Searched %ld of %ld files [%ld matches]";
+    uint32_t    i;
+    regex_t     regex_ptr;
+    char        *file;
+    char        *literal_buf;
+    const char  *literal;
+
+    /* This search utilizes regexec() even if there are no metacharacters in the user-provided search pattern. */
+    /* allow a match anywhere inside the string */
+    if (regcomp (&regex_ptr, pattern, REG_EXTENDED | REG_NOSUB | (ignore_case ? REG_ICASE : 0) ) != 0)
+        return(REGCMPERROR);
 
-    if ( !progress_bar )
-        progress_bar = CALLBACKS_get_widget("progressbar1");
+    /* Only lines containing the literal text every match requires (if any) need to be checked */
+    literal_buf = g_malloc(strlen(pattern) + 1);
+    literal = required_literal(pattern, literal_buf, ignore_case);
+
+    /*** Perform the search ***/
 
-    /* Update every 1 second */
-    now = time((time_t *) NULL);
-    
-    if ( (now - starttime) >= 1 )
+    for (i = 0; i < nsrcfiles; ++i)
     {
-        starttime = now;
-        my_asprintf(&msg, format, n1, n2, imatch_count);
-        DISPLAY_status(msg);
-        DISPLAY_progress(progress_bar, NULL, n1, n2);
-        g_free(msg);
+        file = DIR_src_files[i];
+        progress(i, nsrcfiles);
+
+        match_file(file, regex_ptr, literal, "%s|<unknown> %ld %s\n");
+
+        if ( search_cancelled() ) break;
     }
+
+    g_free(literal_buf);
+    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
+    return(NOERROR);
 }
 
 
 
-/* Perform a periodic cross-reference update check */
-static void periodic_check_cref()
+/* find matching file names */
+static search_result_t find_file(char *pattern, gboolean ignore_case)
 {
-    static gboolean     initialized = FALSE;
-    static time_t       last_check_time = 0;
+    uint32_t        i;
+    regex_t         regex_ptr;
+    char            *s;
+    char            *literal;
+    const char      *required;
+    pathidx_match_t match;
+    GArray          *files;
+    GArray          *candidates;
 
-    time_t now;
+    /* remove trailing white space */
+    for (s = pattern + strlen(pattern) - 1; isspace(*s); --s) *s = '\0';
 
-    if ( !initialized )
+    literal = g_malloc(strlen(pattern) + 1);
+
+    if ( literal_path_pattern(pattern, literal, &match) )
     {
-        last_check_time = time( (time_t *) NULL);
-        initialized = TRUE;
+        /* Plain text [optionally anchored]: answer from the index, without a regex */
+        files = PATHIDX_lookup(get_path_index(), literal, match, ignore_case);
     }
+    else
+    {
+        /* This searches utilize regexec() even if there are no metacharacters in the search pattern. */
+        /* allow a match anywhere inside the string */
+        if (regcomp (&regex_ptr, pattern, REG_EXTENDED | REG_NOSUB | (ignore_case ? REG_ICASE : 0) ) != 0)
+        {
+            g_free(literal);
+            return(REGCMPERROR);
+        }
+        regfree(&regex_ptr);    /* Only compiled to check the pattern:  each scan thread compiles its own copy */
 
-    now = time( (time_t *) NULL);
+        /* Only the files containing the pattern's required text [if any] need to be checked */
+        required   = required_literal(pattern, literal, ignore_case);
+        candidates = required ? PATHIDX_candidates(get_path_index(), required) : NULL;
 
-    if (now - last_check_time > (15 * 60) )  // if we haven't checked the cref in the last 15 minutes
+        files = match_paths(pattern, candidates, ignore_case);
+        if (candidates) g_array_free(candidates, TRUE);
+    }
+
+    for (i = 0; i < files->len; ++i)
     {
-        last_check_time = time( (time_t *) NULL);
-        SEARCH_check_cref();
+        fprintf(refsfound, "%s|<unknown> 1 <unknown>\n", DIR_src_files[g_array_index(files, guint, i)]);
+        imatch_count++;
+        stream_check();
+
+        if ( search_cancelled() ) break;
     }
+    progress(nsrcfiles, nsrcfiles);
+
+    g_array_free(files, TRUE);
+    g_free(literal);
+    return(NOERROR);
 }
 
 
 
-/* open the references found file for writing */
-static gboolean writerefsfound()
+/* Return the index of the source file list, building it if necessary.  Caller must hold the engine lock. */
+static const pathidx_t *get_path_index()
 {
-    if (refsfound == NULL)
-    {
-        if ((refsfound = fopen(temp1, "w")) == NULL)
-        {
-            my_cannotopen(temp1);
-            return(FALSE);
-        }
-    }
-    else if (freopen(temp1, "w", refsfound) == NULL)
+    if ( !path_index || (PATHIDX_size(path_index) != nsrcfiles) )
     {
-        fprintf(stderr, "Cannot open temporary file\n");
-        return(FALSE);
+        search_status("Indexing the source file names ...");
+        PATHIDX_free(path_index);
+        path_index = PATHIDX_build(DIR_src_files, nsrcfiles);
     }
-    return(TRUE);
+
+    return(path_index);
 }
 
 
 
-/*****************************************************************************/
-/*** Open the search results file and read the entire contents into memory ***/
-/***                                                                       ***/
-/*** This function mallocs memory, caller is responsible for freeing the   ***/
-/*** allocated buffer.                                                     ***/
-/*****************************************************************************/
-static char *open_results_file(char *full_filename, off_t *size)
+/*
+ * If the FIND_FILE <pattern> is plain text [with optional '^' and '$' anchors, and '\' escaped
+ * metacharacters], copy the text into <literal>, set <match> and return TRUE.
+ */
+static gboolean literal_path_pattern(const char *pattern, char *literal, pathidx_match_t *match)
 {
-    FILE        *results_file;
-    struct stat statstruct;
-    static char *results_buf;
+    const char  *read_ptr = pattern;
+    char        *write_ptr = literal;
+    gboolean    anchor_start = FALSE;
+    gboolean    anchor_end = FALSE;
 
-    if ( ((results_file = fopen(full_filename, "rb")) != NULL) && (fstat(fileno(results_file), &statstruct) == 0) )
+    if (*read_ptr == '^')
     {
-        results_buf = g_malloc(statstruct.st_size);    /* malloc a buffer to hold the entire old-file */
-        if ( !results_buf )
+        anchor_start = TRUE;
+        read_ptr++;
+    }
+
+    for (; *read_ptr != '\0'; read_ptr++)
+    {
+        if ( (*read_ptr == '$') && (read_ptr[1] == '\0') )
         {
-            /* Malloc failed */
-            fprintf(stderr, "Error: Unable to allocate memory for search results file\n");
-            *size = 0;
-            fclose(results_file);
-            return(NULL);
+            anchor_end = TRUE;
         }
-
-        if ( fread(results_buf, 1, statstruct.st_size, results_file) != statstruct.st_size )
+        else if (*read_ptr == '\\')
         {
-            /* Read failed */
-            fprintf(stderr, "Error: Unable to to read entire search results file\n");
-            *size = 0;
-            fclose(results_file);
-            return(NULL);
+            /* An escaped punctuation character is literal [others, e.g. "\w", are not portable] */
+            read_ptr++;
+            if ( (*read_ptr == '\0') || isalnum((unsigned char) *read_ptr) ) return(FALSE);
+            *write_ptr++ = *read_ptr;
+        }
+        else if ( strchr("^.*[{()\\$?+|", *read_ptr) )
+        {
+            return(FALSE);
+        }
+        else
+        {
+            *write_ptr++ = *read_ptr;
         }
-        fclose(results_file);
-
-        *size = statstruct.st_size;
-        return(results_buf);
-    }
-    else    // There is no search-results file
-    {
-        *size = 0;
-        if (results_file) fclose (results_file);
-        return(NULL); 
     }
+    *write_ptr = '\0';
+
+    if (anchor_start)
+        *match = anchor_end ? PATHIDX_EXACT : PATHIDX_PREFIX;
+    else
+        *match = anchor_end ? PATHIDX_SUFFIX : PATHIDX_SUBSTRING;
+
+    return(*literal != '\0');
 }
 
 
 
-static FILE *open_out_file(gchar *full_filename)
+/*
+ * Return the source files [of <candidates>, or all of them] that match the regular expression
+ * <pattern>, in file order (an array of guint).  Large lists are split between several threads.
+ */
+static GArray *match_paths(const char *pattern, GArray *candidates, gboolean ignore_case)
 {
-    FILE *output_file;
+    path_scan_t *scans;
+    GThread     **threads;
+    gboolean    *matched;
+    GArray      *result;
+    guint       count = candidates ? candidates->len : nsrcfiles;
+    guint       num_threads;
+    guint       file, i, t;
 
-    output_file = fopen(full_filename, "w");
-    if (output_file == NULL)
+    num_threads = MIN( MIN(g_get_num_processors(), MAX_SCAN_THREADS), MAX(count / PATH_SCAN_FILES, 1) );
+
+    scans   = g_new(path_scan_t, num_threads);
+    threads = g_new(GThread *, num_threads);
+    matched = g_new0(gboolean, MAX(count, 1));
+
+    for (t = 0; t < num_threads; t++)
     {
-        my_cannotopen(full_filename);
+        scans[t].pattern = pattern;
+        scans[t].files   = candidates;
+        scans[t].first   = (guint) ((guint64) count * t / num_threads);
+        scans[t].last    = (guint) ((guint64) count * (t + 1) / num_threads);
+        scans[t].matched = matched;
+        scans[t].ignore_case = ignore_case;
     }
 
-    return(output_file);
+    /* This thread takes the first share */
+    for (t = 1; t < num_threads; t++) threads[t] = g_thread_new("gscope-file-scan", scan_paths, &scans[t]);
+    scan_paths(&scans[0]);
+    for (t = 1; t < num_threads; t++)
+    {
+        g_thread_join(threads[t]);
+        last_work.cpu_ms += scans[t].cpu_time / 1000.0;     /* The calling thread's share is in its own CPU time */
+    }
+    last_work.regex_evals += count;
+
+    result = g_array_new(FALSE, FALSE, sizeof(guint));
+    for (i = 0; i < count; i++)
+    {
+        if ( !matched[i] ) continue;
+        file = candidates ? g_array_index(candidates, guint, i) : i;
+        g_array_append_val(result, file);
+    }
+
+    g_free(matched);
+    g_free(threads);
+    g_free(scans);
+    return(result);
 }
 
 
 
-/* Prepare to perform a Case Sensitive, non-regexp search */
-gboolean symbol_search_init(char *cpattern, char *pattern)
+/* Thread function: check one share of the files for match_paths() */
+static gpointer scan_paths(gpointer data)
 {
-    uint32_t i;
-    char    *read_ptr;
-    char    c;
-
-    if (settings.truncateSymbols) pattern[8] = '\0';    /* if requested, try to truncate a C symbol pattern */
+    path_scan_t *scan = data;
+    regex_t     regex_ptr;      /* regexec() serializes callers sharing a compiled pattern:  use a private copy */
+    guint       file, i;
+    gint64      cpu_start = cpu_time();
 
-    read_ptr = pattern;
+    scan->cpu_time = 0;
+    if (regcomp (&regex_ptr, scan->pattern, REG_EXTENDED | REG_NOSUB | (scan->ignore_case ? REG_ICASE : 0) ) != 0)
+        return(NULL);
 
-    /* check for a valid C symbol */
-    if (!isalpha(*read_ptr) && *read_ptr != '_')
-    {
-        return(FALSE);
-    }
-    while (*++read_ptr != '\0')
+    for (i = scan->first; i < scan->last; i++)
     {
-        if (!isalnum(*read_ptr) && *read_ptr != '_')
-        {
-            return(FALSE);
-        }
-    }
+        file = scan->files ? g_array_index(scan->files, guint, i) : i;
+        scan->matched[i] = (regexec (&regex_ptr, DIR_src_files[file], (size_t)0, NULL, 0) == 0);
 
-    /* compress the string pattern for matching */
-    for (i = 0; (c = pattern[i]) != '\0'; ++i)
-    {
-        if (IS_A_DICODE(c, pattern[i + 1]))
-        {
-            c = DICODE_COMPRESS(c, pattern[i + 1]);
-            ++i;
-        }
-        /*(unsigned char)*/ *cpattern++ = c;
+        if ( ((i % PATH_SCAN_FILES) == 0) && search_cancelled() ) break;
     }
-    *cpattern = '\0';
 
-    return(TRUE);
+    regfree(&regex_ptr);
+    scan->cpu_time = cpu_time() - cpu_start;
+    return(NULL);
 }
 
 
 
-void match_file(char *infile_name, regex_t regex_ptr, char *format)
+/* find files #including this file */
+static search_result_t find_include(char *pattern, gboolean ignore_case)
 {
-    FILE        *in_file;
-    struct      stat statstruct;
-    uint32_t    linenum = 0;
-    char        *end_ptr;
-    char        *string_ptr;
-    char        *work_ptr;
+    char        file[MAX_SYMBOL_SIZE + 1];  /* source file name */
+    uint32_t    searchcount = 0;
+    char        *read_ptr;
+    gboolean    done = FALSE;
+    char        *s;
+    regex_t     regex_ptr;
 
-    static uint32_t     buf_size = (1024 * 1024);
-    static char         *buf_ptr = NULL;
+    /* remove trailing white space */
+    for (s = pattern + strlen(pattern) - 1; isspace(*s); --s) *s = '\0';
 
-    if (!buf_ptr) buf_ptr = g_malloc(buf_size);   // Perform the initial buffer malloc
+    /* This search utilizes regexec() for all search patterns */
+    /* allow a match anywhere inside the string */
+    if (regcomp (&regex_ptr, pattern, REG_EXTENDED | REG_NOSUB | (ignore_case ? REG_ICASE : 0) ) != 0)
+        return(REGCMPERROR);
 
-    // open the input file
+    read_ptr = cref_file_buf;
 
-    if ( ((in_file = fopen(infile_name, "r")) != NULL) && (fstat(fileno(in_file), &statstruct) == 0) )
+    /* find the next source file name or #include */
+    read_ptr = SCAN_past_tab(read_ptr);    /* Skip the header, Scan past the next tab char */
+    read_ptr++;                     /* Skip the file marker */
+    get_string(file, &read_ptr);    /* Get the first file name */
+
+    while (!done)
     {
-        if ( (statstruct.st_size + 1) > buf_size )        // grow the buffer as needed
+        /* Find the next scan token */
+        read_ptr = SCAN_past_tab(read_ptr);
+
+        switch (*read_ptr)
         {
-            g_free(buf_ptr);
-            buf_size = statstruct.st_size + 1;    // +1 needed for files that do not end with LF character
-            buf_ptr = g_malloc(buf_size);
 
-            if (!buf_ptr)
-            {
-                fprintf(stderr,"Malloc Error in match_file().\n");
-                fclose(in_file);
-                return;
-            }
-        }
+            case NEWFILE:       /* save file name */
+                read_ptr++;
+                get_string(file, &read_ptr);
 
-        if ( fread(buf_ptr, 1, statstruct.st_size, in_file) != statstruct.st_size )
-        {
-            fclose(in_file);
-            return;
+                /* Check for end of symbols */
+                if (*file == '\0')
+                {
+                    done = TRUE;
+                    continue;
+                }
+                searchcount++;
+                progress(searchcount, nsrcfiles);
+            break;
+
+            case INCLUDE:
+                read_ptr++;
+                read_ptr++;  /* skip global or local #include marker '<' or '"' */
+                if (match_regex(&read_ptr, regex_ptr))
+                {
+                    /* output the file and source line */
+                    putref(file, global, &read_ptr);
+                }
+            break;
+
+            default:
+                /* do nothing */
+            break;
         }
-        fclose(in_file);
 
-        end_ptr = buf_ptr + statstruct.st_size;
-        string_ptr = buf_ptr;
-        work_ptr = buf_ptr;
+        if ( search_cancelled() ) break;
+    }
+    last_work.cref_bytes += read_ptr - cref_file_buf;
 
-        //*** search entire file line-by-line ***/
+    regfree(&regex_ptr);    /* Avoid memory leak, free memory allocated to the pattern buffer by regcomp() compiling process */
+    return(NOERROR);
+}
 
-        while (work_ptr < end_ptr)
-        {
-            while ( (*work_ptr != '\n') && (work_ptr < end_ptr) ) work_ptr++;       // Find then next newline char
 
-            linenum++;
-            *work_ptr++ = '\0';
 
-            // if match found fprintf(refsfound, format, line_number)
-            if ( regexec (&regex_ptr, string_ptr, (size_t)0, NULL, 0) == 0 )
-            {
-                fprintf(refsfound, format, infile_name, linenum, string_ptr);
-                imatch_count++;
-            }
+static gboolean is_regexp(char *pattern)
+{
+    char *work_ptr;
+    gboolean isregexp = FALSE;
 
-            string_ptr = work_ptr;  // Advance to the next string.
-        }
-    }
-    else
+    work_ptr = pattern;
+
+    while ( (!isregexp) && (*work_ptr != '\0') )
     {
-        if (in_file) fclose(in_file);
-        DISPLAY_set_cref_current(FALSE);    /* Set the out-of-date indicator */
-        fprintf(stderr, "File open error: %s\n", infile_name);
+        isregexp = (strchr("^.*[{(\\$?+|", *work_ptr) != NULL );
+        work_ptr++;
     }
+
+    return(isregexp);
 }
 
 
 
-/* remove leading ^ and trailing $ (if present) */
-static void strip_anchors(char *pattern)
+/* Return TRUE if <pattern> is a valid C symbol */
+static gboolean is_symbol(char *pattern)
 {
-    int i;
-    char *wptr;
-
-    wptr = pattern;
+    char *work_ptr = pattern;
 
-    if (*wptr == '^')
-    {
-        while ( *wptr != '\0')
-        {
-            *wptr = *(wptr + 1);
-            wptr++;
-        }
-    }
+    if ( !isalpha((unsigned char) *work_ptr) && *work_ptr != '_' ) return(FALSE);
 
-    i = strlen(pattern) - 1;
-    if (pattern[i] == '$')
+    while (*++work_ptr != '\0')
     {
-        pattern[i] = '\0';
+        if ( !isalnum((unsigned char) *work_ptr) && *work_ptr != '_' ) return(FALSE);
     }
 
-    return;
+    return(TRUE);
 }
 
 
 
-static gboolean compress_search_pattern(char *cpattern, char *pattern)
+/* match the pattern to the string */
+static gboolean match_regex(char **src, regex_t regex_ptr)
+{
+    char    string[MAX_SYMBOL_SIZE + 1];
+
+    get_string(string, src);
+    if (*string == '\0')
+    {
+        return(FALSE);
+    }
+
+    last_work.symbols++;
+    last_work.regex_evals++;
+    return(regexec (&regex_ptr, string, (size_t)0, NULL, 0) ? FALSE : TRUE);
+}
+
+
+
+static gboolean match_bytes(char **src_ptr, char *cpattern)
+{
+    int i = 1;
+    char *match_ptr = *src_ptr;
+
+    while (*match_ptr == cpattern[i])
+    {
+        ++match_ptr;
+        ++i;
+    }
+
+    *src_ptr = match_ptr;
+    if (*match_ptr == '\n' && cpattern[i] == '\0')
+    {
+        return(TRUE);
+    }
+    return(FALSE);
+}
+
+
+
+/*
+ * Case-insensitive version of match_bytes().  <fpattern> is the lower case, uncompressed pattern.
+ * Digraphs in the database symbol are expanded in-line; unlike match_bytes() the first character
+ * has not been checked by the caller.
+ */
+static gboolean match_folded(char **src_ptr, char *fpattern)
+{
+    char            *match_ptr = *src_ptr;
+    char            *p_ptr     = fpattern;
+    unsigned char   c;
+
+    while ( (c = *match_ptr) != '\n' )
+    {
+        if (c & 0x80)   /* digraph char */
+        {
+            c &= 0x7f;
+            if ( (g_ascii_tolower(dichar1[c / 8]) != p_ptr[0]) || (g_ascii_tolower(dichar2[c & 7]) != p_ptr[1]) )
+                break;
+            p_ptr += 2;
+        }
+        else
+        {
+            if (g_ascii_tolower(c) != *p_ptr)
+                break;
+            p_ptr++;
+        }
+        match_ptr++;
+    }
+
+    *src_ptr = match_ptr;
+    return( (*match_ptr == '\n') && (*p_ptr == '\0') );
+}
+
+
+
+/* put the reference into the file */
+static void putref(char *file, char *func, char **src)
+{
+    FILE    *output;
+
+    imatch_count++;
+
+    if (strcmp(func, global) == 0)
+    {
+        output = refsfound;
+    }
+    else
+    {
+        output = nonglobalrefs;
+    }
+    (void) fprintf(output, "%s|%s ", file, func);
+
+    if ( !putsource(output, src) )
+    {
+        fprintf(stderr,"\nGscope Internal error: cannot get source line from database\n\n");
+        fprintf(stderr,"This failure is typically caused by a file using non-UNIX newline format.\n");
+        fprintf(stderr,"Problem file: %s\n", file);
+        fprintf(stderr,"Fix the newline format of this file to correct this failure.\n");
+        SEARCH_cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    stream_check();
+}
+
+
+
+/* put the source line into the file */
+static gboolean putsource(FILE *output, char **src_ptr)
+{
+    char     *cp;
+    char     nextc = '\0';
+
+    cp = *src_ptr;
+
+    /* scan back to the beginning of the source line (double-newline chars) */
+    while (*cp != '\n' || nextc != '\n')
+    {
+        nextc = *cp;
+        --cp;
+    }
+    if (*cp != '\n' || *(++cp) != '\n' || !isdigit(*(++cp)) )
+    {
+        return(FALSE);
+    }
+
+    /* A double newline followed by a single digit [0..9] is found */
+    do
+    {
+        /* skip a symbol type */
+        if (*cp == '\t')
+        {
+            cp += 2;;
+        }
+        *src_ptr = cp;
+
+        /* output a piece of the source line */
+        putline(output, &cp);
+    } while (*(++cp) != '\n');  /* until a double newline is found */
+
+    (void) putc('\n', output);
+    *src_ptr = cp;
+
+    return(TRUE);
+}
+
+
+
+/* put the rest of the cross-reference line into the file */
+static void putline(FILE *output, char **src_ptr)
+{
+    char    *line_ptr = *src_ptr;
+    unsigned c;
+
+    while ((c = (unsigned)(*line_ptr)) != '\n')
+    {
+
+        /* check for a compressed digraph */
+        if (c > 0x7f)
+        {
+            c &= 0x7f;
+            (void) putc(dichar1[c / 8], output);
+            (void) putc(dichar2[c & 7], output);
+        }
+        /* check for a compressed keyword */
+        else if (c < ' ')
+        {
+            (void) fputs(keyword[c].text, output);
+            if (keyword[c].delim != '\0')
+            {
+                (void) putc(' ', output);
+            }
+            if (keyword[c].delim == '(')
+            {
+                (void) putc('(', output);
+            }
+        }
+        else
+        {
+            (void) putc((int) c, output);
+        }
+        ++line_ptr;
+    }
+    *src_ptr = line_ptr;    /* Return the new read-pointer value */
+}
+
+
+
+/* put the rest of the cross-reference line into the string */
+static void get_string(char *dest, char **src)
+{
+    uint8_t     byte;
+    char        *src_ptr = *src;
+    guint       byte_count = 0;
+    char        *start = dest;
+    gboolean    truncated = FALSE;
+
+    while ( (byte = (unsigned) (*src_ptr)) != '\n' )
+    {
+        if (byte > 0x7f)
+        {
+            if (byte_count + 2 > MAX_SYMBOL_SIZE)
+            {
+                truncated = TRUE;
+                break;    // The dicode expansion would overrun our buffer, so truncate
+            }
+
+            byte   &= 0x7f;
+            *dest++ = dichar1[byte / 8];
+            *dest++ = dichar2[byte & 7];
+            byte_count += 2;
+        }
+        else
+        {
+            *dest++ = byte;
+            byte_count++;
+        }
+        src_ptr++;
+
+        if (byte_count == MAX_SYMBOL_SIZE)
+        {
+            truncated = TRUE;
+            break;   // The buffer is full, so truncate
+        }
+    }
+    *dest++ = '\0';    // Null-terminate the extracted string
+
+    if (truncated)
+    {
+        fprintf(stderr, "Warning: Unusually large (> %d bytes) symbol encountered.  Symbol Truncated to:\n    %s\n"
+                       "Pattern Matches for the non-truncated version of this symbol will fail.\n"
+                       "If this is a problem, request a new Gscope build with a larger MAX_SYMBOL_SIZE limit.\n",
+               MAX_SYMBOL_SIZE,
+               start);
+    }
+    *src = src_ptr;    // Update the caller's copy of the source pointer.
+}
+
+
+
+/* initialize the progress message */
+static void initprogress()
+{
+    imatch_count = 0;
+}
+
+
+
+/* Periodically report the search progress (asynchronous requests only) */
+static void progress(uint32_t n1, uint32_t n2)
+{
+    static uint32_t calls = 0;
+    gint64          now;
+    notify_t        *notify;
+
+    /* Don't let a trickle of matches sit in the temp files waiting for a full batch */
+    stream_check();
+
+    if ( !active_token->callbacks.progress ) return;
+
+    if ( (++calls % PROGRESS_CHECK) != 0 ) return;
+
+    now = g_get_monotonic_time();
+    if ( (now - progress_time) < PROGRESS_USEC ) return;
+    progress_time = now;
+
+    notify = g_new0(notify_t, 1);
+    notify->type     = NOTIFY_PROGRESS;
+    notify->token    = active_token;
+    notify->searched = n1;
+    notify->total    = n2;
+    notify->matches  = imatch_count;
+    post_notify(notify);
+}
+
+
+
+/* Prepare to deliver streamed results from the temp files to the request's 'batch' callback */
+static void stream_start()
+{
+    if ( ((stream_fd[0] = open(temp1, O_RDONLY)) < 0) || ((stream_fd[1] = open(temp2, O_RDONLY)) < 0) )
+    {
+        fprintf(stderr, "Warning: Unable to stream search results: %s\n", strerror(errno));
+        stream_stop();
+        return;
+    }
+
+    stream_offset[0] = 0;
+    stream_offset[1] = 0;
+    stream_count     = 0;
+    stream_time      = g_get_monotonic_time();
+    stream_active    = TRUE;
+}
+
+
+
+/* Deliver a batch if enough matches are pending, or if the pending matches have waited long enough */
+static void stream_check()
+{
+    uint32_t pending;
+
+    if ( !stream_active ) return;
+
+    pending = imatch_count - stream_count;
+
+    if ( (pending >= STREAM_BATCH_ROWS) ||
+         (pending > 0 && (g_get_monotonic_time() - stream_time) >= STREAM_BATCH_USEC) )
+    {
+        stream_flush();
+    }
+}
+
+
+
+/* Hand every not-yet-delivered result line to the request's 'batch' callback */
+static void stream_flush()
+{
+    notify_t            *notify;
+    search_results_t    *part[2];
+    FILE                *output[2] = { refsfound, nonglobalrefs };
+    off_t               end;
+    size_t              size;
+    gchar               *work_ptr;
+    int                 i;
+
+    notify = g_new0(notify_t, 1);
+    notify->type  = NOTIFY_BATCH;
+    notify->token = active_token;
+    part[0] = &notify->batch.head;
+    part[1] = &notify->batch.tail;
+
+    for (i = 0; i < 2; i++)
+    {
+        /* Results are only ever written a full line at a time, so a flushed file never ends mid-line */
+        fflush(output[i]);
+        end  = ftello(output[i]);
+        size = end - stream_offset[i];
+
+        if (size == 0) continue;
+
+        part[i]->start_ptr = g_malloc(size);
+        if ( pread(stream_fd[i], part[i]->start_ptr, size, stream_offset[i]) != (ssize_t) size )
+        {
+            fprintf(stderr, "Error: Internal failure, unable to read streamed search results:\n%s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        part[i]->end_ptr = part[i]->start_ptr + size;
+        stream_offset[i] = end;
+
+        for (work_ptr = part[i]->start_ptr; work_ptr != part[i]->end_ptr; work_ptr++)
+        {
+            if (*work_ptr == '\n') part[i]->match_count++;
+        }
+    }
+
+    stream_count = imatch_count;
+    stream_time  = g_get_monotonic_time();
+
+    if (notify->batch.head.match_count + notify->batch.tail.match_count > 0)
+    {
+        post_notify(notify);
+    }
+    else
+    {
+        g_free(notify);
+    }
+}
+
+
+
+static void stream_stop()
+{
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (stream_fd[i] >= 0) close(stream_fd[i]);
+        stream_fd[i] = -1;
+    }
+    stream_active = FALSE;
+}
+
+
+
+/* Has the active request been cancelled (individually, or by SEARCH_cancel)? */
+static gboolean search_cancelled()
+{
+    return( g_atomic_int_get(&active_token->cancelled) ||
+            (active_token->generation != g_atomic_int_get(&cancel_generation)) );
+}
+
+
+
+/* Place a message in the query status label [from any thread] */
+static void search_status(gchar *msg)
+{
+    notify_t *notify;
+
+    notify = g_new0(notify_t, 1);
+    notify->type = NOTIFY_STATUS;
+    notify->msg  = g_strdup(msg);
+    post_notify(notify);
+}
+
+
+
+/* Update the cross-reference status indicator [from any thread] */
+static void search_cref_current(gboolean up_to_date)
+{
+    notify_t *notify;
+
+    notify = g_new0(notify_t, 1);
+    notify->type       = NOTIFY_CREF;
+    notify->up_to_date = up_to_date;
+    post_notify(notify);
+}
+
+
+
+/* Deliver a notification to the UI: immediately when called from the UI thread, otherwise
+   via the GTK main loop.  The search engine never iterates the main loop itself. */
+static void post_notify(notify_t *notify)
+{
+    if ( (ui_thread == NULL) || (g_thread_self() == ui_thread) )
+    {
+        notify_ui(notify);
+    }
+    else
+    {
+        g_idle_add(notify_ui, notify);
+    }
+}
+
+
+
+/* Main-loop handler for search notifications */
+static gboolean notify_ui(gpointer data)
+{
+    notify_t        *notify = data;
+    search_token_t  *token  = notify->token;
+
+    switch (notify->type)
+    {
+        case NOTIFY_STATUS:
+            ENGINE_status(notify->msg);
+            g_free(notify->msg);
+        break;
+
+        case NOTIFY_CREF:
+            ENGINE_set_cref_current(notify->up_to_date);
+        break;
+
+        case NOTIFY_PROGRESS:
+            token->callbacks.progress(notify->searched, notify->total, notify->matches, token->user_data);
+        break;
+
+        case NOTIFY_BATCH:
+            token->callbacks.batch(&notify->batch, token->user_data);
+            g_free(notify->batch.head.start_ptr);
+            g_free(notify->batch.tail.start_ptr);
+        break;
+
+        case NOTIFY_DONE:
+            /* This is the final notification for this request: release it */
+            if (token->callbacks.done) token->callbacks.done(&token->results, token->user_data);
+            SEARCH_free_results(&token->results);
+            g_free(token->pattern);
+            g_free(token);
+        break;
+    }
+
+    g_free(notify);
+    return(FALSE);  /* Remove the idle source */
+}
+
+
+
+/* Search thread: perform queued asynchronous requests, one at a time, in the order received */
+static gpointer search_thread(gpointer data)
+{
+    search_token_t  *token;
+    notify_t        *notify;
+
+    while (TRUE)
+    {
+        token = g_async_queue_pop(request_queue);
+
+        g_mutex_lock(&engine_lock);
+        active_token = token;
+        if ( !search_cancelled() ) perform_lookup(token);
+        active_token = NULL;
+        g_mutex_unlock(&engine_lock);
+
+        notify = g_new0(notify_t, 1);
+        notify->type  = NOTIFY_DONE;
+        notify->token = token;
+        post_notify(notify);
+    }
+
+    return(NULL);
+}
+
+
+
+/*
+ * Only queries answered from the cross-reference itself are cached:  a rebuild or reload changes the
+ * database generation.  String, egrep and file searches read the live source files [or depend on them],
+ * which can change at any time, and the autogen-error list is volatile:  always search them again.
+ */
+static gboolean cacheable(search_t operation)
+{
+    switch (operation)
+    {
+        case FIND_STRING:
+        case FIND_REGEXP:
+        case FIND_FILE:
+        case FIND_AUTOGEN_ERRORS:
+            return(FALSE);
+
+        default:
+            return(TRUE);
+    }
+}
+
+
+
+/* Return the cached results for this query (making it the most recently used entry), or NULL */
+static cache_entry_t *cache_find(search_t operation, gchar *pattern, gboolean ignore_case, gboolean truncate_symbols)
+{
+    GList           *link;
+    cache_entry_t   *entry;
+    gint            generation = g_atomic_int_get(&db_generation);
+
+    if (cache_generation != generation)     /* The database has changed: every entry is stale */
+    {
+        cache_flush();
+        cache_generation = generation;
+    }
+
+    for (link = cache_lru.head; link != NULL; link = link->next)
+    {
+        entry = link->data;
+
+        if ( (entry->operation == operation) && (entry->ignore_case == ignore_case) &&
+             (entry->truncate_symbols == truncate_symbols) && (strcmp(entry->pattern, pattern) == 0) )
+        {
+            g_queue_unlink(&cache_lru, link);
+            g_queue_push_head_link(&cache_lru, link);
+            cache_hits++;
+            return(entry);
+        }
+    }
+
+    cache_misses++;
+    return(NULL);
+}
+
+
+
+/* Add a copy of <results> to the cache, evicting the least recently used entries to stay within budget */
+static void cache_store(search_t operation, gchar *pattern, gboolean ignore_case, gboolean truncate_symbols,
+                        gint generation, search_results_t *results)
+{
+    cache_entry_t   *entry;
+    gsize           size = results->end_ptr - results->start_ptr;
+
+    if ( (generation != g_atomic_int_get(&db_generation)) || (generation != cache_generation) )
+        return;     /* The database changed while this search was in progress */
+
+    if (size > QUERY_CACHE_BYTES / 4) return;   /* Don't let one huge result flush everything else */
+
+    while ( (cache_lru.length >= QUERY_CACHE_ENTRIES) || (cache_bytes + size > QUERY_CACHE_BYTES) )
+    {
+        cache_evict(cache_lru.tail);
+    }
+
+    entry = g_new(cache_entry_t, 1);
+    entry->operation   = operation;
+    entry->pattern     = g_strdup(pattern);
+    entry->ignore_case = ignore_case;
+    entry->truncate_symbols = truncate_symbols;
+    entry->data        = g_malloc(size);
+    entry->size        = size;
+    entry->match_count = results->match_count;
+    memcpy(entry->data, results->start_ptr, size);
+
+    g_queue_push_head(&cache_lru, entry);
+    cache_bytes += size;
+}
+
+
+
+static void cache_evict(GList *link)
+{
+    cache_entry_t *entry = link->data;
+
+    cache_bytes -= entry->size;
+    g_queue_delete_link(&cache_lru, link);
+    g_free(entry->pattern);
+    g_free(entry->data);
+    g_free(entry);
+}
+
+
+
+static void cache_flush()
+{
+    while (cache_lru.tail != NULL)
+    {
+        cache_evict(cache_lru.tail);
+    }
+}
+
+
+
+/* Append a query to the query trace [if one is open], in the "<type>:<pattern>" form of --queryFile */
+static void log_query(search_t operation, const gchar *pattern)
+{
+    const gchar *name;
+
+    if ( query_log && ((name = SEARCH_type_name(operation)) != NULL) )
+    {
+        fprintf(query_log, "%s:%s\n", name, pattern);
+        fflush(query_log);      /* The trace is complete even if gscope is killed */
+    }
+}
+
+
+
+/* CPU time of the calling thread, in microseconds.  The process clock would also count the
+   GUI, the dictionary builder and any other thread busy during the search. */
+static gint64 cpu_time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return( (gint64) now.tv_sec * G_USEC_PER_SEC + now.tv_nsec / 1000 );
+}
+
+
+
+/* Complete the accounting of the search that produced <results>:  add it to the history, and
+   append it to the query trace [if one is open] as a "# key=value ..." comment after the query */
+static void record_work(search_results_t *results, gint64 wall_start, gint64 cpu_start)
+{
+    last_work.wall_ms      = (g_get_monotonic_time() - wall_start) / 1000.0;
+    last_work.cpu_ms      += (cpu_time() - cpu_start) / 1000.0;     /* Plus the file name scan threads [match_paths] */
+    last_work.result_bytes = results->end_ptr - results->start_ptr;
+    last_work.match_count  = results->match_count;
+    PROBE4(search_done, last_work.operation, last_work.pattern, last_work.match_count, last_work.cached);
+
+    g_mutex_lock(&history_lock);
+    work_history[history_next] = last_work;
+    history_next = (history_next + 1) % SEARCH_WORK_HISTORY;
+    if (history_count < SEARCH_WORK_HISTORY) history_count++;
+    g_mutex_unlock(&history_lock);
+
+    /* A comment line:  --queryFile and gscope_replay skip it, and the query line above it holds the full pattern */
+    if ( query_log && SEARCH_type_name(last_work.operation) )
+    {
+        fprintf(query_log, "# wall_ms=%.3f cpu_ms=%.3f cref_bytes=%lu symbols=%" G_GUINT64_FORMAT
+                           " regex=%" G_GUINT64_FORMAT " files=%u source_bytes=%lu result_bytes=%lu matches=%u cached=%d\n",
+                last_work.wall_ms, last_work.cpu_ms,
+                (unsigned long) last_work.cref_bytes, last_work.symbols, last_work.regex_evals, last_work.files_opened,
+                (unsigned long) last_work.source_bytes, (unsigned long) last_work.result_bytes, last_work.match_count,
+                last_work.cached);
+        fflush(query_log);
+    }
+}
+
+
+
+/* Pass an access pattern hint for the cross-reference to the kernel (mapped cross-references only) */
+static void cref_advise(int advice)
+{
+    if (cref_file_mapped && cref_file_size > 0)
+    {
+        (void) madvise(cref_file_buf, cref_file_size, advice);
+    }
+}
+
+
+
+/* Perform a periodic cross-reference update check */
+static void periodic_check_cref()
+{
+    static gboolean     initialized = FALSE;
+    static time_t       last_check_time = 0;
+
+    time_t now;
+
+    if ( !initialized )
+    {
+        last_check_time = time( (time_t *) NULL);
+        initialized = TRUE;
+    }
+
+    now = time( (time_t *) NULL);
+
+    if (now - last_check_time > (15 * 60) )  // if we haven't checked the cref in the last 15 minutes
+    {
+        last_check_time = time( (time_t *) NULL);
+        SEARCH_check_cref();
+    }
+}
+
+
+
+/* open the references found file for writing */
+static gboolean writerefsfound()
+{
+    if (refsfound == NULL)
+    {
+        if ((refsfound = fopen(temp1, "w")) == NULL)
+        {
+            my_cannotopen(temp1);
+            return(FALSE);
+        }
+    }
+    else if (freopen(temp1, "w", refsfound) == NULL)
+    {
+        fprintf(stderr, "Cannot open temporary file\n");
+        return(FALSE);
+    }
+    return(TRUE);
+}
+
+
+
+/*****************************************************************************/
+/*** Open the search results file and read the entire contents into memory ***/
+/***                                                                       ***/
+/*** This function mallocs memory, caller is responsible for freeing the   ***/
+/*** allocated buffer.                                                     ***/
+/*****************************************************************************/
+static char *open_results_file(char *full_filename, off_t *size)
+{
+    char *results_buf;
+
+    g_mutex_lock(&engine_lock);     /* The results file is being rewritten while a search is in progress */
+    results_buf = read_results_file(full_filename, size);
+    g_mutex_unlock(&engine_lock);
+
+    return(results_buf);
+}
+
+
+
+static char *read_results_file(char *full_filename, off_t *size)
+{
+    FILE        *results_file;
+    struct stat statstruct;
+    char        *results_buf;
+
+    if ( ((results_file = fopen(full_filename, "rb")) != NULL) && (fstat(fileno(results_file), &statstruct) == 0) )
+    {
+        results_buf = g_malloc(statstruct.st_size);    /* malloc a buffer to hold the entire old-file */
+        if ( !results_buf )
+        {
+            /* Malloc failed */
+            fprintf(stderr, "Error: Unable to allocate memory for search results file\n");
+            *size = 0;
+            fclose(results_file);
+            return(NULL);
+        }
+
+        if ( fread(results_buf, 1, statstruct.st_size, results_file) != statstruct.st_size )
+        {
+            /* Read failed */
+            fprintf(stderr, "Error: Unable to to read entire search results file\n");
+            *size = 0;
+            fclose(results_file);
+            return(NULL);
+        }
+        fclose(results_file);
+
+        *size = statstruct.st_size;
+        return(results_buf);
+    }
+    else    // There is no search-results file
+    {
+        *size = 0;
+        if (results_file) fclose (results_file);
+        return(NULL); 
+    }
+}
+
+
+
+static FILE *open_out_file(gchar *full_filename)
+{
+    FILE *output_file;
+
+    output_file = fopen(full_filename, "w");
+    if (output_file == NULL)
+    {
+        my_cannotopen(full_filename);
+    }
+
+    return(output_file);
+}
+
+
+
+/* Prepare to perform a Case Sensitive, non-regexp search */
+gboolean symbol_search_init(char *cpattern, char *pattern)
+{
+    uint32_t i;
+    char    *read_ptr;
+    char    c;
+
+    if (settings.truncateSymbols) pattern[8] = '\0';    /* if requested, try to truncate a C symbol pattern */
+
+    read_ptr = pattern;
+
+    /* check for a valid C symbol */
+    if (!isalpha(*read_ptr) && *read_ptr != '_')
+    {
+        return(FALSE);
+    }
+    while (*++read_ptr != '\0')
+    {
+        if (!isalnum(*read_ptr) && *read_ptr != '_')
+        {
+            return(FALSE);
+        }
+    }
+
+    /* compress the string pattern for matching */
+    for (i = 0; (c = pattern[i]) != '\0'; ++i)
+    {
+        if (IS_A_DICODE(c, pattern[i + 1]))
+        {
+            c = DICODE_COMPRESS(c, pattern[i + 1]);
+            ++i;
+        }
+        /*(unsigned char)*/ *cpattern++ = c;
+    }
+    *cpattern = '\0';
+
+    return(TRUE);
+}
+
+
+
+/*
+ * Report every line of <infile_name> that matches the regular expression.
+ *
+ * If a <literal> is provided (text that every match must contain), the whole file is scanned
+ * for the literal first, and line boundaries, line numbers and regexec() are only computed for
+ * the lines where it is found.
+ */
+static void match_file(char *infile_name, regex_t regex_ptr, const char *literal, char *format)
+{
+    FILE        *in_file;
+    struct      stat statstruct;
+    uint32_t    linenum = 0;
+    char        *end_ptr;
+    char        *string_ptr;
+    char        *work_ptr;
+    char        *hit_ptr;
+    size_t      literal_len;
+    uint32_t    start_count = imatch_count;     /* For the match_file_done probe */
+
+    static uint32_t     buf_size = (1024 * 1024);
+    static char         *buf_ptr = NULL;
+
+    if (!buf_ptr) buf_ptr = g_malloc(buf_size);   // Perform the initial buffer malloc
+
+    PROBE1(match_file_start, infile_name);
+
+    // open the input file
+
+    if ( ((in_file = fopen(infile_name, "r")) != NULL) && (fstat(fileno(in_file), &statstruct) == 0) )
+    {
+        if ( (statstruct.st_size + 1) > buf_size )        // grow the buffer as needed
+        {
+            g_free(buf_ptr);
+            buf_size = statstruct.st_size + 1;    // +1 needed for files that do not end with LF character
+            buf_ptr = g_malloc(buf_size);
+
+            if (!buf_ptr)
+            {
+                fprintf(stderr,"Malloc Error in match_file().\n");
+                fclose(in_file);
+                PROBE3(match_file_done, infile_name, 0L, 0);
+                return;
+            }
+        }
+
+        if ( fread(buf_ptr, 1, statstruct.st_size, in_file) != statstruct.st_size )
+        {
+            fclose(in_file);
+            PROBE3(match_file_done, infile_name, 0L, 0);
+            return;
+        }
+        fclose(in_file);
+
+        last_work.files_opened++;
+        last_work.source_bytes += statstruct.st_size;
+
+        end_ptr = buf_ptr + statstruct.st_size;
+        string_ptr = buf_ptr;
+        work_ptr = buf_ptr;
+
+        if (literal)
+        {
+            //*** search only the lines that contain the literal ***/
+
+            literal_len = strlen(literal);
+            linenum = 1;        // The line number of the line starting at string_ptr
+
+            while ( (hit_ptr = memmem(work_ptr, end_ptr - work_ptr, literal, literal_len)) != NULL )
+            {
+                // Count the lines skipped over to reach the start of the line containing the hit
+                while ( (work_ptr = memchr(string_ptr, '\n', hit_ptr - string_ptr)) != NULL )
+                {
+                    linenum++;
+                    string_ptr = work_ptr + 1;
+                }
+
+                // Find the end of the line
+                if ( (work_ptr = memchr(hit_ptr, '\n', end_ptr - hit_ptr)) == NULL ) work_ptr = end_ptr;
+                *work_ptr++ = '\0';
+
+                last_work.regex_evals++;
+                if ( regexec (&regex_ptr, string_ptr, (size_t)0, NULL, 0) == 0 )
+                {
+                    fprintf(refsfound, format, infile_name, linenum, string_ptr);
+                    imatch_count++;
+                    stream_check();
+                }
+
+                linenum++;
+                string_ptr = work_ptr;  // Advance to the next string.
+
+                if (work_ptr >= end_ptr) break;
+            }
+            PROBE3(match_file_done, infile_name, (long) statstruct.st_size, imatch_count - start_count);
+            return;
+        }
+
+        //*** search entire file line-by-line ***/
+
+        while (work_ptr < end_ptr)
+        {
+            while ( (*work_ptr != '\n') && (work_ptr < end_ptr) ) work_ptr++;       // Find then next newline char
+
+            linenum++;
+            *work_ptr++ = '\0';
+
+            // if match found fprintf(refsfound, format, line_number)
+            last_work.regex_evals++;
+            if ( regexec (&regex_ptr, string_ptr, (size_t)0, NULL, 0) == 0 )
+            {
+                fprintf(refsfound, format, infile_name, linenum, string_ptr);
+                imatch_count++;
+                stream_check();
+            }
+
+            string_ptr = work_ptr;  // Advance to the next string.
+        }
+        PROBE3(match_file_done, infile_name, (long) statstruct.st_size, imatch_count - start_count);
+    }
+    else
+    {
+        if (in_file) fclose(in_file);
+        search_cref_current(FALSE);    /* Set the out-of-date indicator */
+        fprintf(stderr, "File open error: %s\n", infile_name);
+        PROBE3(match_file_done, infile_name, 0L, 0);
+    }
+}
+
+
+
+/*
+ * Extract the longest run of literal text that every match of the extended regular expression
+ * <pattern> must contain, into <literal> [at least as large as <pattern>].
+ * Returns <literal>, or NULL if there is no such text (or it cannot be used for a prefilter).
+ * This is conservative: any construct it does not understand simply ends the current run.
+ */
+static const char *required_literal(const char *pattern, char *literal, gboolean ignore_case)
+{
+    const char  *read_ptr;
+    char        *run_ptr = literal;     /* Start of the run being collected (placed after the best run) */
+    size_t      run_len  = 0;
+    size_t      best_len = 0;
+    gint        depth    = 0;           /* Parenthesis nesting level */
+    char        c;
+
+    /* With alternation, no text is required by every match */
+    if ( strchr(pattern, '|') ) return(NULL);
+
+    for (read_ptr = pattern; (c = *read_ptr) != '\0'; read_ptr++)
+    {
+        switch (c)
+        {
+            case '*':       /* The previous character is optional */
+            case '?':
+            case '{':
+                if (run_len > 0) run_len--;
+                if (c == '{')
+                {
+                    while ( (read_ptr[1] != '\0') && (*read_ptr != '}') ) read_ptr++;
+                }
+                c = '\0';
+            break;
+
+            case '+':       /* The previous character is required, but may repeat */
+            case '.':
+            case '^':
+            case '$':
+            case ')':
+                if (c == ')') depth--;
+                c = '\0';
+            break;
+
+            case '(':
+                depth++;
+                c = '\0';
+            break;
+
+            case '[':       /* Skip the bracket expression (a leading ']' or '^]' is part of the set) */
+                read_ptr++;
+                if (*read_ptr == '^') read_ptr++;
+                if (*read_ptr == ']') read_ptr++;
+                while ( (*read_ptr != '\0') && (*read_ptr != ']') ) read_ptr++;
+                if (*read_ptr == '\0') read_ptr--;
+                c = '\0';
+            break;
+
+            case '\\':
+                if ( (read_ptr[1] != '\0') && ispunct((unsigned char) read_ptr[1]) )
+                {
+                    c = *++read_ptr;            /* An escaped special character is literal text */
+                }
+                else
+                {
+                    if (read_ptr[1] != '\0') read_ptr++;
+                    c = '\0';                   /* \w, \b, back-references etc. */
+                }
+            break;
+
+            default:
+            break;
+        }
+
+        /* Text inside a group might be made optional by a later quantifier, so it is never used */
+        if ( (c != '\0') && (depth == 0) )
+        {
+            run_ptr[run_len++] = c;
+
+            /* A character followed by a quantifier is removed from the run by the next pass */
+            continue;
+        }
+
+        /* The run has ended: keep it if it is the longest so far */
+        if (run_len > best_len)
+        {
+            memmove(literal, run_ptr, run_len);
+            best_len = run_len;
+        }
+        run_ptr = literal + best_len;
+        run_len = 0;
+    }
+
+    if (run_len > best_len)
+    {
+        memmove(literal, run_ptr, run_len);
+        best_len = run_len;
+    }
+    literal[best_len] = '\0';
+
+    if (best_len == 0) return(NULL);
+
+    /* The literal scan is case-sensitive */
+    if (ignore_case)
+    {
+        for (read_ptr = literal; *read_ptr != '\0'; read_ptr++)
+        {
+            if ( isalpha((unsigned char) *read_ptr) ) return(NULL);
+        }
+    }
+
+    return(literal);
+}
+
+
+
+/* remove leading ^ and trailing $ (if present) */
+static void strip_anchors(char *pattern)
+{
+    int i;
+    char *wptr;
+
+    wptr = pattern;
+
+    if (*wptr == '^')
+    {
+        while ( *wptr != '\0')
+        {
+            *wptr = *(wptr + 1);
+            wptr++;
+        }
+    }
+
+    i = strlen(pattern) - 1;
+    if (pattern[i] == '$')
+    {
+        pattern[i] = '\0';
+    }
+
+    return;
+}
+
+
+
+static gboolean compress_search_pattern(char *cpattern, char *pattern, gboolean truncate_symbols)
 {
     char *s;
     char c;
@@ -1371,7 +2910,7 @@ static gboolean compress_search_pattern(char *cpattern, char *pattern)
 
     s = pattern;
 
-    if (settings.truncateSymbols)
+    if (truncate_symbols)
         s[8] = '\0';    /* if requested, try to truncate a C symbol pattern */
 
     /* check for a valid C symbol */
@@ -1400,116 +2939,394 @@ static gboolean compress_search_pattern(char *cpattern, char *pattern)
     }
     *s = '\0';
 
-    return(TRUE);
-}
+    return(TRUE);
+}
+
+
+
+static search_result_t configure_search(char *pattern, gboolean ignore_case, gboolean truncate_symbols,
+                                        match_mode_t *match_mode, regex_t *regex_ptr, char *cpattern)
+{
+    char        *s_ptr;
+    char        *d_ptr;
+
+    /* remove trailing white space */
+    for (s_ptr = pattern + strlen(pattern) - 1; isspace(*s_ptr); --s_ptr) *s_ptr = '\0';
+
+    /* remove leading white space */
+    for (s_ptr = pattern; isspace(*s_ptr); ++s_ptr);
+    if (s_ptr > pattern)        // leading whitespace present, squash it..
+        memmove(pattern, s_ptr, strlen(s_ptr) + 1);
+
+
+    /* This search utilizes regexec() ONLY if there are metacharacters in the search pattern */
+    /* The match must be an exact match */
+    if ( ignore_case && !is_regexp(pattern) && is_symbol(pattern) )    // Configure case-folded search
+    {
+        /* Compared directly against the compressed symbols: see match_folded() */
+        for (s_ptr = pattern, d_ptr = cpattern; *s_ptr != '\0' && d_ptr < cpattern + MAX_SYMBOL_SIZE; s_ptr++)
+        {
+            *d_ptr++ = g_ascii_tolower(*s_ptr);
+        }
+        *d_ptr = '\0';
+
+        *match_mode = MATCH_FOLDED;
+    }
+    else if (is_regexp(pattern) || ignore_case)     // Configure regex search
+    {
+        gchar   *buf;
+
+        /* remove leading ^ and trailing $ (if present) */
+        strip_anchors(pattern);
+
+        my_asprintf(&buf, "^%s$", pattern);
+        if (regcomp (regex_ptr, buf, REG_EXTENDED | REG_NOSUB | (ignore_case ? REG_ICASE : 0) ) != 0)
+        {
+            g_free(buf);
+            return(REGCMPERROR);
+        }
+
+        *match_mode = MATCH_REGEXP;
+        g_free(buf);
+    }
+    else                                                    // Configure byte-matching search
+    {
+        if ( !compress_search_pattern(cpattern, pattern, truncate_symbols) )
+            return(NOTSYMBOL);
+
+        *match_mode = MATCH_BYTES;
+    }
+    return(NOERROR);
+}
+
+
+
+static gboolean mega_match(char **read_ptr, match_mode_t match_mode, const regex_t *regex_ptr, char *cpattern)
+{
+    char        firstchar;                      /* first character of a potential symbol */
+    gboolean    match_found;
+    static char symbol[MAX_SYMBOL_SIZE + 1];    /* symbol name (off-stack) */
+
+
+    match_found = FALSE;
+    last_work.symbols++;
+
+    if (match_mode == MATCH_REGEXP)  /* Perform a regular expression pattern match */
+    {
+
+        /* if this is a symbol */
+
+        /**************************************************
+         * The first character may be a digraph'ed char, so
+         * unpack it into firstchar, and then test that.
+         *
+         * Assume that all digraphed chars have the 8th bit
+         * set (0200).
+         **************************************************/
+        if (**read_ptr & 0x80)
+        {   /* digraph char? */
+            firstchar = dichar1[(**read_ptr & 0x7f) / 8];
+        }
+        else
+        {
+            firstchar = **read_ptr;
+        }
+
+        if (isalpha((unsigned char)firstchar) || firstchar == '_')
+        {
+            get_string(symbol, read_ptr);
+
+            /* match the symbol to the regular expression */
+            last_work.regex_evals++;
+            if (regexec (regex_ptr, symbol, (size_t)0, NULL, 0) == 0)
+            {
+                match_found = TRUE;
+            }
+        }
+    }
+    else if (match_mode == MATCH_FOLDED)    /* Not a regexp, perform a case-insensitive (compressed text) pattern match */
+    {
+        match_found = match_folded(read_ptr, cpattern);
+    }
+    else    /* Not a regexp, perform a direct byte-for-byte (compressed text) pattern match */
+    {
+        if (**read_ptr == cpattern[0])
+        {
+            (*read_ptr)++;
+            /* match the rest of the symbol to the text pattern */
+            if (match_bytes(read_ptr, cpattern))
+            {
+                match_found = TRUE;
+            }
+        }
+    }
+
+    return(match_found);
+}
+
+
+
+
+
+/*
+ * Perform the search described by <token>, leaving the results in token->results.
+ * Caller must hold the engine lock.  Returns FALSE if the search could not be performed.
+ */
+static gboolean perform_lookup(search_token_t *token)
+{
+    int       c;
+    struct    stat statstruct;
+
+    search_t            search_operation = token->operation;
+    gchar               *pattern = token->pattern;
+    search_results_t    *results = &token->results;
+    search_result_t     result = NOERROR;          /* findinit return code */
+    gboolean            ignore_case = token->ignore_case;
+    gboolean            truncate_symbols = token->truncate_symbols;
+    gint                generation;
+    cache_entry_t       *cached;
+    gint64              wall_start = g_get_monotonic_time();
+    gint64              cpu_start = cpu_time();
+
+    log_query(search_operation, pattern);
+    memset(&last_work, 0, sizeof(last_work));
+    last_work.operation = search_operation;
+    g_strlcpy(last_work.pattern, pattern, SEARCH_WORK_PATTERN_SIZE);
+    PROBE2(search_start, search_operation, pattern);
+
+    /* open the references found (search results) file for writing */
+    if ( !writerefsfound() ) return(FALSE);
+
+    /* Answer a repeat query from the cache.  The results file is still rewritten, since
+       the save-results functions read it.  Cached results are delivered in one piece (no batches). */
+    if ( cacheable(search_operation) && (cached = cache_find(search_operation, pattern, ignore_case, truncate_symbols)) )
+    {
+        if ( (fwrite(cached->data, 1, cached->size, refsfound) != cached->size) ||
+             (freopen(temp1, "r", refsfound) == NULL) )
+        {
+            fprintf(stderr, "Error: Internal failure, unable to rewrite the search results file:\n%s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        results->start_ptr   = g_malloc(cached->size);
+        results->end_ptr     = results->start_ptr + cached->size;
+        results->match_count = cached->match_count;
+        memcpy(results->start_ptr, cached->data, cached->size);
+        imatch_count = cached->match_count;
+        last_work.cached = TRUE;
+        record_work(results, wall_start, cpu_start);
+
+        periodic_check_cref();
+        return(TRUE);
+    }
+    generation = cache_generation;
+
+    if ((nonglobalrefs = fopen(temp2, "w")) == NULL)
+    {
+        my_cannotopen(temp2);
+        return(FALSE);
+    }
+
+    /* find the pattern */
+    initprogress();
+    if (token->callbacks.batch) stream_start();
+    search_status("Searching ...");
+
+    cref_advise(MADV_SEQUENTIAL);   /* The database walkers read the cross-reference front to back */
+
+    switch (search_operation)
+    {
+        case FIND_STRING:
+            result = find_string(pattern, ignore_case);
+        break;
+
+        case FIND_REGEXP:
+            result = find_regexp(pattern, ignore_case);
+        break;
+
+        case FIND_SYMBOL:
+            result = find_symbol(pattern, ignore_case, truncate_symbols);
+        break;
+
+        case FIND_DEF:
+            result = find_def(pattern, ignore_case, truncate_symbols);
+        break;
+
+        case FIND_CALLEDBY:
+            result = find_called_by(pattern, ignore_case, truncate_symbols);
+        break;
+
+        case FIND_CALLING:
+            result = find_calling(pattern, ignore_case, truncate_symbols);
+        break;
+
+        case FIND_FILE:
+            result = find_file(pattern, ignore_case);
+        break;
+
+        case FIND_INCLUDING:
+            result = find_include(pattern, ignore_case);
+        break;
+
+        case FIND_AUTOGEN_ERRORS:
+            result = find_string(pattern, ignore_case);
+        break;
+
+        case FIND_ALL_FUNCTIONS:
+            result = find_all_functions();
+        break;
 
+        case FIND_REACHABLE:
+            result = find_reachable(pattern);
+        break;
 
+        case FIND_CALL_PATHS:
+            result = find_call_paths(pattern);
+        break;
 
-static search_result_t configure_search(char *pattern, gboolean *use_regexp, regex_t *regex_ptr, char *cpattern)
-{
-    char        *s_ptr;
+        case FIND_INCLUDERS:
+            result = find_includers(pattern);
+        break;
 
-    /* remove trailing white space */
-    for (s_ptr = pattern + strlen(pattern) - 1; isspace(*s_ptr); --s_ptr) *s_ptr = '\0';
+        case FIND_OUTLINE:
+            result = find_outline(pattern);
+        break;
 
-    /* remove leading white space */
-    for (s_ptr = pattern; isspace(*s_ptr); ++s_ptr);
-    if (s_ptr > pattern)        // leading whitespace present, squash it..
-        memmove(pattern, s_ptr, strlen(s_ptr) + 1);
+        default:
+            result = NOERROR;
+        break;
+    }
 
+    cref_advise(MADV_NORMAL);
 
-    /* This search utilizes regexec() ONLY if there are metacharacters in the search pattern */
-    /* The match must be an exact match */
-    if (is_regexp(pattern) || settings.ignoreCase)          // Configure regex search
+    /* Deliver whatever has not been streamed yet, so the streamed rows add up to the final results */
+    if (stream_active)
     {
-        gchar   *buf;
+        stream_flush();
+        stream_stop();
+    }
 
-        /* remove leading ^ and trailing $ (if present) */
-        strip_anchors(pattern);
+    /* append the non-global references */
+    if ( freopen(temp2, "r", nonglobalrefs) == NULL )   // This must never happen
+    {
+        fprintf(stderr, "Error: Internal failure, freopen(temp2) should never fail:\n%s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    while ((c = getc(nonglobalrefs)) != EOF)
+    {
+        putc(c, refsfound);
+    }
 
-        my_asprintf(&buf, "^%s$", pattern);
-        if (regcomp (regex_ptr, buf, REG_EXTENDED | REG_NOSUB | (settings.ignoreCase ? REG_ICASE : 0) ) != 0)
+    fclose(nonglobalrefs);
+
+    periodic_check_cref();
+
+    /* reopen the references found file for reading */
+    if (freopen(temp1, "r", refsfound) == NULL)    // This must never happen
+    {
+        fprintf(stderr, "Error: Internal failure, freopen(temp1) should never fail:\n%s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if ( stat(temp1, &statstruct) != 0 )
+    {
+        fprintf(stderr, "Error in SEARCH_lookup: Unexpected stat() failure.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if ( statstruct.st_size > 0)
+    {
+        // malloc a buffer to hold the entire "results" file
+        results->start_ptr = g_malloc(statstruct.st_size);
+        if ( results->start_ptr == NULL )
         {
-            g_free(buf);
-            return(REGCMPERROR);
+            fprintf(stderr, "Error in SEARCH_lookup: malloc() failure.\n");
+            exit(EXIT_FAILURE);
         }
 
-        *use_regexp = TRUE;
-        g_free(buf);
+        // Load the entire results file into a memory buffer
+        if ( fread(results->start_ptr, 1, statstruct.st_size, refsfound) != statstruct.st_size)
+        {
+            fprintf(stderr, "Error in SEARCH_lookup: File loading error.\n");
+            exit(EXIT_FAILURE);
+        }
+        results->end_ptr = results->start_ptr + statstruct.st_size;
     }
-    else                                                    // Configure byte-matching search
+    else
     {
-        if ( !compress_search_pattern(cpattern, pattern) )
-            return(NOTSYMBOL);
-
-        *use_regexp = FALSE;
+        results->start_ptr = NULL;
+        results->end_ptr   = NULL;
     }
-    return(NOERROR);
-}
 
+    results->match_count = 0;
 
+    if (results->end_ptr == results->start_ptr )      // Handle the no-results case
+    {
+        char      *msg;
+        char      *esc_pattern;
 
-static gboolean mega_match(char **read_ptr, gboolean use_regexp, const regex_t *regex_ptr, char *cpattern)
-{
-    char        firstchar;                      /* first character of a potential symbol */
-    gboolean    match_found;
-    static char symbol[MAX_SYMBOL_SIZE + 1];    /* symbol name (off-stack) */
+        esc_pattern = g_markup_escape_text(pattern, -1);        // Escape any/all special markup chars <,>,&
 
+        if (result == NOTSYMBOL)
+        {
+            my_asprintf(&msg, "<span foreground=\"red\">This is not a C symbol:</span> %s", esc_pattern);
+        }
+        else if (result == REGCMPERROR)
+        {
+            my_asprintf(&msg,
+                           "<span foreground=\"red\">Error in this regcmp(3X) regular expression:</span> %s",
+                           esc_pattern);
+        }
+        else
+        {
+            my_asprintf(&msg, "<span foreground=\"red\">Could not find:</span> %s", esc_pattern);
+        }
 
-    match_found = FALSE;
+        search_status(msg);
+        g_free(esc_pattern);
+        g_free(msg);
+    }
+    else    // We have some results: update results->match_count
 
-    if (use_regexp)  /* Perform a regular expression pattern match */
+    #if 1   // Revisit: Delete this block once confidence is hight that match_count & imatch count never diverge
     {
+        // count the newlines to determine match_count
 
-        /* if this is a symbol */
+        gchar *work_ptr;
 
-        /**************************************************
-         * The first character may be a digraph'ed char, so
-         * unpack it into firstchar, and then test that.
-         *
-         * Assume that all digraphed chars have the 8th bit
-         * set (0200).
-         **************************************************/
-        if (**read_ptr & 0x80)
-        {   /* digraph char? */
-            firstchar = dichar1[(**read_ptr & 0x7f) / 8];
-        }
-        else
+        work_ptr = results->start_ptr;
+
+        while (work_ptr != results->end_ptr)
         {
-            firstchar = **read_ptr;
+            if (*work_ptr++ == '\n') results->match_count++;
         }
 
-        if (isalpha((unsigned char)firstchar) || firstchar == '_')
+        if (results->match_count != imatch_count )
         {
-            get_string(symbol, read_ptr);
-
-            /* match the symbol to the regular expression */
-            if (regexec (regex_ptr, symbol, (size_t)0, NULL, 0) == 0)
-            {
-                match_found = TRUE;
-            }
+            // Out of an abundance of caution, leave this check in for a cycle, just to make sure
+            // these values never diverge.
+            printf("Assertion Failure: match_count != imatch_count");
+            printf("Test: struct %d, global %d\n", results->match_count, imatch_count);
+            exit(EXIT_FAILURE);
         }
     }
-    else    /* Not a regexp, perform a direct byte-for-byte (compressed text) pattern match */
+    #else
+        results->match_count = imatch_count;
+    #endif
+
+    /* Cancelled searches are incomplete: never cache them */
+    if ( (results->match_count > 0) && cacheable(search_operation) && !search_cancelled() )
     {
-        if (**read_ptr == cpattern[0])
-        {
-            (*read_ptr)++;
-            /* match the rest of the symbol to the text pattern */
-            if (match_bytes(read_ptr, cpattern))
-            {
-                match_found = TRUE;
-            }
-        }
+        cache_store(search_operation, pattern, ignore_case, truncate_symbols, generation, results);
     }
 
-    return(match_found);
+    record_work(results, wall_start, cpu_start);
+    return(TRUE);
 }
 
 
 
 
-
 //===================================================================================================
 //          Public Functions
 //===================================================================================================
@@ -1522,12 +3339,34 @@ void SEARCH_init()
     char    *raw_tmpdir;
     pid_t   pid;
 
+    if ( !ui_thread ) ui_thread = g_thread_self();     /* Search notifications are delivered to this thread */
+
+    g_mutex_lock(&engine_lock);     /* Wait for the search thread to finish with the old database */
+
+    g_atomic_int_inc(&db_generation);   /* Every cached query result belongs to the old database */
+
+    DICT_free();    /* Stop any dictionary collection from the old database before it goes away */
+
     if (cref_file_buf != NULL)
     {
-        g_free(cref_file_buf);    /* Avoid a memory leak.  Free any old file buffer first */
+        /* Avoid a memory leak.  Release any old database first */
+        if (cref_file_mapped)
+            munmap(cref_file_buf, cref_file_size);
+        else
+            g_free(cref_file_buf);
         cref_file_buf = NULL;
+        cref_file_mapped = FALSE;
     }
 
+    CGRAPH_free(call_graph);    /* Rebuilt from the new database when they are needed */
+    call_graph = NULL;
+    INCGRAPH_free(include_graph);
+    include_graph = NULL;
+    PATHIDX_free(path_index);       /* The source file list may have changed too */
+    path_index = NULL;
+    if (file_sections) g_hash_table_destroy(file_sections);
+    file_sections = NULL;
+
     /* How big is the file?  And can we acces it? Should always succeed */
     if ( stat(settings.refFile, &statstruct) != 0 )
     {
@@ -1541,256 +3380,411 @@ void SEARCH_init()
         fprintf(stderr, "Fatal Error: Unable to open() cross-reference file.\n");
         exit(EXIT_FAILURE);
     }
+    cref_file_size = statstruct.st_size;
+
+    /* Map the file read-only.  The pages are shared with the page cache (and with any other gscope
+       browsing the same cross-reference), so there is nothing to load up front.  A rebuild never
+       rewrites the file in place (see movefile()), so the mapping stays valid until it is replaced. */
+    cref_file_buf = mmap(NULL, statstruct.st_size, PROT_READ, MAP_SHARED, fileno(cref_file), 0);
+
+    if (cref_file_buf != MAP_FAILED)
+    {
+        cref_file_mapped = TRUE;
+        cref_advise(MADV_WILLNEED);     /* Start reading it in now */
+    }
+    else
+    {
+        /* Not mappable (or empty): fall back to a private copy.  A really big cross reference
+           (like: ~1 GBbyte) on a memory-constrained host (like 2GB) MIGHT fail. */
+        cref_file_buf = g_malloc(statstruct.st_size);  /* malloc a buffer to hold the entire file */
+        if ( cref_file_buf == NULL )
+        {
+            fprintf(stderr, "Fatal Error: Unable to allocate memory to load cross-reference file.\n");
+            fprintf(stderr, "             Add more memory to your system.\n");
+            exit(EXIT_FAILURE);
+        }
+
+        /* Read the entire file into memory.  Sould always succeed */
+        if ( fread(cref_file_buf, 1, statstruct.st_size, cref_file) != statstruct.st_size )
+        {
+            fprintf(stderr, "Fatal Error: Unable to load cross-reference file.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    /* At this point we have a valid, memory-resident, cross-reference database available
+       (cref_file_buf) for use by the various functions of the SEARCH component */
+
+    /* The symbol dictionary (for query completion) is collected from the new database */
+    DICT_init(cref_file_buf);
+
+    /*** create the temporary file names ***/
+    raw_tmpdir = getenv("TMPDIR");                  //NOSONAR
+    if ( raw_tmpdir )
+        my_asprintf(&tmpdir, "%s", raw_tmpdir);     //NOSONAR
+    else
+        my_asprintf(&tmpdir, "/tmp");               //NOSONAR
+
+    pid = getpid();
+    snprintf(temp1, MAX_TMP_PATH +1, "%s/cscope%d.1", tmpdir, pid);
+    snprintf(temp2, MAX_TMP_PATH +1, "%s/cscope%d.2", tmpdir, pid);
+    g_free(tmpdir);
+
+    fclose(cref_file);
+    g_mutex_unlock(&engine_lock);
+
+    /*** Initialize the Cross-Reference "periodic check" timer ***/
+    periodic_check_cref();
+}
+
+
+
+/*
+ * search for the symbol or text pattern
+ * Note: need to return an ERR status too
+ *
+ * Returns a pointer to a search_results_t structure that contains:
+ *      start_ptr - A pointer to a dynamically allocated buffer containing all results data
+ *      end_ptr   - A pointer to the first byte following the last byte of the results data
+ *    match_count - The number of matches produced by the lookup operation.
+ *
+ * Callers are responsible for calling SEARCH_free_results() as soon as they are finished using the results data.
+ * As a failsafe, to prevent memory leaks, this function will make the "free results" call if any old results are
+ * still present when a new SEARCH_lookup() call is made.
+ *
+ * The search is performed on the calling thread (waiting for any asynchronous search in progress to finish).
+ */
+search_results_t *SEARCH_lookup(search_t search_operation, gchar *pattern)
+{
+    static search_results_t results = { NULL, NULL, 0 };
+    search_token_t          token;
+    gboolean                ok;
+
+    // Avoid memory leaks - Free any old "results" - This should not be needed.
+    if (results.start_ptr != NULL)
+    {
+        g_free(results.start_ptr);
+        results.start_ptr = NULL;
+        results.end_ptr = NULL;
+        results.match_count = 0;
+        fprintf(stderr, "Warning: SEARCH_lookup: Found old lookup data that should have already been freed.\n");
+    }
+
+    memset(&token, 0, sizeof(token));
+    token.operation  = search_operation;
+    token.pattern    = pattern;
+    token.generation = g_atomic_int_get(&cancel_generation);
+    token.ignore_case      = settings.ignoreCase;
+    token.truncate_symbols = settings.truncateSymbols;
+
+    g_mutex_lock(&engine_lock);
+    active_token = &token;
+    ok = perform_lookup(&token);
+    active_token = NULL;
+    g_mutex_unlock(&engine_lock);
+
+    if ( !ok ) return(0);
+
+    results = token.results;
+    return( &results );
+}
+
+
+
+/*
+ * Perform the same search for each of <count> patterns, on the calling thread.
+ *
+ * Returns a dynamically allocated array of <count> search_results_t structures, one per pattern,
+ * in the order given.  FIND_CALLEDBY and FIND_CALLING searches for plain symbol names are all
+ * answered from the call graph (in ignore-case mode, by a single pass over the cross-reference),
+ * so the cost is practically independent of <count>.
+ * Other searches (and regular expression patterns) fall back to one lookup per pattern.
+ *
+ * Unlike SEARCH_lookup(), the search results file is left untouched by single-pass searches.
+ * Callers must release the results with SEARCH_free_batch_results().
+ */
+search_results_t *SEARCH_lookup_batch(search_t search_operation, gchar **patterns, guint count)
+{
+    search_results_t    *results;
+    search_results_t    *group_results;
+    batch_group_t       *groups;
+    symset_t            *names;
+    search_token_t      token;
+    cache_entry_t       *cached;
+    gchar               **names_of;     /* The trimmed copy of each single-pass pattern (the caller's are left alone) */
+    gint                *group_of;      /* The symbol set index of each pattern (-1 = already answered) */
+    gboolean            *taken;
+    guint               num_groups;
+    guint               i;
+    gint                generation;
+    gboolean            single_pass;
+
+    memset(&token, 0, sizeof(token));
+    token.operation  = search_operation;
+    token.generation = g_atomic_int_get(&cancel_generation);
+    token.ignore_case      = settings.ignoreCase;
+    token.truncate_symbols = settings.truncateSymbols;
+
+    results  = g_new0(search_results_t, count);
+    group_of = g_new(gint, count);
+    names_of = g_new0(gchar *, count);
+    names    = SYMSET_new(token.ignore_case);
+
+    single_pass = ( (search_operation == FIND_CALLEDBY) || (search_operation == FIND_CALLING) ) &&
+                  !token.truncate_symbols;
+
+    g_mutex_lock(&engine_lock);
+    active_token = &token;
+
+    for (i = 0; i < count; i++)
+    {
+        group_of[i] = -1;
+
+        if ( !single_pass || is_regexp(patterns[i]) )
+        {
+            token.pattern = patterns[i];
+            if ( perform_lookup(&token) ) results[i] = token.results;
+            memset(&token.results, 0, sizeof(token.results));
+            continue;
+        }
+
+        log_query(search_operation, patterns[i]);
+        names_of[i] = g_strstrip(g_strdup(patterns[i]));
+
+        if ( (cached = cache_find(search_operation, names_of[i], token.ignore_case, token.truncate_symbols)) != NULL )
+        {
+            results[i].start_ptr   = g_malloc(cached->size);
+            results[i].end_ptr     = results[i].start_ptr + cached->size;
+            results[i].match_count = cached->match_count;
+            memcpy(results[i].start_ptr, cached->data, cached->size);
+        }
+        else
+        {
+            group_of[i] = SYMSET_add(names, names_of[i]);   /* -1: not a C symbol, so no matches */
+        }
+    }
+    generation = cache_generation;
+
+    if ( (num_groups = SYMSET_size(names)) > 0 )
+    {
+        groups        = g_new0(batch_group_t, num_groups);
+        group_results = g_new0(search_results_t, num_groups);
+        taken         = g_new0(gboolean, num_groups);
+
+        if ( !token.ignore_case )
+        {
+            find_batch_in_graph(search_operation, names_of, count, group_of, groups, num_groups);
+        }
+        else
+        {
+            cref_advise(MADV_SEQUENTIAL);
+            if (search_operation == FIND_CALLING)
+                find_calling_batch(names, groups);
+            else
+                find_called_by_batch(names, groups);
+            cref_advise(MADV_NORMAL);
+        }
+
+        for (i = 0; i < num_groups; i++)
+        {
+            batch_results(&groups[i], &group_results[i]);
+        }
 
-    /* Allocate a buffer to hold the entire file.  A really big cross reference
-       (like: ~1 GBbyte) on a memory-constrained host (like 2GB) MIGHT fail. */
-    cref_file_buf = g_malloc(statstruct.st_size);  /* malloc a buffer to hold the entire file */
-    if ( cref_file_buf == NULL )
-    {
-        fprintf(stderr, "Fatal Error: Unable to allocate memory to load cross-reference file.\n");
-        fprintf(stderr, "             Add more memory to your system.\n");
-        exit(EXIT_FAILURE);
-    }
+        /* Hand each group's results to its first pattern, and a copy to any repeats */
+        for (i = 0; i < count; i++)
+        {
+            search_results_t *group;
+            gsize            size;
 
-    /* Read the entire file into memory.  Sould always succeed */
-    if ( fread(cref_file_buf, 1, statstruct.st_size, cref_file) != statstruct.st_size )
-    {
-        fprintf(stderr, "Fatal Error: Unable to load cross-reference file.\n");
-        exit(EXIT_FAILURE);
-    }
+            if (group_of[i] < 0) continue;
+            group = &group_results[group_of[i]];
 
-    /* At this point we have a valid, memory-resident, cross-reference database available
-       (cref_file_buf) for use by the various functions of the SEARCH component */
+            if ( !taken[group_of[i]] )
+            {
+                taken[group_of[i]] = TRUE;
+                results[i] = *group;
 
-    /*** create the temporary file names ***/
-    raw_tmpdir = getenv("TMPDIR");                  //NOSONAR
-    if ( raw_tmpdir )
-        my_asprintf(&tmpdir, "%s", raw_tmpdir);     //NOSONAR
-    else
-        my_asprintf(&tmpdir, "/tmp");               //NOSONAR
+                if ( (results[i].match_count > 0) && !search_cancelled() )
+                {
+                    cache_store(search_operation, names_of[i], token.ignore_case, token.truncate_symbols,
+                                generation, &results[i]);
+                }
+            }
+            else if ( (size = group->end_ptr - group->start_ptr) > 0 )
+            {
+                results[i].start_ptr   = g_malloc(size);
+                results[i].end_ptr     = results[i].start_ptr + size;
+                results[i].match_count = group->match_count;
+                memcpy(results[i].start_ptr, group->start_ptr, size);
+            }
+        }
 
-    pid = getpid();
-    snprintf(temp1, MAX_TMP_PATH +1, "%s/cscope%d.1", tmpdir, pid);
-    snprintf(temp2, MAX_TMP_PATH +1, "%s/cscope%d.2", tmpdir, pid);
-    g_free(tmpdir);
+        g_free(taken);
+        g_free(group_results);
+        g_free(groups);
+    }
 
-    /*** Initialize the Cross-Reference "periodic check" timer ***/
-    periodic_check_cref();
+    active_token = NULL;
+    g_mutex_unlock(&engine_lock);
 
-    fclose(cref_file);
+    SYMSET_free(names);
+    for (i = 0; i < count; i++) g_free(names_of[i]);
+    g_free(names_of);
+    g_free(group_of);
+
+    return(results);
 }
 
 
 
 /*
- * search for the symbol or text pattern
- * Note: need to return an ERR status too
- *
- * Returns a pointer to a search_results_t structure that contains:
- *      start_ptr - A pointer to a dynamically allocated buffer containing all results data
- *      end_ptr   - A pointer to the first byte following the last byte of the results data
- *    match_count - The number of matches produced by the lookup operation.
- *
- * Callers are responsible for calling SEARCH_free_results() as soon as they are finished using the results data.
- * As a failsafe, to prevent memory leaks, this function will make the "free results" call if any old results are
- * still present when a new SEARCH_lookup() call is made.
+ * Queue a search to be performed on the search thread.  Returns immediately.
  *
+ * Progress, batches of partial results (every STREAM_BATCH_ROWS matches or STREAM_BATCH_USEC
+ * microseconds, whichever comes first) and the final results are delivered to <callbacks> from
+ * the GTK main loop.  Any callback may be NULL.  The streamed batches add up to the final results,
+ * in the same order.  The final results (and the token) are released when the 'done' callback
+ * returns, so the token must not be used after that.
  */
-search_results_t *SEARCH_lookup(search_t search_operation, gchar *pattern)
+search_token_t *SEARCH_lookup_async(search_t search_operation, const gchar *pattern,
+                                    const search_callbacks_t *callbacks, gpointer user_data)
 {
-    int       c;
-    struct    stat statstruct;
-
-    search_result_t         result = NOERROR;          /* findinit return code */
-    static search_results_t results = { NULL, NULL, 0 };
+    search_token_t *token;
 
-    /* open the references found (search results) file for writing */
-    if ( !writerefsfound() ) return(0);
-
-    if ((nonglobalrefs = fopen(temp2, "w")) == NULL)
+    if ( !request_queue )   // First request: start the search thread
     {
-        my_cannotopen(temp2);
-        return(0);
+        request_queue = g_async_queue_new();
+        g_thread_new("gscope-search", search_thread, NULL);
     }
 
-    /* find the pattern */
-    initprogress();
-    DISPLAY_status("Searching ...");
+    token = g_new0(search_token_t, 1);
+    token->operation  = search_operation;
+    token->pattern    = g_strdup(pattern);
+    token->callbacks  = *callbacks;
+    token->user_data  = user_data;
+    token->generation = g_atomic_int_get(&cancel_generation);
+    token->ignore_case      = settings.ignoreCase;
+    token->truncate_symbols = settings.truncateSymbols;
 
+    g_async_queue_push(request_queue, token);
 
-    switch (search_operation)
-    {
-        case FIND_STRING:
-            result = find_string(pattern);
-        break;
+    return(token);
+}
 
-        case FIND_REGEXP:
-            result = find_regexp(pattern);
-        break;
 
-        case FIND_SYMBOL:
-            result = find_symbol(pattern);
-        break;
 
-        case FIND_DEF:
-            result = find_def(pattern);
-        break;
+/* Ask an asynchronous search to stop.  Matches found so far are still reported as the final results. */
+void SEARCH_token_cancel(search_token_t *token)
+{
+    g_atomic_int_set(&token->cancelled, TRUE);
+}
 
-        case FIND_CALLEDBY:
-            result = find_called_by(pattern);
-        break;
 
-        case FIND_CALLING:
-            result = find_calling(pattern);
-        break;
 
-        case FIND_FILE:
-            result = find_file(pattern);
-        break;
+/* Cancel every outstanding search request and wait for the search in progress (if any) to stop */
+void SEARCH_cancel()
+{
+    g_atomic_int_inc(&cancel_generation);
 
-        case FIND_INCLUDING:
-            result = find_include(pattern);
-        break;
+    g_mutex_lock(&engine_lock);
+    g_mutex_unlock(&engine_lock);
+}
 
-        case FIND_AUTOGEN_ERRORS:
-            result = find_string(pattern);
-        break;
 
-        case FIND_ALL_FUNCTIONS:
-            result = find_all_functions();
-        break;
 
-        default:
-            result = NOERROR;
-        break;
-    }
+/* Discard every cached query result, so the next lookups are searched again [benchmarks] */
+void SEARCH_cache_flush()
+{
+    g_atomic_int_inc(&db_generation);   /* cache_find() flushes the cache on its next call */
+}
 
-    /* append the non-global references */
-    if ( freopen(temp2, "r", nonglobalrefs) == NULL )   // This must never happen
-    {
-        fprintf(stderr, "Error: Internal failure, freopen(temp2) should never fail:\n%s\n", strerror(errno));
-        exit(EXIT_FAILURE);
-    }
-    while ((c = getc(nonglobalrefs)) != EOF)
-    {
-        putc(c, refsfound);
-    }
 
-    fclose(nonglobalrefs);
 
-    periodic_check_cref();
+/* Return the name of a query type [e.g. "def" for FIND_DEF], or NULL if it has none */
+const gchar *SEARCH_type_name(search_t operation)
+{
+    guint   i;
 
-    // Avoid memory leaks - Free any old "results" - This should not be needed.
-    if (results.start_ptr != NULL)
+    for (i = 0; i < G_N_ELEMENTS(type_names); i++)
     {
-        g_free(results.start_ptr);
-        results.start_ptr = NULL;
-        results.end_ptr = NULL;
-        results.match_count = 0;
-        fprintf(stderr, "Warning: SEARCH_lookup: Found old lookup data that should have already been freed.\n");
+        if (type_names[i].operation == operation) return(type_names[i].name);
     }
 
+    return(NULL);
+}
 
-    /* reopen the references found file for reading */
-    if (freopen(temp1, "r", refsfound) == NULL)    // This must never happen
-    {
-        fprintf(stderr, "Error: Internal failure, freopen(temp1) should never fail:\n%s\n", strerror(errno));
-        exit(EXIT_FAILURE);
-    }
 
-    if ( stat(temp1, &statstruct) != 0 )
-    {
-        fprintf(stderr, "Error in SEARCH_lookup: Unexpected stat() failure.\n");
-        exit(EXIT_FAILURE);
-    }
 
-    if ( statstruct.st_size > 0)
-    {
-        // malloc a buffer to hold the entire "results" file
-        results.start_ptr = g_malloc(statstruct.st_size);
-        if ( results.start_ptr == NULL )
-        {
-            fprintf(stderr, "Error in SEARCH_lookup: malloc() failure.\n");
-            exit(EXIT_FAILURE);
-        }
+/* Find the query type named by the first <length> characters of <name> */
+gboolean SEARCH_type_from_name(const gchar *name, gsize length, search_t *operation)
+{
+    guint   i;
 
-        // Load the entire results file into a memory buffer
-        if ( fread(results.start_ptr, 1, statstruct.st_size, refsfound) != statstruct.st_size)
+    for (i = 0; i < G_N_ELEMENTS(type_names); i++)
+    {
+        if ( (strlen(type_names[i].name) == length) && (strncmp(type_names[i].name, name, length) == 0) )
         {
-            fprintf(stderr, "Error in SEARCH_lookup: File loading error.\n");
-            exit(EXIT_FAILURE);
+            *operation = type_names[i].operation;
+            return(TRUE);
         }
-        results.end_ptr = results.start_ptr + statstruct.st_size;
-    }
-    else
-    {
-        results.start_ptr = NULL;
-        results.end_ptr   = NULL;
     }
 
-    results.match_count = 0;
-
-    if (results.end_ptr == results.start_ptr )      // Handle the no-results case
-    {
-        char      *msg;
-        char      *esc_pattern;
+    return(FALSE);
+}
 
-        esc_pattern = g_markup_escape_text(pattern, -1);        // Escape any/all special markup chars <,>,&
 
-        if (result == NOTSYMBOL)
-        {
-            my_asprintf(&msg, "<span foreground=\"red\">This is not a C symbol:</span> %s", esc_pattern);
-        }
-        else if (result == REGCMPERROR)
-        {
-            my_asprintf(&msg,
-                           "<span foreground=\"red\">Error in this regcmp(3X) regular expression:</span> %s",
-                           esc_pattern);
-        }
-        else
-        {
-            my_asprintf(&msg, "<span foreground=\"red\">Could not find:</span> %s", esc_pattern);
-        }
 
-        DISPLAY_status(msg);
-        g_free(esc_pattern);
-        g_free(msg);
-    }
-    else    // We have some results: update results.match_count
+/*
+ * Append every query from now on to <filename> [NULL = stop], one "<type>:<pattern>" line per
+ * query:  a trace that --queryFile and gscope_replay can run again.  Returns FALSE if the
+ * file cannot be opened.
+ */
+gboolean SEARCH_set_query_log(const gchar *filename)
+{
+    FILE    *new_log = NULL;
 
-    #if 1   // Revisit: Delete this block once confidence is hight that match_count & imatch count never diverge
+    if ( filename && ((new_log = fopen(filename, "a")) == NULL) )
     {
-        // count the newlines to determine match_count
+        fprintf(stderr, "Error: Unable to open query log file: %s\n", filename);
+        return(FALSE);
+    }
 
-        gchar *work_ptr;
+    g_mutex_lock(&engine_lock);
+    if (query_log) fclose(query_log);
+    query_log = new_log;
+    g_mutex_unlock(&engine_lock);
 
-        work_ptr = results.start_ptr;
+    return(TRUE);
+}
 
-        while (work_ptr != results.end_ptr)
-        {
-            if (*work_ptr++ == '\n') results.match_count++;
-        }
 
-        if (results.match_count != imatch_count )
-        {
-            // Out of an abundance of caution, leave this check in for a cycle, just to make sure
-            // these values never diverge.
-            printf("Assertion Failure: match_count != imatch_count");
-            printf("Test: struct %d, global %d\n", results.match_count, imatch_count);
-            exit(EXIT_FAILURE);
-        }
-    }
-    #else
-        results.match_count = imatch_count;
-    #endif
 
-    return( &results );
+/* Get the work done by the most recent [completed] search [SEARCH_lookup() or asynchronous] */
+void SEARCH_last_work(search_work_t *work)
+{
+    if (SEARCH_work_history(work, 1) == 0) memset(work, 0, sizeof(*work));
 }
 
 
-void SEARCH_cancel()
+
+/* Copy the work done by [up to <max> of] the most recent searches to <history>, newest first.
+   Returns the number of searches copied. */
+guint SEARCH_work_history(search_work_t *history, guint max)
 {
-    cancel_search = TRUE;
+    guint   count;
+    guint   i;
+
+    g_mutex_lock(&history_lock);
+
+    count = MIN(max, history_count);
+    for (i = 0; i < count; i++)
+    {
+        history[i] = work_history[(history_next + SEARCH_WORK_HISTORY - 1 - i) % SEARCH_WORK_HISTORY];
+    }
+
+    g_mutex_unlock(&history_lock);
+
+    return(count);
 }
 
 
@@ -1824,6 +3818,8 @@ void SEARCH_cleanup_prev()
 void SEARCH_stats(stats_struct_t *sptr)
 {
     char        file[MAX_SYMBOL_SIZE + 1];  /* source file name */
+    guint32     scan_counts[256];
+    guint32     *counts;
 
     char        *read_ptr;
     gboolean    done = FALSE;
@@ -1831,71 +3827,78 @@ void SEARCH_stats(stats_struct_t *sptr)
     /* Initialize the statistics structure */
     memset(sptr, 0, sizeof(stats_struct_t));
 
-    read_ptr = cref_file_buf;   /* Initialize the read pointer to the beginning of the database */
+    g_mutex_lock(&engine_lock);     /* Don't collect stats while the search thread is busy (or the database is reloading) */
 
-    /* find the next file name or definition */
-    do
-    {
-        while (*read_ptr++ != '\t');    /* Scan past the next tab */
-
-        switch (*read_ptr)
-        {
-            case CLASSDEF:          // C++ class definitions
-                sptr->define_cnt++;
-                sptr->class_cnt++;
-            break;
+    sptr->cache_hits    = cache_hits;
+    sptr->cache_misses  = cache_misses;
+    sptr->cache_entries = cache_lru.length;
+    sptr->cache_bytes   = cache_bytes;
 
-            case DEFINE:
-                sptr->define_cnt++;
-                sptr->identifier_cnt++;
-            break;
+    if (mark_counts_valid)
+    {
+        counts = mark_counts;       /* Counted when the cross-reference was built */
+    }
+    else
+    {
+        /* Count the marks the slow way */
+        counts = scan_counts;
+        memset(scan_counts, 0, sizeof(scan_counts));
 
-            case DEFINEEND:
-            case FCNEND:
-                // do nothing
-            break;
+        read_ptr = cref_file_buf;   /* Initialize the read pointer to the beginning of the database */
 
-            case NEWFILE:
-                read_ptr++;  /* save file name */
-                get_string(file, &read_ptr);
+        /* find the next file name or definition */
+        do
+        {
+            read_ptr = SCAN_past_tab(read_ptr);    /* Scan past the next tab */
 
-                /* Check for end-of-symbols */
-                if (*file == '\0')
-                {
-                    done = TRUE;
-                    continue;
-                }
-            break;
+            switch (*read_ptr)
+            {
+                case NEWFILE:
+                    read_ptr++;  /* save file name */
+                    get_string(file, &read_ptr);
 
-            case FCNCALL:
-                sptr->fn_calls_cnt++;
-            break;
+                    /* Check for end-of-symbols */
+                    if (*file == '\0')
+                    {
+                        done = TRUE;
+                        continue;
+                    }
+                break;
 
-            case FCNDEF:
-                sptr->define_cnt++;
-                sptr->identifier_cnt++;
-                sptr->fn_cnt++;
-            break;
+                case CLASSDEF:
+                case DEFINE:
+                case DEFINEEND:
+                case ENUMDEF:
+                case FCNCALL:
+                case FCNDEF:
+                case FCNEND:
+                case GLOBALDEF:
+                case INCLUDE:
+                case MEMBERDEF:
+                case STRUCTDEF:
+                case TYPEDEF:
+                case UNIONDEF:
+                    scan_counts[(guchar) *read_ptr]++;
+                break;
 
-            case INCLUDE:
-                sptr->include_cnt++;
-            break;
+                default:
+                    fprintf(stderr, "Error in statistics collection: should never reach here: char = %c\n", *read_ptr);
 
-            case ENUMDEF:
-            case GLOBALDEF:
-            case MEMBERDEF:
-            case STRUCTDEF:
-            case TYPEDEF:
-            case UNIONDEF:
-                sptr->define_cnt++;
-            break;
+             }
+        }
+        while (!done);
+    }
 
-            default:
-                fprintf(stderr, "Error in statistics collection: should never reach here: char = %c\n", *read_ptr);
+    sptr->class_cnt      = counts[CLASSDEF];    // C++ class definitions
+    sptr->fn_cnt         = counts[FCNDEF];
+    sptr->fn_calls_cnt   = counts[FCNCALL];
+    sptr->include_cnt    = counts[INCLUDE];
+    sptr->identifier_cnt = counts[DEFINE] + counts[FCNDEF];
+    sptr->define_cnt     = counts[CLASSDEF] + counts[DEFINE] + counts[FCNDEF] +
+                           counts[ENUMDEF] + counts[GLOBALDEF] + counts[MEMBERDEF] +
+                           counts[STRUCTDEF] + counts[TYPEDEF] + counts[UNIONDEF];
 
-         }
-    }
-    while (!done);
+    g_mutex_unlock(&engine_lock);
     return;
 }
 
@@ -2444,7 +4447,7 @@ void SEARCH_check_cref()
         if ( stat(settings.refFile, &statstruct) != 0 )
         {
             /* Cross reference file doesn't exist, must have been deleted out from under us */
-            DISPLAY_set_cref_current(FALSE);
+            search_cref_current(FALSE);
             ref_status = FALSE;
         }
         else
@@ -2457,22 +4460,25 @@ void SEARCH_check_cref()
 
                 if ( stat(src_file, &statstruct) != 0 )
                 {
-                    DISPLAY_set_cref_current(FALSE);
+                    search_cref_current(FALSE);
                     ref_status = FALSE;
                     break;
                 }
 
                 if ( statstruct.st_mtime > ref_time )
                 {
-                    DISPLAY_set_cref_current(FALSE);
+                    search_cref_current(FALSE);
                     ref_status = FALSE;
                     break;
                 }
             }
         }
 
-        DISPLAY_set_cref_current(ref_status);
+        search_cref_current(ref_status);
         SEARCH_set_cref_status(ref_status);
+
+        /* Cached results may no longer match the source: discard them (see cache_find) */
+        if ( !ref_status ) g_atomic_int_inc(&db_generation);
     }
 }
 
@@ -2499,3 +4505,17 @@ void SEARCH_free_results(search_results_t *results)
     results->match_count = 0;
 }
 
+
+
+/* Release the results returned by SEARCH_lookup_batch() */
+void SEARCH_free_batch_results(search_results_t *results, guint count)
+{
+    guint i;
+
+    for (i = 0; i < count; i++)
+    {
+        g_free(results[i].start_ptr);
+    }
+    g_free(results);
+}
+
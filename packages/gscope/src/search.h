@@ -1,3 +1,6 @@
+#ifndef GSCOPE_SEARCH_H
+#define GSCOPE_SEARCH_H
+
 
 typedef enum  {
     FIND_SYMBOL = 0,
@@ -12,6 +15,10 @@ typedef enum  {
     /* Everyting below this line is a Virtual button item - virtual button order is not important */
     FIND_AUTOGEN_ERRORS,
     FIND_ALL_FUNCTIONS,
+    FIND_REACHABLE,     /* Pattern: "<function> [calls]" */
+    FIND_CALL_PATHS,    /* Pattern: "<from function> <to function> [max calls]" */
+    FIND_INCLUDERS,     /* Pattern: "<file> [#include levels]" */
+    FIND_OUTLINE,       /* Pattern: "<file>" */
     FIND_NULL,
 
     NUM_FIND_TYPES      /* Keep this item last */
@@ -32,6 +39,10 @@ typedef struct
     guint fn_cnt;
     guint class_cnt;
     guint include_cnt;
+    guint cache_hits;       /* Query results cache */
+    guint cache_misses;
+    guint cache_entries;
+    gsize cache_bytes;
 } stats_struct_t;
 
 
@@ -43,25 +54,80 @@ typedef struct
 } search_results_t;
 
 
+#define SEARCH_WORK_PATTERN_SIZE    64      /* Longer patterns are truncated in search_work_t */
+#define SEARCH_WORK_HISTORY         16      /* The number of searches kept by SEARCH_work_history() */
+
+/* The work done by a search [see SEARCH_last_work] */
+typedef struct
+{
+    search_t    operation;
+    gchar       pattern[SEARCH_WORK_PATTERN_SIZE];
+    gdouble     wall_ms;        /* Elapsed time */
+    gdouble     cpu_ms;         /* CPU time of the searching thread and its file name scan threads */
+    gsize       cref_bytes;     /* Cross-reference bytes read [including any index the search had to build] */
+    guint64     symbols;        /* Cross-reference symbols compared with the pattern */
+    guint64     regex_evals;    /* regexec() calls */
+    gsize       source_bytes;   /* Source file bytes read [text and regular expression searches] */
+    guint       files_opened;   /* Source files opened */
+    gsize       result_bytes;   /* Size of the results */
+    guint       match_count;
+    gboolean    cached;         /* Answered from the query results cache [nothing was read] */
+} search_work_t;
+
+
+/* A batch of streamed results.  Rows in 'head' belong immediately after all previously
+   streamed head rows, rows in 'tail' belong at the end of the list.  Displaying every batch
+   this way reproduces the exact row order of the completed SEARCH_lookup() results. */
+typedef struct
+{
+    search_results_t    head;
+    search_results_t    tail;
+} search_batch_t;
+
+
+/* Handle for an asynchronous search request (see SEARCH_lookup_async) */
+typedef struct _search_token search_token_t;
+
+/* Asynchronous search notifications.  All callbacks are invoked from the GTK main loop. */
+typedef struct
+{
+    void    (*progress)(guint searched, guint total, guint matches, gpointer user_data);
+    void    (*batch)   (search_batch_t *batch, gpointer user_data);
+    void    (*done)    (search_results_t *results, gpointer user_data);
+} search_callbacks_t;
+
+
 //===============================================================
 //      Public Interface Functions
 //===============================================================
 
 void                SEARCH_init     (void);
 search_results_t *  SEARCH_lookup   (search_t search_operation, gchar *pattern);
+search_results_t *  SEARCH_lookup_batch (search_t search_operation, gchar **patterns, guint count);
+search_token_t *    SEARCH_lookup_async (search_t search_operation, const gchar *pattern,
+                                         const search_callbacks_t *callbacks, gpointer user_data);
+void                SEARCH_token_cancel (search_token_t *token);
 void                SEARCH_stats    (stats_struct_t *sptr);
 void                SEARCH_cleanup  (void);
 gboolean            SEARCH_save_html(gchar *filename);
 gboolean            SEARCH_save_text(gchar *filename);
 gboolean            SEARCH_save_csv (gchar *filename);
 void                SEARCH_cancel   (void);
+void                SEARCH_cache_flush    (void);
+const gchar *       SEARCH_type_name      (search_t operation);
+gboolean            SEARCH_type_from_name (const gchar *name, gsize length, search_t *operation);
+gboolean            SEARCH_set_query_log  (const gchar *filename);
+void                SEARCH_last_work      (search_work_t *work);
+guint               SEARCH_work_history   (search_work_t *history, guint max);
 void                SEARCH_check_cref     (void);
 void                SEARCH_set_cref_status(gboolean status);
 gboolean            SEARCH_get_cref_status(void);
 void                SEARCH_free_results   (search_results_t *results);
+void                SEARCH_free_batch_results(search_results_t *results, guint count);
 void                SEARCH_cleanup_prev   (void);
 
 //===============================================================
 //      Public Global Variables
 //===============================================================
 
+#endif /* GSCOPE_SEARCH_H ends */
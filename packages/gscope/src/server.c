@@ -0,0 +1,683 @@
+/*
+ *  gscope query server
+ *
+ *  A resident session that loads the cross-reference once and answers queries from any number
+ *  of local clients over a Unix domain socket.  The protocol is line-delimited JSON:
+ *
+ *    Request                           Response
+ *    {"id":1,"query":"def:main"}       {"id":1,"query":"def:main","matches":N,"results":[...]}
+ *                                        (each result is {"file":...,"function":...,"line":...,"text":...})
+ *    {"cancel":1}                      {"id":1,"cancelled":true}   [if request 1 is still pending]
+ *    anything else                     {"id":...,"error":"..."}
+ *
+ *  See query.c for the query types.  The "id" [any JSON string or number] is optional, it is
+ *  echoed back verbatim and is only needed to cancel the request.  A client may send any number
+ *  of requests without waiting for the responses:  the requests of every client are searched one
+ *  at a time, in the order received, by the search thread (see SEARCH_lookup_async()), and each
+ *  response is sent as soon as its search is done.  The indexes built for a query [call graph,
+ *  #include graph, file name index...] are kept for the next one.
+ *
+ *  The cross-reference file is checked every few seconds.  When it has been replaced [rebuilt
+ *  by gscope -b, or by a GUI session] it is reloaded, and any request that was pending is
+ *  searched again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gtk/gtk.h>
+#include <glib-unix.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "app_config.h"
+#include "search.h"
+#include "build.h"
+#include "query.h"
+#include "server.h"
+#include "utils.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define SERVER_BACKLOG      16
+#define SERVER_CHECK_SEC    2               /* How often to check for a rebuilt cross-reference (seconds) */
+#define MAX_REQUEST_SIZE    (64 * 1024)     /* Longest request line accepted */
+#define READ_SIZE           4096
+
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+typedef struct
+{
+    gint            fd;
+    guint           in_source;
+    guint           out_source;     /* Watch for room to send the pending output [0 = none] */
+    GString         *in;            /* Incomplete request line */
+    GString         *out;           /* Responses not sent yet... */
+    gsize           out_sent;       /* ...starting here */
+    GHashTable      *requests;      /* The client's pending requests, by id */
+    guint           next_key;       /* For requests without an id */
+    gboolean        closed;         /* Disconnected:  free the client once its last request is done */
+} client_t;
+
+
+typedef struct
+{
+    client_t        *client;
+    gchar           *key;           /* Key in client->requests */
+    gchar           *id;            /* The request id (JSON text) to echo back */
+    gchar           *query;
+    search_t        operation;
+    gchar           *pattern;
+    search_token_t  *token;
+    gboolean        cancelled;      /* Cancelled by the client */
+    guint           reload;         /* The cross-reference load the request was searched against */
+} request_t;
+
+
+//===============================================================
+//       Private Global Variables
+//===============================================================
+
+static GMainLoop    *main_loop;
+static struct stat  cref_stat;          /* The cross-reference file being served */
+static guint        reloads = 0;        /* Number of times the cross-reference has been reloaded */
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static const gchar  *skip_space         (const gchar *ptr);
+static const gchar  *json_value_end     (const gchar *ptr);
+static gchar        *json_string        (const gchar *start, const gchar *end);
+static gboolean     json_parse_object   (const gchar *line, GHashTable *members);
+static void         client_send         (client_t *client, const gchar *data, gsize length);
+static void         client_flush        (client_t *client);
+static void         client_close        (client_t *client);
+static void         client_release      (client_t *client);
+static void         send_error          (client_t *client, const gchar *id, const gchar *message);
+static void         submit_request      (request_t *request);
+static void         free_request        (request_t *request);
+static void         handle_request      (client_t *client, const gchar *line);
+static void         on_search_done      (search_results_t *results, gpointer user_data);
+static gboolean     on_client_input     (gint fd, GIOCondition condition, gpointer user_data);
+static gboolean     on_client_output    (gint fd, GIOCondition condition, gpointer user_data);
+static gboolean     on_connect          (gint fd, GIOCondition condition, gpointer user_data);
+static gboolean     on_check_cref       (gpointer user_data);
+static gboolean     on_signal           (gpointer user_data);
+
+
+
+static const gchar *skip_space(const gchar *ptr)
+{
+    while ( g_ascii_isspace(*ptr) ) ptr++;
+    return(ptr);
+}
+
+
+
+/* Return the end of the JSON value at <ptr> [a string, number, true, false or null], or NULL if there is none */
+static const gchar *json_value_end(const gchar *ptr)
+{
+    gsize   length;
+
+    if (*ptr == '"')
+    {
+        for (ptr++; *ptr != '"'; ptr++)
+        {
+            if (*ptr == '\0') return(NULL);
+            if ( (*ptr == '\\') && (*++ptr == '\0') ) return(NULL);
+        }
+        return(ptr + 1);
+    }
+
+    length = strspn(ptr, "+-.0123456789Eaeflnrstu");
+    return( length ? ptr + length : NULL );
+}
+
+
+
+/* Decode the JSON string from <start> [its opening quote] up to <end> [just past its closing quote] */
+static gchar *json_string(const gchar *start, const gchar *end)
+{
+    GString     *string;
+    const gchar *ptr;
+    gunichar    c;
+    guint       i;
+
+    string = g_string_sized_new(end - start);
+
+    for (ptr = start + 1; ptr < end - 1; ptr++)
+    {
+        if (*ptr != '\\')
+        {
+            g_string_append_c(string, *ptr);
+            continue;
+        }
+
+        switch (*++ptr)
+        {
+            case 'b':   g_string_append_c(string, '\b');    break;
+            case 'f':   g_string_append_c(string, '\f');    break;
+            case 'n':   g_string_append_c(string, '\n');    break;
+            case 'r':   g_string_append_c(string, '\r');    break;
+            case 't':   g_string_append_c(string, '\t');    break;
+
+            case 'u':
+                c = 0;
+                for (i = 1; (i <= 4) && (ptr + i < end - 1) && g_ascii_isxdigit(ptr[i]); i++)
+                    c = (c << 4) | g_ascii_xdigit_value(ptr[i]);
+                g_string_append_unichar(string, c);
+                ptr += i - 1;
+            break;
+
+            default:    /* \" \\ \/ */
+                g_string_append_c(string, *ptr);
+            break;
+        }
+    }
+
+    return( g_string_free(string, FALSE) );
+}
+
+
+
+/*
+ * Parse a JSON object of string, number, true, false or null members.  Each member is added
+ * to <members> as name -> value [the JSON text of the value].  Returns FALSE if <line> is not
+ * such an object.
+ */
+static gboolean json_parse_object(const gchar *line, GHashTable *members)
+{
+    const gchar *ptr;
+    const gchar *end;
+    gchar       *name;
+
+    ptr = skip_space(line);
+    if (*ptr++ != '{') return(FALSE);
+
+    ptr = skip_space(ptr);
+    if (*ptr == '}') return( *skip_space(ptr + 1) == '\0' );
+
+    for (;;)
+    {
+        if ( (*ptr != '"') || ((end = json_value_end(ptr)) == NULL) ) return(FALSE);
+        name = json_string(ptr, end);
+
+        ptr = skip_space(end);
+        if ( (*ptr++ != ':') || ((end = json_value_end(ptr = skip_space(ptr))) == NULL) )
+        {
+            g_free(name);
+            return(FALSE);
+        }
+        g_hash_table_replace(members, name, g_strndup(ptr, end - ptr));
+
+        ptr = skip_space(end);
+        if (*ptr == '}') return( *skip_space(ptr + 1) == '\0' );
+        if (*ptr++ != ',') return(FALSE);
+        ptr = skip_space(ptr);
+    }
+}
+
+
+
+static void client_send(client_t *client, const gchar *data, gsize length)
+{
+    if (client->closed) return;
+
+    g_string_append_len(client->out, data, length);
+    client_flush(client);
+}
+
+
+
+/* Send as much of the pending output as the socket will take, and watch for room for the rest */
+static void client_flush(client_t *client)
+{
+    gssize  sent;
+
+    while (client->out_sent < client->out->len)
+    {
+        sent = send(client->fd, client->out->str + client->out_sent, client->out->len - client->out_sent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR) continue;
+            if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) ) break;
+
+            client_close(client);   /* The client is gone */
+            return;
+        }
+        client->out_sent += sent;
+    }
+
+    if (client->out_sent == client->out->len)
+    {
+        g_string_truncate(client->out, 0);
+        client->out_sent = 0;
+        if (client->out_source)
+        {
+            g_source_remove(client->out_source);
+            client->out_source = 0;
+        }
+    }
+    else if ( !client->out_source )
+    {
+        client->out_source = g_unix_fd_add(client->fd, G_IO_OUT, on_client_output, client);
+    }
+}
+
+
+
+/* Disconnect the client and cancel its pending requests (the client itself is freed by client_release) */
+static void client_close(client_t *client)
+{
+    GHashTableIter  iter;
+    request_t       *request;
+
+    if (client->closed) return;
+    client->closed = TRUE;
+
+    if (client->in_source)  g_source_remove(client->in_source);
+    if (client->out_source) g_source_remove(client->out_source);
+    client->in_source  = 0;
+    client->out_source = 0;
+    close(client->fd);
+
+    g_hash_table_iter_init(&iter, client->requests);
+    while ( g_hash_table_iter_next(&iter, NULL, (gpointer *) &request) )
+    {
+        request->cancelled = TRUE;
+        SEARCH_token_cancel(request->token);
+    }
+}
+
+
+
+/* Free a disconnected client, once nothing refers to it anymore */
+static void client_release(client_t *client)
+{
+    if ( !client->closed || (g_hash_table_size(client->requests) > 0) ) return;
+
+    g_string_free(client->in, TRUE);
+    g_string_free(client->out, TRUE);
+    g_hash_table_destroy(client->requests);
+    g_free(client);
+}
+
+
+
+static void send_error(client_t *client, const gchar *id, const gchar *message)
+{
+    gchar   *response;
+
+    response = g_strdup_printf("{\"id\":%s,\"error\":\"%s\"}\n", id ? id : "null", message);
+    client_send(client, response, strlen(response));
+    g_free(response);
+}
+
+
+
+static void submit_request(request_t *request)
+{
+    static const search_callbacks_t callbacks = { NULL, NULL, on_search_done };
+
+    request->reload = reloads;
+    request->token  = SEARCH_lookup_async(request->operation, request->pattern, &callbacks, request);
+}
+
+
+
+static void free_request(request_t *request)
+{
+    g_hash_table_remove(request->client->requests, request->key);
+
+    g_free(request->key);
+    g_free(request->id);
+    g_free(request->query);
+    g_free(request->pattern);
+    g_free(request);
+}
+
+
+
+static void handle_request(client_t *client, const gchar *line)
+{
+    GHashTable  *members;
+    const gchar *id;
+    const gchar *query;
+    const gchar *cancel;
+    request_t   *request;
+    gchar       *text;
+    gchar       *pattern;
+    search_t    operation;
+
+    if (*skip_space(line) == '\0') return;  /* Ignore blank lines */
+
+    members = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+    if ( !json_parse_object(line, members) )
+    {
+        send_error(client, NULL, "Invalid request");
+        g_hash_table_destroy(members);
+        return;
+    }
+
+    id     = g_hash_table_lookup(members, "id");
+    query  = g_hash_table_lookup(members, "query");
+    cancel = g_hash_table_lookup(members, "cancel");
+
+    if (cancel)
+    {
+        /* Cancel the request, if it is still pending (the response says it was cancelled) */
+        request = g_hash_table_lookup(client->requests, cancel);
+        if ( request && !request->cancelled )
+        {
+            request->cancelled = TRUE;
+            SEARCH_token_cancel(request->token);
+        }
+    }
+    else if ( query && (*query == '"') )
+    {
+        text = json_string(query, query + strlen(query));
+
+        if ( id && g_hash_table_contains(client->requests, id) )
+        {
+            send_error(client, id, "Duplicate request id");
+            g_free(text);
+        }
+        else if ( !QUERY_parse(text, &operation, &pattern) )
+        {
+            send_error(client, id, "Unknown query type");
+            g_free(text);
+        }
+        else
+        {
+            request = g_new0(request_t, 1);
+            request->client    = client;
+            request->key       = id ? g_strdup(id) : g_strdup_printf("#%u", client->next_key++);
+            request->id        = g_strdup(id ? id : "null");
+            request->query     = text;
+            request->operation = operation;
+            request->pattern   = pattern;
+
+            g_hash_table_insert(client->requests, request->key, request);
+            submit_request(request);
+        }
+    }
+    else
+    {
+        send_error(client, id, "Expected a \\\"query\\\" or \\\"cancel\\\" request");
+    }
+
+    g_hash_table_destroy(members);
+}
+
+
+
+/* Search thread notification (delivered by the main loop):  the search for a request is done */
+static void on_search_done(search_results_t *results, gpointer user_data)
+{
+    request_t   *request = user_data;
+    client_t    *client  = request->client;
+    FILE        *output;
+    char        *response;
+    size_t      length;
+
+    if ( !request->cancelled && (request->reload != reloads) )
+    {
+        /* The cross-reference was reloaded since this search began:  search the new one */
+        submit_request(request);
+        return;
+    }
+
+    if ( !client->closed )
+    {
+        output = open_memstream(&response, &length);
+
+        fprintf(output, "{\"id\":%s,", request->id);
+        if (request->cancelled)
+        {
+            fputs("\"cancelled\":true}\n", output);
+        }
+        else
+        {
+            fputs("\"query\":", output);
+            my_put_json_string(output, request->query, NULL);
+            fprintf(output, ",\"matches\":%u,\"results\":", results->match_count);
+            QUERY_put_json_results(output, results);
+            fputs("}\n", output);
+        }
+        fclose(output);
+
+        client_send(client, response, length);
+        free(response);
+    }
+
+    free_request(request);
+    client_release(client);
+}
+
+
+
+static gboolean on_client_input(gint fd, GIOCondition condition, gpointer user_data)
+{
+    client_t    *client = user_data;
+    gchar       buffer[READ_SIZE];
+    gssize      count;
+    gchar       *newline;
+    gsize       start;
+
+    count = recv(fd, buffer, sizeof(buffer), 0);
+
+    if ( (count < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) )
+        return(G_SOURCE_CONTINUE);
+
+    if (count <= 0)
+    {
+        /* The client hung up */
+        client->in_source = 0;      /* Removed when we return */
+        client_close(client);
+        client_release(client);
+        return(G_SOURCE_REMOVE);
+    }
+
+    g_string_append_len(client->in, buffer, count);
+
+    /* Handle each complete request line */
+    start = 0;
+    while ( !client->closed && (newline = memchr(client->in->str + start, '\n', client->in->len - start)) != NULL )
+    {
+        *newline = '\0';
+        handle_request(client, client->in->str + start);
+        start = newline + 1 - client->in->str;
+    }
+    g_string_erase(client->in, 0, start);
+
+    if ( !client->closed && (client->in->len > MAX_REQUEST_SIZE) )
+    {
+        send_error(client, NULL, "Request too long");
+        client_close(client);
+    }
+
+    if (client->closed)
+    {
+        client_release(client);
+        return(G_SOURCE_REMOVE);
+    }
+
+    return(G_SOURCE_CONTINUE);
+}
+
+
+
+static gboolean on_client_output(gint fd, GIOCondition condition, gpointer user_data)
+{
+    client_t    *client = user_data;
+
+    client_flush(client);
+
+    if (client->closed)
+    {
+        client_release(client);
+        return(G_SOURCE_REMOVE);
+    }
+
+    return(G_SOURCE_CONTINUE);
+}
+
+
+
+static gboolean on_connect(gint fd, GIOCondition condition, gpointer user_data)
+{
+    client_t    *client;
+    gint        client_fd;
+
+    client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client_fd < 0)
+    {
+        if ( (errno != EAGAIN) && (errno != EINTR) && (errno != ECONNABORTED) )
+            fprintf(stderr, "Warning: Unable to accept a connection: %s\n", strerror(errno));
+        return(G_SOURCE_CONTINUE);
+    }
+
+    client = g_new0(client_t, 1);
+    client->fd        = client_fd;
+    client->in        = g_string_new(NULL);
+    client->out       = g_string_new(NULL);
+    client->requests  = g_hash_table_new(g_str_hash, g_str_equal);
+    client->in_source = g_unix_fd_add(client_fd, G_IO_IN | G_IO_HUP | G_IO_ERR, on_client_input, client);
+
+    return(G_SOURCE_CONTINUE);
+}
+
+
+
+/* Reload the cross-reference if it has been replaced */
+static gboolean on_check_cref(gpointer user_data)
+{
+    struct stat statstruct;
+
+    if ( stat(settings.refFile, &statstruct) != 0 ) return(G_SOURCE_CONTINUE);    /* Being replaced (see movefile()) */
+
+    if ( (statstruct.st_ino   != cref_stat.st_ino)   ||
+         (statstruct.st_size  != cref_stat.st_size)  ||
+         (statstruct.st_mtime != cref_stat.st_mtime) )
+    {
+        printf("Reloading the cross-reference: %s\n", settings.refFile);
+
+        reloads++;
+        SEARCH_cancel();            /* Pending requests are searched again (see on_search_done) */
+        BUILD_initDatabase(NULL);
+
+        stat(settings.refFile, &cref_stat);
+    }
+
+    return(G_SOURCE_CONTINUE);
+}
+
+
+
+static gboolean on_signal(gpointer user_data)
+{
+    g_main_loop_quit(main_loop);
+    return(G_SOURCE_CONTINUE);
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/*
+ * Server session:  load the cross-reference [building it first only if --refOnly was given,
+ * otherwise the existing cross-reference is used as-is] and answer queries on the Unix domain
+ * socket <path> until interrupted.  Returns the exit status.
+ */
+int SERVER_main(gchar *path)
+{
+    struct sockaddr_un  address;
+    mode_t              old_umask;
+    gint                listen_fd;
+
+    if ( strlen(path) >= sizeof(address.sun_path) )
+    {
+        fprintf(stderr, "Error: Server socket path is too long: %s\n", path);
+        return(EXIT_FAILURE);
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0)
+    {
+        fprintf(stderr, "Error: Unable to create the server socket: %s\n", strerror(errno));
+        return(EXIT_FAILURE);
+    }
+
+    /* A socket left behind by a server that is no longer running is replaced */
+    if ( connect(listen_fd, (struct sockaddr *) &address, sizeof(address)) == 0 )
+    {
+        fprintf(stderr, "Error: A server is already running on %s\n", path);
+        close(listen_fd);
+        return(EXIT_FAILURE);
+    }
+    close(listen_fd);
+    (void) unlink(path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    old_umask = umask(0077);    /* Only this user may connect */
+    if ( (bind(listen_fd, (struct sockaddr *) &address, sizeof(address)) != 0) ||
+         (listen(listen_fd, SERVER_BACKLOG) != 0) )
+    {
+        fprintf(stderr, "Error: Unable to listen on %s: %s\n", path, strerror(errno));
+        umask(old_umask);
+        close(listen_fd);
+        return(EXIT_FAILURE);
+    }
+    umask(old_umask);
+
+    if ( !settings.refOnly ) settings.noBuild = TRUE;
+    settings.refOnly = TRUE;    /* No GUI */
+
+    APP_CONFIG_init(NULL);
+    BUILD_initDatabase(NULL);
+
+    settings.noBuild = TRUE;    /* Reloads use the cross-reference as it was rebuilt */
+    stat(settings.refFile, &cref_stat);
+
+    main_loop = g_main_loop_new(NULL, FALSE);
+
+    g_unix_fd_add(listen_fd, G_IO_IN, on_connect, NULL);
+    g_timeout_add_seconds(SERVER_CHECK_SEC, on_check_cref, NULL);
+    g_unix_signal_add(SIGINT,  on_signal, NULL);
+    g_unix_signal_add(SIGTERM, on_signal, NULL);
+    g_unix_signal_add(SIGHUP,  on_signal, NULL);
+
+    printf("Serving %s on %s\n", settings.refFile, path);
+    fflush(stdout);
+
+    g_main_loop_run(main_loop);
+
+    close(listen_fd);
+    (void) unlink(path);
+    SEARCH_cleanup();
+
+    return(EXIT_SUCCESS);
+}
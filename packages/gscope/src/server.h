@@ -0,0 +1,6 @@
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+int             SERVER_main         (gchar *path);
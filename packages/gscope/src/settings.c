@@ -0,0 +1,134 @@
+//***************************************************************************
+//
+// settings.c - The application settings
+//
+// The settings structure [with its built-in defaults] is shared by the
+// cross-reference engine and the user interface.  It is initialized from
+// the configuration file and the command line by app_config.c.
+//
+//***************************************************************************
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "settings.h"
+
+
+//===============================================================
+// Defines
+//===============================================================
+
+#define     MAX_LIST_SIZE           1023            /* Max size for all lists.  All lists must be the same size */
+
+
+//===============================================================
+// Global Variables
+//===============================================================
+
+// Applicaton settings (with defaults initialized)
+
+settings_t settings = {
+    /*.refOnly            =*/refOnlyDef,
+    /*.noBuild            =*/noBuildDef,
+    /*.updateAll          =*/updateAllDef,
+    /*.truncateSymbols    =*/truncateSymbolsDef,
+    /*.compressDisable    =*/compressDisableDef,
+    /*.recurseDir         =*/recurseDirDef,
+    /*.version            =*/versionDef,
+    /*.ignoreCase         =*/ignoreCaseDef,
+    /*.useEditor          =*/useEditorDef,
+    /*.retainInput        =*/retainInputDef,
+    /*.retainFailed       =*/retainFailedDef,
+    /*.searchLogging      =*/searchLoggingDef,
+    /*.reuseWin           =*/reuseWinDef,
+    /*.exitConfirm        =*/exitConfirmDef,
+    /*.menuIcons          =*/menuIconsDef,
+    /*.singleClick        =*/singleClickDef,
+    /*.showIncludes       =*/showIncludesDef,
+    /*.autoGenEnable      =*/autoGenEnableDef,
+    /*.refFile            =*/refFileDef,
+    /*.nameFile           =*/nameFileDef,
+    /*.includeDir         =*/includeDirDef,
+    /*.includeDirDelim    =*/includeDirDelimDef,
+    /*.srcDir             =*/srcDirDef,
+    /*.rcFile             =*/rcFileDef,
+    /*.fileEditor         =*/fileEditorDef,
+    /*.autoGenPath        =*/autoGenPathDef,
+    /*.autoGenSuffix      =*/autoGenSuffixDef,
+    /*.autoGenCmd         =*/autoGenCmdDef,
+    /*.autoGenRoot        =*/autoGenRootDef,
+    /*.autoGenId          =*/autoGenIdDef,
+    /*.autoGenThresh      =*/autoGenThreshDef,
+    /*.searchLogFile      =*/searchLogFileDef,
+    /*.suffixList         =*/suffixListDef,
+    /*.suffixDelim        =*/suffixDelimDef,
+    /*.typelessList       =*/typelessListDef,
+    /*.typelessDelim      =*/typelessDelimDef,
+    /*.ignoredList        =*/ignoredListDef,
+    /*.ignoredDelim       =*/ignoredDelimDef,
+    /*.histFile           =*/histFileDef,
+    /*.terminalApp        =*/terminalAppDef,
+    /*.fileManager        =*/fileManagerDef,
+    /*.geometry           =*/geometryDef,
+    /*.trackedVersion     =*/trackedVersionDef,
+    /*.smartQuery         =*/TRUE
+};
+
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+//**********************************************************************************************
+// SETTINGS_valid_list
+//
+// Function:  Validate a pattern matching list according to the following criteria:
+//    If the list length is <= MAX_LIST_SIZE characters long, and
+//    If a valid delimiter character is defined [first and last char of pattern defines the
+//      delimiter and they must be the same character].
+//
+// If the list passes the validation, set *delim_char equal to the derived delimiter value and
+// return TRUE.
+//
+// If the list fails validation, print a critical error message using list_name+error and return
+// FALSE.
+//**********************************************************************************************
+
+gboolean SETTINGS_valid_list(const char *list_name, char *list_ptr, char *delim_char)
+{
+
+    int pattern_len;
+    char d_head, d_tail;
+
+    pattern_len = strlen(list_ptr);
+
+    if (pattern_len > MAX_LIST_SIZE)
+    {
+        fprintf(stderr, "List syntax error: '%s' pattern exceeds %d characters.\n", list_name, MAX_LIST_SIZE);
+        return(FALSE);
+    }
+
+    d_head = *list_ptr;
+    d_tail = *(list_ptr + pattern_len - 1);
+
+    if (d_head != d_tail || pattern_len == 1 || pattern_len == 2)
+    {
+        fprintf(stderr, "List syntax error: Inconsistent delimiter char: '%c' != '%c'\nPattern name: '%s'\nPattern value: '%s'\n", d_head, d_tail, list_name, list_ptr);
+        return(FALSE);
+    }
+
+    /* if we make it this far, we are good to go... */
+
+    *delim_char = d_head;
+
+    // printf("'%s' pattern: %s\n'%s' delimiter char is '%c' \n---------\n", list_name, list_ptr, list_name, *delim_char);
+
+    return(TRUE);
+}
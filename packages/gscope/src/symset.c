@@ -0,0 +1,260 @@
+/*
+ *  gscope multi-symbol matching
+ *
+ *  A hash set of symbol names, kept in the same digraph-compressed form that is used by the
+ *  cross-reference.  A database symbol is tested against every name in the set with a single
+ *  hash probe, without expanding it first.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+#include "build.h"
+#include "crossref.h"
+#include "symset.h"
+
+
+//===============================================================
+//       Defines
+//===============================================================
+#define MIN_SLOTS           64          /* Initial hash table size (must be a power of 2) */
+#define MAX_FOLDED_SIZE     1024        /* Longest database symbol that can match in ignore-case mode */
+#define FNV_OFFSET_BASIS    2166136261u
+#define FNV_PRIME           16777619u
+
+//===============================================================
+//       Local Type Definitions
+//===============================================================
+
+typedef struct
+{
+    guint32     hash;
+    guint32     length;
+    guint32     offset;         /* Position of the key bytes in the key pool */
+    gint        index;          /* -1 = empty slot */
+} slot_t;
+
+
+struct _symset
+{
+    gboolean    ignore_case;    /* If TRUE, keys are stored expanded and folded to lower case */
+    slot_t      *slots;
+    guint       num_slots;      /* Always a power of 2, and at least twice 'count' */
+    guint       count;
+    GString     *keys;          /* Key pool */
+};
+
+
+//===============================================================
+//      Local Functions
+//===============================================================
+static slot_t   *find_slot  (const symset_t *set, guint32 hash, const char *key, guint32 length);
+static void     alloc_slots (symset_t *set, guint num_slots);
+
+
+
+/* Return the slot holding <key>, or the empty slot where it belongs */
+static slot_t *find_slot(const symset_t *set, guint32 hash, const char *key, guint32 length)
+{
+    guint   mask = set->num_slots - 1;
+    guint   i    = hash & mask;
+    slot_t  *slot;
+
+    while ( (slot = &set->slots[i])->index >= 0 )
+    {
+        if ( (slot->hash == hash) && (slot->length == length) &&
+             (memcmp(set->keys->str + slot->offset, key, length) == 0) )
+        {
+            break;
+        }
+        i = (i + 1) & mask;    /* linear probing */
+    }
+
+    return(slot);
+}
+
+
+
+/* (Re)build the hash table with <num_slots> slots */
+static void alloc_slots(symset_t *set, guint num_slots)
+{
+    slot_t  *old_slots = set->slots;
+    guint   old_num    = set->num_slots;
+    guint   i;
+
+    set->slots     = g_new(slot_t, num_slots);
+    set->num_slots = num_slots;
+    for (i = 0; i < num_slots; i++) set->slots[i].index = -1;
+
+    for (i = 0; i < old_num; i++)
+    {
+        if (old_slots[i].index >= 0)
+        {
+            *find_slot(set, old_slots[i].hash, set->keys->str + old_slots[i].offset, old_slots[i].length) = old_slots[i];
+        }
+    }
+
+    g_free(old_slots);
+}
+
+
+
+//===================================================================================================
+//          Public Functions
+//===================================================================================================
+
+/* Create an empty symbol set.  Matching is case-insensitive if <ignore_case> is TRUE. */
+symset_t *SYMSET_new(gboolean ignore_case)
+{
+    symset_t *set;
+
+    set = g_new0(symset_t, 1);
+    set->ignore_case = ignore_case;
+    set->keys        = g_string_new(NULL);
+    alloc_slots(set, MIN_SLOTS);
+
+    return(set);
+}
+
+
+
+void SYMSET_free(symset_t *set)
+{
+    g_string_free(set->keys, TRUE);
+    g_free(set->slots);
+    g_free(set);
+}
+
+
+
+/*
+ * Add a symbol name to the set.  Returns the index of the name (the index it was first given,
+ * if the name is already present), or -1 if <name> is not a valid C symbol.
+ */
+gint SYMSET_add(symset_t *set, const gchar *name)
+{
+    const gchar *s_ptr;
+    gsize       start;
+    guint32     hash = FNV_OFFSET_BASIS;
+    guint32     length;
+    slot_t      *slot;
+    char        c;
+
+    /* check for a valid C symbol */
+    if ( !isalpha((unsigned char) *name) && *name != '_' ) return(-1);
+    for (s_ptr = name + 1; *s_ptr != '\0'; s_ptr++)
+    {
+        if ( !isalnum((unsigned char) *s_ptr) && *s_ptr != '_' ) return(-1);
+    }
+
+    /* Append the key to the pool: compressed exactly as the cross-reference would store it */
+    start = set->keys->len;
+    for (s_ptr = name; (c = *s_ptr) != '\0'; s_ptr++)
+    {
+        if (set->ignore_case)
+        {
+            c = g_ascii_tolower(c);
+        }
+        else if ( IS_A_DICODE(c, s_ptr[1]) )
+        {
+            c = DICODE_COMPRESS(c, s_ptr[1]);
+            s_ptr++;
+        }
+        g_string_append_c(set->keys, c);
+        hash = (hash ^ (unsigned char) c) * FNV_PRIME;
+    }
+    length = set->keys->len - start;
+
+    slot = find_slot(set, hash, set->keys->str + start, length);
+    if (slot->index >= 0)
+    {
+        g_string_truncate(set->keys, start);    /* Already present */
+        return(slot->index);
+    }
+
+    if ( (set->count + 1) * 2 > set->num_slots )
+    {
+        alloc_slots(set, set->num_slots * 2);
+        slot = find_slot(set, hash, set->keys->str + start, length);
+    }
+
+    slot->hash   = hash;
+    slot->length = length;
+    slot->offset = start;
+    slot->index  = set->count++;
+
+    return(slot->index);
+}
+
+
+
+/*
+ * Test the database symbol at *read_ptr (terminated by a newline) against every name in the set.
+ * Returns the index of the matching name, or -1.  *read_ptr is advanced to the newline.
+ */
+gint SYMSET_match(const symset_t *set, char **read_ptr)
+{
+    char        *start = *read_ptr;
+    char        *src_ptr;
+    char        folded[MAX_FOLDED_SIZE];
+    guint32     hash = FNV_OFFSET_BASIS;
+    guint32     length = 0;
+    unsigned    c;
+    slot_t      *slot;
+
+    if ( !set->ignore_case )
+    {
+        /* Compare the compressed symbol as-is */
+        for (src_ptr = start; *src_ptr != '\n'; src_ptr++)
+        {
+            hash = (hash ^ (unsigned char) *src_ptr) * FNV_PRIME;
+        }
+        *read_ptr = src_ptr;
+        slot = find_slot(set, hash, start, src_ptr - start);
+    }
+    else
+    {
+        /* Expand any digraphs and fold to lower case */
+        for (src_ptr = start; (c = (unsigned char) *src_ptr) != '\n'; src_ptr++)
+        {
+            if (length + 2 > MAX_FOLDED_SIZE)
+            {
+                while (*src_ptr != '\n') src_ptr++;
+                *read_ptr = src_ptr;
+                return(-1);     /* Longer than any name worth matching */
+            }
+
+            if (c > 0x7f)
+            {
+                c &= 0x7f;
+                folded[length] = g_ascii_tolower(dichar1[c / 8]);
+                hash = (hash ^ (unsigned char) folded[length++]) * FNV_PRIME;
+                folded[length] = g_ascii_tolower(dichar2[c & 7]);
+            }
+            else
+            {
+                folded[length] = g_ascii_tolower(c);
+            }
+            hash = (hash ^ (unsigned char) folded[length++]) * FNV_PRIME;
+        }
+        *read_ptr = src_ptr;
+        slot = find_slot(set, hash, folded, length);
+    }
+
+    return(slot->index);
+}
+
+
+
+/* Return the number of distinct names in the set */
+guint SYMSET_size(const symset_t *set)
+{
+    return(set->count);
+}
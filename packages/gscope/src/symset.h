@@ -0,0 +1,20 @@
+
+//===============================================================
+// typedefs
+//===============================================================
+
+/* A set of C symbol names that can be probed directly against the (digraph-compressed)
+   symbols in the cross-reference.  Each distinct name is identified by a small index,
+   assigned in the order names are added (0, 1, 2...). */
+typedef struct _symset symset_t;
+
+
+//===============================================================
+// Public Functions
+//===============================================================
+
+symset_t   *SYMSET_new   (gboolean ignore_case);
+void        SYMSET_free  (symset_t *set);
+gint        SYMSET_add   (symset_t *set, const gchar *name);
+gint        SYMSET_match (const symset_t *set, char **read_ptr);
+guint       SYMSET_size  (const symset_t *set);
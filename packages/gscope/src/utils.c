@@ -9,16 +9,13 @@
 #include <unistd.h>
 #include <string.h>
 #include <glib.h>
-#include <gtk/gtk.h>
+#include <signal.h>
 #include <sys/wait.h>
 
 #include "utils.h"
-#include "app_config.h"
+#include "settings.h"
 
 
-//----------------------- File-Private Globals ------------------------
-static GHashTable   *hash_table = NULL;
-
 //------------------- Private Function Prototypes ---------------------
 static void _handle_sigchld(int sig);
 static void _register_child_handler();
@@ -111,105 +108,6 @@ void my_cannotopen(char *file)
 }
 
 
-// Widget lookup support for GTK3 apps.  Overrides GTK2's auto generated function
-// "lookup_widget()" function.
-//
-GtkWidget   *my_lookup_widget(gchar *name)
-{
-    return( g_hash_table_lookup(hash_table, name) );
-}
-
-
-void my_add_widget(gpointer widget, gpointer user_data)
-{
-    GType       my_type;
-
-    static GType nb1, nb2, nb3, nb4, nb5, nb6;
-
-    if ( !hash_table )   // Need to initialize
-    {
-        hash_table = g_hash_table_new(g_str_hash,g_str_equal);
-
-        // This is a brute-force method for determining if an object is a "buildable"
-        // Additional values may need to be added if the glade file for a specific
-        // application defines other "non-buildable" objects.
-        nb1 = g_type_from_name("GtkAccelGroup");            // Glade-Gtk3
-        nb2 = g_type_from_name("GtkTreeSelection");         // Glade-Gtk3
-        nb3 = g_type_from_name("GMenu");                    // Cambalache-Gtk4
-        nb4 = g_type_from_name("GtkEventControllerFocus");  // Cambalache-Gtk4
-        nb5 = g_type_from_name("GtkAdjustment");            // Cambalache-Gtk4
-        nb6 = g_type_from_name("GtkGestureClick");          // Cambalache-Gtk4
-    }
-
-    my_type = G_OBJECT_TYPE(widget);
-
-    if ( my_type == nb1 || my_type == nb2 || my_type == nb3 || my_type == nb4 || my_type == nb5 || my_type == nb6 )     // Brute force Non-Buildable check
-    {
-        /* my_type is a Non-Buildable type : Do nothing */
-
-        #if 0
-        // Temporarily show what's going on
-        printf("Non-Buildable Object Ecncountered: ");
-        if (my_type == nb1)
-            printf ("GtkAccelGrouop\n");
-        if (my_type == nb2)
-            printf ("GtkAccelGroup\n");
-        if (my_type == nb3)
-            printf("GtkTreeSelection\n");
-        if (my_type == nb4)
-            printf("GtkEventControllerFocus\n");
-        if (my_type == nb5)
-            printf("GtkAdjustment\n");
-        if (my_type == nb6)
-            printf("GtkGestureClick\n");
-        #endif
-    }
-    else
-    {
-        /* Add the widget to to the reference database */
-        #ifndef GTK4_BUILD
-        g_hash_table_insert(hash_table, strdup(gtk_buildable_get_name(GTK_BUILDABLE(widget))), widget); 
-        #else
-        g_hash_table_insert(hash_table, strdup(gtk_buildable_get_buildable_id(GTK_BUILDABLE(widget))), widget); 
-        #endif
-
-        #if 0   // for debugging
-        {
-            static count = 0;
-
-            printf("ID-NAME[%d] = %x %s\n", count++, widget, gtk_buildable_get_name(GTK_BUILDABLE(widget)) ); 
-        }
-        #endif
-    }
-
-}
-
-#if 0   // Might be useful in the future for creating transient instances of toplevel widgets.
-//------------------- GTK3-only support functions -----------------------------------
-
-GtkWidget *create_widget(gchar *widget_name)
-{
-    GtkWidget   *widget;
-    GtkBuilder  *builder;
-    gchar       *toplevel[2];
-
-    toplevel[0] = widget_name;
-    toplevel[1] = NULL;
-
-    builder = gtk_builder_new();
-    gtk_builder_add_objects_from_file(builder, "../gscope3.glade", toplevel, NULL);
-    widget = GTK_WIDGET(gtk_builder_get_object(builder, widget_name));
-    #ifndef GTK4_BUILD      //GTK4: gtk_builder_connect_signals() no longer exists. Instead, signals are always connected automatically.
-    gtk_builder_connect_signals(builder, NULL);
-    #endif
-    g_object_unref(G_OBJECT(builder));
-
-    return(widget);
-}
-
-#endif
-
-
 void my_space_codec(gboolean encode, gchar *my_string)
 {
     gchar *work_ptr;
@@ -396,6 +294,40 @@ void my_asprintf(gchar **str_ptr, const char *fmt, ...)
 }
 
 
+
+// Output the text from <start> up to <end> [or up to the terminating null, if <end> is NULL] as a JSON string.
+//===========================================================================
+void my_put_json_string(FILE *output, const gchar *start, const gchar *end)
+{
+    const gchar     *ptr;
+    unsigned char   c;
+
+    putc('"', output);
+
+    for (ptr = start; (end ? ptr < end : *ptr != '\0'); ptr++)
+    {
+        c = *ptr;
+
+        if ( (c == '"') || (c == '\\') )
+        {
+            putc('\\', output);
+            putc(c, output);
+        }
+        else if (c < ' ')
+        {
+            fprintf(output, "\\u%04x", c);
+        }
+        else
+        {
+            putc(c, output);
+        }
+    }
+
+    putc('"', output);
+}
+
+
+
 #ifndef HAVE_ASPRINTF   // A glimmer of hope for those without asprintf() and friends.
 
 //=====================================================
@@ -443,88 +375,6 @@ int asprintf(char **ret, const char *format, ...)
 #endif
 
 
-// Gtk version-variant abstractions
-//=================================
-
-void my_gtk_entry_set_text(GtkEntry *entry, const gchar *text)
-{
-    #ifndef GTK4_BUILD
-    gtk_entry_set_text(entry, text);
-    #else
-    GtkEntryBuffer *buffer = gtk_entry_get_buffer(entry);
-    gtk_entry_buffer_set_text(buffer, text, -1);           
-    #endif
-}
-
-
-const gchar *my_gtk_entry_get_text(GtkEntry *entry)
-{
-    const gchar *text;
-
-    #ifndef GTK4_BUILD
-    text = gtk_entry_get_text(GTK_ENTRY(entry));
-    #else
-    GtkEntryBuffer *buffer = gtk_entry_get_buffer(entry);
-    text = gtk_entry_buffer_get_text(buffer);           
-    #endif
-
-    return(text);
-}
-
-
-
-gchar *my_gtk_file_chooser_get_filename(GtkFileChooser *chooser)
-{
-    gchar *filename;
-
-    #ifndef GTK4_BUILD
-    filename =gtk_file_chooser_get_filename(chooser);
-    #else
-    GFile *file = gtk_file_chooser_get_file(chooser);
-    filename = g_file_get_path(file);
-    g_free(file);
-    #endif
-
-    return(filename);
-}
-
-
-
-void my_gtk_check_button_set_active(GtkWidget *button, gboolean is_active)
-{
-
-    #ifndef GTK4_BUILD
-        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button), is_active);
-    #else
-        gtk_check_button_set_active(GTK_CHECK_BUTTON(button), is_active);
-    #endif
-}
-
-
-gboolean    my_gtk_check_button_get_active(GtkWidget *button)
-{
-    #ifndef GTK4_BUILD
-    return( gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(button)) );
-    #else
-    return( gtk_check_button_get_active(GTK_CHECK_BUTTON(button)) );
-#endif
-}
-
-
-
-void my_gtk_box_pack_start (GtkBox* box,   GtkWidget* child,   gboolean expand,   gboolean fill,  guint padding)
-{
-    #if defined(GTK4_BUILD)
-    gtk_box_append(box, child);
-    #else
-    gtk_box_pack_start(box, child, expand, fill, padding);
-    #endif 
-
-
-}
-
-
-
 // This function assumes that host environment provides the 'which' command
 // One could do a "which wich" to confirm this.
 gboolean my_command_check(gchar *command)
@@ -546,117 +396,3 @@ gboolean my_command_check(gchar *command)
     if (fp) pclose(fp);
     return(retval);
 }
-
-
-//---------------------------------------------------------------------------
-//
-// Display a message dialog of the specified type (severity) over the 
-// specified parent window.
-// Parameters:
-//     parent:  The parent window
-//
-//   severity:  Mesage type, one of [GTK_MESSAGE_INFO | GTK_MESSAGE_WARNING |
-//                               GTK_MESSAGE_QUESTION | GTK_MESSAGE_ERROR |
-//                               GTK_MESSAGE_OTHER ]
-//
-//   message:  The text to be displayed in the message dialog.  Note,
-//             The string parameter "message" can be a Pango text
-//             markup string.
-//
-//     modal:  Set TRUE if the message dialog window is modal
-//
-//---------------------------------------------------------------------------
-void my_message_dialog(GtkWindow *parent, GtkMessageType severity, const gchar *message, gboolean modal)
-{
-    GtkWidget *MsgDialog;
-
-    if ( !parent )
-    {
-        fprintf(stderr, "Function: %s Dialog Create Error: (NULL parent)\n", __func__);
-        fprintf(stderr, "Dialog Message:\n");
-        if ( message )
-            fprintf(stderr, "%s\n", message);
-        else
-            fprintf(stderr, "<NULL Message>\n");
-    }
-    else
-    {
-        #ifndef GTK4_BUILD
-        MsgDialog = gtk_message_dialog_new_with_markup(parent,
-                                                    GTK_DIALOG_DESTROY_WITH_PARENT,
-                                                    severity,
-                                                    GTK_BUTTONS_NONE,
-                                                    message);
-
-
-        // Pango markup example:
-        //    _("<span foreground=\"blue\" size=\"x-large\" weight=\"bold\">Build Monitor 0.1</span>\nA panel application for monitoring print build status\n2007 Tom Fletcher")
-
-        gtk_window_set_title(GTK_WINDOW(MsgDialog), "gscope-message");
-
-        if (modal)
-        {
-            gtk_dialog_run(GTK_DIALOG (MsgDialog));
-            gtk_widget_destroy(GTK_WIDGET (MsgDialog));
-        }
-        else  // display a non-modal message dialog
-        {
-            gtk_widget_show(MsgDialog);
-
-            // Destroy the dialog when the user responds to it (e.g. clicks a button)
-            g_signal_connect_swapped (MsgDialog, "response",
-                                G_CALLBACK (gtk_widget_destroy),
-                                MsgDialog);
-        }
-        #else   // GTK4 build
-        MsgDialog = gtk_message_dialog_new_with_markup(parent,
-                                                    GTK_DIALOG_DESTROY_WITH_PARENT,
-                                                    severity,
-                                                    GTK_BUTTONS_NONE,
-                                                    message);
-
-        GtkWindow   *message_window;
-        GtkLabel    *message_label;
-        GtkWidget   *message_box;
-        GtkImage    *message_icon = NULL;
-        const char *icon_name[5] = {"dialog-information", "dialog-warning", "dialog-question", "dialog-error", "emblem-important"};
-
-        message_window = GTK_WINDOW(gtk_window_new());
-        message_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-        message_label  = GTK_LABEL(gtk_label_new(NULL));
-
-        gtk_window_set_child(message_window, message_box);
-        gtk_window_set_transient_for(message_window, parent);
-        gtk_window_set_title(message_window, "gscope-message");
-        gtk_window_set_resizable(message_window, FALSE);
-        gtk_window_set_modal(message_window, modal);
-        
-        gtk_label_set_markup(message_label, message);
-        gtk_widget_set_margin_start(GTK_WIDGET(message_label), 20);
-        gtk_widget_set_margin_end(GTK_WIDGET(message_label), 20);
-        gtk_widget_set_margin_bottom(GTK_WIDGET(message_label), 20);
-
-        gtk_label_set_markup(message_label, message);
-        if ( severity < GTK_MESSAGE_OTHER)
-        {
-            message_icon = GTK_IMAGE(gtk_image_new());
-            gtk_image_set_from_icon_name(message_icon, icon_name[severity]);
-            gtk_image_set_icon_size(message_icon, GTK_ICON_SIZE_LARGE);
-            gtk_widget_set_margin_top(GTK_WIDGET(message_icon), 20);
-            gtk_widget_set_margin_bottom(GTK_WIDGET(message_icon), 0);
-            gtk_widget_set_margin_start(GTK_WIDGET(message_icon), 20);
-            gtk_widget_set_margin_end(GTK_WIDGET(message_icon), 20);
-            gtk_box_append(GTK_BOX(message_box), GTK_WIDGET(message_icon));
-        }
-
-        gtk_box_append(GTK_BOX(message_box), GTK_WIDGET(message_label));
-        gtk_label_set_markup(message_label, message);
-        gtk_widget_show(GTK_WIDGET(message_window));
-
-        #endif
-    }
-}
-
-
-
-    
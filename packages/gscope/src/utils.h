@@ -32,12 +32,6 @@
 #define    BRIGHT_CYAN(string) "\x1b[1'36m" #string "\x1b[0m"
 #define          WHITE(string) "\x1b[1;37m" #string "\x1b[0m"
 
-#if defined(GTK3_BUILD) || defined(GTK4_BUILD)
-#define lookup_widget(wiget, name) my_lookup_widget(name)
-#else   // GTK2
-#include "support.h"
-#endif
-
 
 //===============================================================
 // Public Functions
@@ -46,22 +40,10 @@
 char       *my_basename(const char *path);
 char       *my_dirname(char *path);
 void        my_cannotopen(char *file);
-GtkWidget  *my_lookup_widget(gchar *name);
-void        my_add_widget(gpointer data, gpointer user_data);
 pid_t       my_system(gchar *application);
 void        my_space_codec(gboolean encode, gchar *my_string);
 void        my_chdir(gchar *path);
 void        my_asprintf(gchar **str_ptr, const char *fmt, ...);
+void        my_put_json_string(FILE *output, const gchar *start, const gchar *end);
 void        my_start_text_editor(gchar *filename, gchar *linenum);
 gboolean    my_command_check(gchar *command);
-
-// GTK Version-variant abstractions
-void        my_gtk_entry_set_text(GtkEntry *entry, const gchar *text);
-const gchar *my_gtk_entry_get_text(GtkEntry *entry);
-gchar       *my_gtk_file_chooser_get_filename(GtkFileChooser *chooser);
-void        my_gtk_check_button_set_active(GtkWidget *button, gboolean is_active);
-gboolean    my_gtk_check_button_get_active(GtkWidget *button);
-void        my_gtk_box_pack_start (GtkBox* box,   GtkWidget* child,   gboolean expand,   gboolean fill,  guint padding);
-void        my_message_dialog(GtkWindow *parent, GtkMessageType severity, const gchar *message, gboolean modal);
-
-
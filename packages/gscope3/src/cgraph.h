@@ -0,0 +1 @@
+../../gscope/src/cgraph.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/engine.h
\ No newline at end of file
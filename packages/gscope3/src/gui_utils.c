@@ -0,0 +1 @@
+../../gscope/src/gui_utils.c
\ No newline at end of file
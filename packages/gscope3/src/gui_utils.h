@@ -0,0 +1 @@
+../../gscope/src/gui_utils.h
\ No newline at end of file
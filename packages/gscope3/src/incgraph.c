@@ -0,0 +1 @@
+../../gscope/src/incgraph.c
\ No newline at end of file
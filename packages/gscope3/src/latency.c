@@ -0,0 +1 @@
+../../gscope/src/latency.c
\ No newline at end of file
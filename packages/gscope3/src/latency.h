@@ -0,0 +1 @@
+../../gscope/src/latency.h
\ No newline at end of file
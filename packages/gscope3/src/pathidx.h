@@ -0,0 +1 @@
+../../gscope/src/pathidx.h
\ No newline at end of file
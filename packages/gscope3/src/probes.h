@@ -0,0 +1 @@
+../../gscope/src/probes.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/profile.c
\ No newline at end of file
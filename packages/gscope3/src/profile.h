@@ -0,0 +1 @@
+../../gscope/src/profile.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/query.h
\ No newline at end of file
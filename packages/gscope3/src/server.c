@@ -0,0 +1 @@
+../../gscope/src/server.c
\ No newline at end of file
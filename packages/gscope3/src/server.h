@@ -0,0 +1 @@
+../../gscope/src/server.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/settings.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/symset.h
\ No newline at end of file
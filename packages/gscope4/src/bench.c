@@ -0,0 +1 @@
+../../gscope/src/bench.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/cgraph.c
\ No newline at end of file
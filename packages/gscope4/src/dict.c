@@ -0,0 +1 @@
+../../gscope/src/dict.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/dict.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/engine.c
\ No newline at end of file
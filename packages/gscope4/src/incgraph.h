@@ -0,0 +1 @@
+../../gscope/src/incgraph.h
\ No newline at end of file
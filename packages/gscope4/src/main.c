@@ -25,6 +25,8 @@
 #include "display.h"
 #include "build.h"
 #include "utils.h"
+#include "gui_utils.h"
+#include "profile.h"
 
 
 // Test callback
@@ -84,6 +86,8 @@ gchar *rcFile = NULL;
 gchar *srcDir = NULL;
 gchar *geometry = NULL;
 gboolean option_error = FALSE;
+gchar *buildProfile = NULL;
+gchar *buildTrace = NULL;
 
 static void arg_trunc_warn(gchar *string_name)
 {
@@ -107,6 +111,14 @@ static gboolean cmd_line_handler(gpointer data)
             "refOnly", 'b', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &settings.refOnly,
             "Build the cross-reference only.  (No GUI)", NULL
         },
+        {
+            "buildProfile", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &buildProfile,
+            "Write the time of every build phase, source file and directory to FILE [JSON].", "FILE"
+        },
+        {
+            "buildTrace", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &buildTrace,
+            "Write a timeline of the cross-reference build to FILE [Chrome trace-event format].", "FILE"
+        },
         {
             "compressOff", 'c', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &settings.compressDisable,
             "Use only ASCII characters in the cross-reference file (don't compress).", NULL
@@ -230,6 +242,9 @@ static gboolean cmd_line_handler(gpointer data)
         g_free(geometry);
     }
 
+    if ( (buildProfile || buildTrace) && !PROFILE_set_output(buildProfile, buildTrace) )
+        exit(EXIT_FAILURE);
+
 
     g_strfreev(args);
     g_option_context_free(context);
@@ -0,0 +1 @@
+../../gscope/src/pathidx.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/replay.c
\ No newline at end of file
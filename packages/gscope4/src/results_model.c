@@ -0,0 +1 @@
+../../gscope/src/results_model.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/results_model.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/scan.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/settings.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../gscope/src/symset.c
\ No newline at end of file